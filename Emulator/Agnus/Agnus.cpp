@@ -23,12 +23,16 @@ Agnus::Agnus(Amiga& ref) : AmigaComponent(ref)
     };
         
     initLookupTables();
+    
+    primQueue.init(slot, SLOT_REG, SLOT_SEC);
+    secQueue.init(slot, (EventSlot)(SLOT_SEC + 1), (EventSlot)(SLOT_COUNT - 1));
 }
 
 void
 Agnus::_initialize()
 {
     config.revision = AGNUS_ECS_1MB;
+    config.scheduler = SCHEDULER_SCAN;
     ptrMask = 0x0FFFFF;
     
     // Wipe out event slots
@@ -61,6 +65,7 @@ Agnus::_reset(bool hard)
         slot[i].id = (EventID)0;
         slot[i].data = 0;
     }
+    rebuildEventQueues();
     
     // Schedule initial events
     scheduleRel<SLOT_RAS>(DMA_CYCLES(HPOS_CNT), RAS_HSYNC);
@@ -86,6 +91,7 @@ Agnus::getConfigItem(Option option) const
             
         case OPT_AGNUS_REVISION: return config.revision;
         case OPT_SLOW_RAM_MIRROR: return config.slowRamMirror;
+        case OPT_EVENT_SCHEDULER: return config.scheduler;
             
         default:
             assert(false);
@@ -134,6 +140,23 @@ Agnus::setConfigItem(Option option, i64 value)
             config.slowRamMirror = value;
             return true;
             
+        case OPT_EVENT_SCHEDULER:
+            
+            if (!EventSchedulerEnum::isValid(value)) {
+                throw VAError(ERROR_OPT_INVALID_ARG, EventSchedulerEnum::keyList());
+            }
+            if (config.scheduler == value) {
+                return false;
+            }
+            
+            amiga.suspend();
+            
+            config.scheduler = (EventScheduler)value;
+            rebuildEventQueues();
+            
+            amiga.resume();
+            return true;
+            
         default:
             return false;
     }
@@ -221,6 +244,8 @@ Agnus::_dump(dump::Category category, std::ostream& os) const
         os << AgnusRevisionEnum::key(config.revision) << std::endl;
         os << tab("Slow Ram mirror");
         os << bol(config.slowRamMirror) << std::endl;
+        os << tab("Event scheduler");
+        os << EventSchedulerEnum::key(config.scheduler) << std::endl;
     }
 
     if (category & dump::State) {
@@ -300,7 +325,7 @@ Agnus::_dump(dump::Category category, std::ostream& os) const
         os << std::left << std::setw(18) << "Trigger position";
         os << std::left << std::setw(16) << "Trigger cycle" << std::endl;
         
-        for (isize i = 0; i < 23; i++) {
+        for (isize i = 0; i < SLOT_COUNT; i++) {
 
             EventSlotInfo &info = eventInfo.slotInfo[i];
             bool willTrigger = info.trigger != NEVER;
@@ -732,22 +757,34 @@ Agnus::executeUntil(Cycle targetClock)
     // Align to DMA cycle raster
     targetClock &= ~0b111;
 
-    // Compute the number of DMA cycles to execute
-    DMACycle dmaCycles = (targetClock - clock) / DMA_CYCLES(1);
-
-    if (targetClock < nextTrigger && dmaCycles > 0) {
+    while (clock < targetClock) {
+
+        /* Skip all quiet DMA cycles. A DMA cycle is quiet if no event is due.
+         * In this case, execute() does nothing else than advancing the clock
+         * and the horizontal counter. Since all bitplane and DAS events are
+         * scheduled in the event slots (based on the bplEvent and dasEvent
+         * tables), nextTrigger marks the end of the current quiet span. The
+         * span never crosses a line boundary, because the RAS slot always
+         * contains an HSYNC event at the end of the current line.
+         */
+        if (nextTrigger > clock) {
+
+            Cycle skipTo = targetClock;
+            if (nextTrigger < targetClock) {
+                skipTo = (nextTrigger + DMA_CYCLES(1) - 1) & ~0b111;
+            }
 
-        // Advance directly to the target clock
-        clock = targetClock;
-        pos.h += dmaCycles;
+            pos.h += (skipTo - clock) / DMA_CYCLES(1);
+            clock = skipTo;
 
-        // If this assertion hits, the HSYNC event hasn't been served
-        assert(pos.h <= HPOS_CNT);
+            // If this assertion hits, the HSYNC event hasn't been served
+            assert(pos.h <= HPOS_CNT);
 
-    } else {
+            if (clock == targetClock) break;
+        }
 
-        // Execute DMA cycles one after another
-        for (DMACycle i = 0; i < dmaCycles; i++) execute();
+        // Execute the DMA cycle with the pending event
+        execute();
     }
 }
 #endif
@@ -1126,11 +1163,15 @@ Agnus::vsyncHandler()
     controlPort1.joystick.execute();
     controlPort2.joystick.execute();
     retroShell.vsyncHandler();
+    profiler.vsyncHandler();
 
     // Update statistics
     updateStats();
     mem.updateStats();
     
+    // Enter or exit warp mode if requested by a warp policy
+    oscillator.updateWarpMode();
+    
     // Count some sheep (zzzzzz) ...
     oscillator.synchronize();
 }
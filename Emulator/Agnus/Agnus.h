@@ -18,6 +18,7 @@
 #include "DDF.h"
 #include "DmaDebugger.h"
 #include "Event.h"
+#include "EventQueue.h"
 #include "Frame.h"
 #include "Memory.h"
 
@@ -85,6 +86,10 @@ private:
     // Next trigger cycle
     Cycle nextTrigger = NEVER;
     
+    // Priority queues for the primary and secondary slots (SCHEDULER_HEAP)
+    EventQueue primQueue;
+    EventQueue secQueue;
+    
 
     //
     // Event tables
@@ -569,6 +574,7 @@ private:
     isize _size() override { COMPUTE_SNAPSHOT_SIZE }
     isize _load(const u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
     isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+    isize didLoadFromBuffer(const u8 *buffer) override;
 
 
     //
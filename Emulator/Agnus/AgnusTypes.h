@@ -52,6 +52,37 @@ struct AgnusRevisionEnum : util::Reflection<AgnusRevisionEnum, AgnusRevision> {
 };
 #endif
 
+enum_long(SCHEDULER)
+{
+    SCHEDULER_SCAN,         // Rescans the slot table after each event
+    SCHEDULER_HEAP,         // Keeps the slots in a min-heap
+    
+    SCHEDULER_COUNT
+};
+typedef SCHEDULER EventScheduler;
+
+#ifdef __cplusplus
+struct EventSchedulerEnum : util::Reflection<EventSchedulerEnum, EventScheduler> {
+    
+    static bool isValid(long value)
+    {
+        return (unsigned long)value < SCHEDULER_COUNT;
+    }
+
+    static const char *prefix() { return "SCHEDULER"; }
+    static const char *key(EventScheduler value)
+    {
+        switch (value) {
+                
+            case SCHEDULER_SCAN:  return "SCAN";
+            case SCHEDULER_HEAP:  return "HEAP";
+            case SCHEDULER_COUNT: return "???";
+        }
+        return "???";
+    }
+};
+#endif
+
 enum_long(DDF_STATE)
 {
     DDF_OFF,
@@ -121,6 +152,7 @@ typedef struct
 {
     AgnusRevision revision;
     bool slowRamMirror;
+    EventScheduler scheduler;
 }
 AgnusConfig;
 
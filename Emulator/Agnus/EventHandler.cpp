@@ -9,10 +9,12 @@
 
 #include "config.h"
 #include "Agnus.h"
+#include "Amiga.h"
 #include "CIA.h"
 #include "CPU.h"
 #include "Keyboard.h"
 #include "Paula.h"
+#include "Profiler.h"
 #include "UART.h"
 
 void
@@ -361,6 +363,16 @@ Agnus::inspectEventSlot(EventInfo &info, EventSlot nr) const
             }
             break;
 
+        case SLOT_PRF:
+
+            switch (slot[nr].id) {
+
+                case 0:             i.eventName = "none"; break;
+                case PRF_SAMPLE:    i.eventName = "PRF_SAMPLE"; break;
+                default:            i.eventName = "*** INVALID ***"; break;
+            }
+            break;
+
         default: assert(false);
     }
 }
@@ -433,6 +445,37 @@ Agnus::scheduleDasEventForCycle(i16 hpos)
     }
 }
 
+Cycle
+Agnus::nextIrqTrigger() const
+{
+    /* Only a subset of all events can modify INTREQ or INTENA. Bitplane DMA,
+     * sprite DMA, audio DMA, the potentiometer logic, and the inspection
+     * events never do. Disk DMA does, but only if it is active. The Copper
+     * does, but only if Copper DMA is enabled. Otherwise, it is unable to
+     * fetch instructions and polls the bus in every cycle.
+     */
+    static constexpr EventSlot slots[] = {
+        
+        SLOT_REG, SLOT_RAS, SLOT_CIAA, SLOT_CIAB, SLOT_BLT,
+        SLOT_CH0, SLOT_CH1, SLOT_CH2, SLOT_CH3, SLOT_DSK, SLOT_DCH,
+        SLOT_VBL, SLOT_IRQ, SLOT_IPL, SLOT_KBD, SLOT_TXD, SLOT_RXD
+    };
+
+    Cycle result = NEVER;
+    for (auto s : slots) result = std::min(result, slot[s].triggerCycle);
+
+    if (copdma()) {
+        result = std::min(result, slot[SLOT_COP].triggerCycle);
+    }
+
+    auto state = paula.diskController.getState();
+    if (state == DRIVE_DMA_READ || state == DRIVE_DMA_WRITE) {
+        result = std::min(result, slot[SLOT_DAS].triggerCycle);
+    }
+    
+    return result;
+}
+
 void
 Agnus::scheduleNextREGEvent()
 {
@@ -451,92 +494,143 @@ Agnus::executeEventsUntil(Cycle cycle) {
     //
 
     if (isDue<SLOT_RAS>(cycle)) {
+        PROFILE_SLOT(SLOT_RAS);
         serviceRASEvent();
     }
     if (isDue<SLOT_REG>(cycle)) {
+        PROFILE_SLOT(SLOT_REG);
         serviceREGEvent(cycle);
     }
     if (isDue<SLOT_CIAA>(cycle)) {
+        PROFILE_SLOT(SLOT_CIAA);
         serviceCIAEvent<0>();
     }
     if (isDue<SLOT_CIAB>(cycle)) {
+        PROFILE_SLOT(SLOT_CIAB);
         serviceCIAEvent<1>();
     }
     if (isDue<SLOT_BPL>(cycle)) {
+        PROFILE_SLOT(SLOT_BPL);
         serviceBPLEvent();
     }
     if (isDue<SLOT_DAS>(cycle)) {
+        PROFILE_SLOT(SLOT_DAS);
         serviceDASEvent();
     }
     if (isDue<SLOT_COP>(cycle)) {
+        PROFILE_SLOT(SLOT_COP);
         copper.serviceEvent(slot[SLOT_COP].id);
     }
     if (isDue<SLOT_BLT>(cycle)) {
+        PROFILE_SLOT(SLOT_BLT);
         blitter.serviceEvent();
     }
 
     if (isDue<SLOT_SEC>(cycle)) {
 
+        PROFILE_SLOT(SLOT_SEC);
+        
         //
         // Check secondary slots
         //
 
         if (isDue<SLOT_CH0>(cycle)) {
+            PROFILE_SLOT(SLOT_CH0);
             paula.channel0.serviceEvent();
         }
         if (isDue<SLOT_CH1>(cycle)) {
+            PROFILE_SLOT(SLOT_CH1);
             paula.channel1.serviceEvent();
         }
         if (isDue<SLOT_CH2>(cycle)) {
+            PROFILE_SLOT(SLOT_CH2);
             paula.channel2.serviceEvent();
         }
         if (isDue<SLOT_CH3>(cycle)) {
+            PROFILE_SLOT(SLOT_CH3);
             paula.channel3.serviceEvent();
         }
         if (isDue<SLOT_DSK>(cycle)) {
+            PROFILE_SLOT(SLOT_DSK);
             paula.diskController.serviceDiskEvent();
         }
         if (isDue<SLOT_DCH>(cycle)) {
+            PROFILE_SLOT(SLOT_DCH);
             paula.diskController.serviceDiskChangeEvent();
         }
         if (isDue<SLOT_VBL>(cycle)) {
+            PROFILE_SLOT(SLOT_VBL);
             serviceVblEvent();
         }
         if (isDue<SLOT_IRQ>(cycle)) {
+            PROFILE_SLOT(SLOT_IRQ);
             paula.serviceIrqEvent();
         }
         if (isDue<SLOT_KBD>(cycle)) {
+            PROFILE_SLOT(SLOT_KBD);
             keyboard.serviceKeyboardEvent(slot[SLOT_KBD].id);
         }
         if (isDue<SLOT_TXD>(cycle)) {
+            PROFILE_SLOT(SLOT_TXD);
             uart.serviceTxdEvent(slot[SLOT_TXD].id);
         }
         if (isDue<SLOT_RXD>(cycle)) {
+            PROFILE_SLOT(SLOT_RXD);
             uart.serviceRxdEvent(slot[SLOT_RXD].id);
         }
         if (isDue<SLOT_POT>(cycle)) {
+            PROFILE_SLOT(SLOT_POT);
             paula.servicePotEvent(slot[SLOT_POT].id);
         }
         if (isDue<SLOT_IPL>(cycle)) {
+            PROFILE_SLOT(SLOT_IPL);
             paula.serviceIplEvent();
         }
         if (isDue<SLOT_INS>(cycle)) {
+            PROFILE_SLOT(SLOT_INS);
             serviceINSEvent();
         }
+        if (isDue<SLOT_PRF>(cycle)) {
+            PROFILE_SLOT(SLOT_PRF);
+            amiga.guestProfiler.serviceEvent();
+        }
 
         // Determine the next trigger cycle for all secondary slots
-        Cycle nextSecTrigger = slot[SLOT_SEC + 1].triggerCycle;
-        for (isize i = SLOT_SEC + 2; i < SLOT_COUNT; i++)
-            if (slot[i].triggerCycle < nextSecTrigger)
-                nextSecTrigger = slot[i].triggerCycle;
+        Cycle nextSecTrigger;
+        if (config.scheduler == SCHEDULER_HEAP) {
+            nextSecTrigger = secQueue.trigger();
+        } else {
+            nextSecTrigger = slot[SLOT_SEC + 1].triggerCycle;
+            for (isize i = SLOT_SEC + 2; i < SLOT_COUNT; i++)
+                if (slot[i].triggerCycle < nextSecTrigger)
+                    nextSecTrigger = slot[i].triggerCycle;
+        }
 
         // Update the secondary table trigger in the primary table
         rescheduleAbs<SLOT_SEC>(nextSecTrigger);
     }
 
     // Determine the next trigger cycle for all primary slots
-    nextTrigger = slot[0].triggerCycle;
-    for (isize i = 1; i <= SLOT_SEC; i++)
-        if (slot[i].triggerCycle < nextTrigger)
-            nextTrigger = slot[i].triggerCycle;
+    if (config.scheduler == SCHEDULER_HEAP) {
+        nextTrigger = primQueue.trigger();
+    } else {
+        nextTrigger = slot[0].triggerCycle;
+        for (isize i = 1; i <= SLOT_SEC; i++)
+            if (slot[i].triggerCycle < nextTrigger)
+                nextTrigger = slot[i].triggerCycle;
+    }
+}
+
+void
+Agnus::rebuildEventQueues()
+{
+    primQueue.rebuild();
+    secQueue.rebuild();
+}
+
+isize
+Agnus::didLoadFromBuffer(const u8 *buffer)
+{
+    rebuildEventQueues();
+    return 0;
 }
@@ -50,6 +50,9 @@
 
 public:
 
+// Returns the trigger cycle of the next event that might raise an interrupt
+Cycle nextIrqTrigger() const;
+
 // Returns true iff the specified slot contains any event
 template<EventSlot s> bool hasEvent() const { return slot[s].id != (EventID)0; }
 
@@ -105,6 +108,8 @@ template<EventSlot s> void scheduleAbs(Cycle cycle, EventID id)
 
     if (isSecondarySlot(s) && cycle < slot[SLOT_SEC].triggerCycle)
         slot[SLOT_SEC].triggerCycle = cycle;
+    
+    if (config.scheduler == SCHEDULER_HEAP) updateEventQueues<s>();
 }
 
 template<EventSlot s> void scheduleAbs(Cycle cycle, EventID id, i64 data)
@@ -163,6 +168,8 @@ template<EventSlot s> void rescheduleAbs(Cycle cycle)
     
      if (isSecondarySlot(s) && cycle < slot[SLOT_SEC].triggerCycle)
          slot[SLOT_SEC].triggerCycle = cycle;
+    
+    if (config.scheduler == SCHEDULER_HEAP) updateEventQueues<s>();
 }
 
 template<EventSlot s> void rescheduleInc(Cycle cycle)
@@ -185,8 +192,30 @@ template<EventSlot s> void cancel()
     slot[s].id = (EventID)0;
     slot[s].data = 0;
     slot[s].triggerCycle = NEVER;
+    
+    if (config.scheduler == SCHEDULER_HEAP) updateEventQueues<s>();
 }
 
+private:
+
+/* Informs the priority queues about a changed trigger cycle. If a secondary
+ * slot has changed, the trigger cycle of SLOT_SEC may have changed, too.
+ */
+template<EventSlot s> void updateEventQueues()
+{
+    if (isPrimarySlot(s)) {
+        primQueue.update(s);
+    } else {
+        secQueue.update(s);
+        primQueue.update(SLOT_SEC);
+    }
+}
+
+// Recreates both priority queues from the current slot table
+void rebuildEventQueues();
+
+public:
+
 
 //
 // Scheduling specific events
@@ -44,6 +44,7 @@ enum_long(SLOT)
     SLOT_RXD,                       // Serial data in (UART)
     SLOT_POT,                       // Potentiometer
     SLOT_INS,                       // Handles periodic calls to inspect()
+    SLOT_PRF,                       // Guest profiler
     
     SLOT_COUNT
 };
@@ -86,6 +87,7 @@ struct EventSlotEnum : util::Reflection<EventSlotEnum, EventSlot> {
             case SLOT_RXD:   return "RXD";
             case SLOT_POT:   return "POT";
             case SLOT_INS:   return "INS";
+            case SLOT_PRF:   return "PRF";
             case SLOT_COUNT: return "???";
         }
         return "???";
@@ -0,0 +1,89 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "EventQueue.h"
+#include <cassert>
+
+void
+EventQueue::init(const Event *table, EventSlot first, EventSlot last)
+{
+    assert(table != nullptr);
+    assert(first <= last && last < SLOT_COUNT);
+    
+    slots = table;
+    this->first = first;
+    this->count = last - first + 1;
+    
+    rebuild();
+}
+
+void
+EventQueue::rebuild()
+{
+    if (slots == nullptr) return;
+    
+    for (isize i = 0; i < count; i++) {
+        
+        heap[i] = (i8)(first + i);
+        index[first + i] = (i8)i;
+    }
+    for (isize i = count / 2 - 1; i >= 0; i--) siftDown(i);
+    
+    assert(isConsistent());
+}
+
+bool
+EventQueue::siftUp(isize pos)
+{
+    isize start = pos;
+    
+    while (pos > 0) {
+        
+        isize parent = (pos - 1) / 2;
+        if (!less(pos, parent)) break;
+        
+        swap(pos, parent);
+        pos = parent;
+    }
+    
+    return pos != start;
+}
+
+void
+EventQueue::siftDown(isize pos)
+{
+    while (true) {
+        
+        isize left = 2 * pos + 1;
+        isize right = left + 1;
+        isize smallest = pos;
+        
+        if (left < count && less(left, smallest)) smallest = left;
+        if (right < count && less(right, smallest)) smallest = right;
+        if (smallest == pos) break;
+        
+        swap(pos, smallest);
+        pos = smallest;
+    }
+}
+
+bool
+EventQueue::isConsistent() const
+{
+    for (isize i = 1; i < count; i++) {
+        
+        if (less(i, (i - 1) / 2)) return false;
+    }
+    for (isize i = 0; i < count; i++) {
+        
+        if (index[heap[i]] != i) return false;
+    }
+    return true;
+}
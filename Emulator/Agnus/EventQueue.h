@@ -0,0 +1,87 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Event.h"
+#include "EventHandlerTypes.h"
+
+/* An indexed binary min-heap over a contiguous range of event slots. The heap
+ * does not store any trigger cycles by itself. It only stores slot numbers and
+ * reads the trigger cycles directly from the slot table it has been attached
+ * to. Hence, whenever the trigger cycle of a slot changes, update() has to be
+ * called to restore the heap property. Each update costs O(log n) compared to
+ * the O(n) rescan of the slot table performed by the default scheduler.
+ *
+ * If two slots trigger at the same cycle, the slot with the smaller number is
+ * considered to be smaller to keep the result deterministic.
+ */
+class EventQueue {
+    
+    // The attached slot table
+    const Event *slots = nullptr;
+    
+    // The managed slot range
+    isize first = 0;
+    isize count = 0;
+    
+    // The heap (stores slot numbers)
+    i8 heap[SLOT_COUNT];
+    
+    // Reverse mapping (position of a slot inside the heap)
+    i8 index[SLOT_COUNT];
+    
+public:
+    
+    // Attaches the queue to a slot table and manages slots first ... last
+    void init(const Event *table, EventSlot first, EventSlot last);
+    
+    // Recreates the heap from scratch
+    void rebuild();
+    
+    // Restores the heap property after the trigger cycle of a slot has changed
+    void update(EventSlot s) {
+        
+        isize pos = index[s];
+        if (!siftUp(pos)) siftDown(pos);
+    }
+    
+    // Returns the slot that triggers first
+    EventSlot top() const { return (EventSlot)heap[0]; }
+    
+    // Returns the earliest trigger cycle
+    Cycle trigger() const { return slots[heap[0]].triggerCycle; }
+    
+    // Checks the heap property (debugging)
+    bool isConsistent() const;
+    
+private:
+    
+    // Compares two heap entries
+    bool less(isize i, isize j) const {
+        
+        Cycle ti = slots[heap[i]].triggerCycle;
+        Cycle tj = slots[heap[j]].triggerCycle;
+        return ti < tj || (ti == tj && heap[i] < heap[j]);
+    }
+    
+    // Swaps two heap entries
+    void swap(isize i, isize j) {
+        
+        i8 tmp = heap[i]; heap[i] = heap[j]; heap[j] = tmp;
+        index[heap[i]] = (i8)i;
+        index[heap[j]] = (i8)j;
+    }
+    
+    // Moves an entry towards the root (returns true if it has moved)
+    bool siftUp(isize pos);
+    
+    // Moves an entry towards the leafs
+    void siftDown(isize pos);
+};
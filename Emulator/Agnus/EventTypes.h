@@ -179,6 +179,10 @@ enum_long(EventID)
     // INS_TEXTURE,
     INS_EVENT_COUNT,
 
+    // Guest profiler slot
+    PRF_SAMPLE = 1,
+    PRF_EVENT_COUNT,
+
     // Rasterline slot
     RAS_HSYNC = 1,
     RAS_EVENT_COUNT
@@ -76,6 +76,9 @@ Amiga::Amiga()
      * - The CIAs must preceed memory, because they determine if the lower
      *   memory banks are overlayed by Rom.
      *
+     * - The hard drive controller must preceed memory, because it determines
+     *   if the Zorro II board is mapped in.
+     *
      * - Memory mus preceed the CPU, because it contains the CPU reset vector.
      */
 
@@ -87,6 +90,7 @@ Amiga::Amiga()
         &denise,
         &paula,
         &zorro,
+        &hdController,
         &controlPort1,
         &controlPort2,
         &serialPort,
@@ -99,6 +103,7 @@ Amiga::Amiga()
         &ciaB,
         &mem,
         &cpu,
+        &guestProfiler,
         &msgQueue
     };
 
@@ -117,6 +122,7 @@ Amiga::Amiga()
         msg("               CPU : %zu bytes\n", sizeof(CPU));
         msg("            Denise : %zu bytes\n", sizeof(Denise));
         msg("             Drive : %zu bytes\n", sizeof(Drive));
+        msg("      HdController : %zu bytes\n", sizeof(HdController));
         msg("          Keyboard : %zu bytes\n", sizeof(Keyboard));
         msg("            Memory : %zu bytes\n", sizeof(Memory));
         msg("moira::Breakpoints : %zu bytes\n", sizeof(moira::Breakpoints));
@@ -207,8 +213,15 @@ Amiga::getConfigItem(Option option) const
 
         case OPT_AGNUS_REVISION:
         case OPT_SLOW_RAM_MIRROR:
+        case OPT_EVENT_SCHEDULER:
             return agnus.getConfigItem(option);
             
+        case OPT_WARP_DISK:
+        case OPT_WARP_SCRIPT:
+        case OPT_WARP_BOOT:
+        case OPT_WARP_DELAY:
+            return oscillator.getConfigItem(option);
+            
         case OPT_DENISE_REVISION:
         case OPT_HIDDEN_SPRITES:
         case OPT_HIDDEN_LAYERS:
@@ -625,7 +638,13 @@ Amiga::warpOn()
 {
     assert(!isEmulatorThread());
     
-    if (!warpMode) signalWarpOn();
+    oscillator.manualWarp();
+    
+    if (!warpMode) {
+        
+        // Switch immediately if the emulator thread isn't running
+        if (isRunning()) signalWarpOn(); else HardwareComponent::warpOn();
+    }
 }
 
 void
@@ -633,7 +652,13 @@ Amiga::warpOff()
 {
     assert(!isEmulatorThread());
     
-    if (warpMode) signalWarpOff();
+    oscillator.manualWarp();
+    
+    if (warpMode) {
+        
+        // Switch immediately if the emulator thread isn't running
+        if (isRunning()) signalWarpOff(); else HardwareComponent::warpOff();
+    }
 }
 
 void
@@ -796,7 +821,10 @@ Amiga::runLoop()
     while(1) {
         
         // Emulate the next CPU instruction
-        cpu.execute();
+        {
+            PROFILE(PROBE_CPU);
+            cpu.execute();
+        }
 
         // Check if special action needs to be taken
         if (runLoopCtrl) {
@@ -816,6 +844,11 @@ Amiga::runLoop()
                 clearControlFlags(RL_USER_SNAPSHOT);
             }
 
+            if (runLoopCtrl & RL_DELTA_SNAPSHOT) {
+                snapshotChain.record();
+                clearControlFlags(RL_DELTA_SNAPSHOT);
+            }
+
             // Are we requested to update the debugger info structs?
             if (runLoopCtrl & RL_INSPECT) {
                 debug(RUN_DEBUG, "RL_INSPECT\n");
@@ -873,6 +906,133 @@ Amiga::runLoop()
     msgQueue.put(MSG_PAUSE);
 }
 
+isize
+Amiga::executeFrames(isize count)
+{
+    debug(RUN_DEBUG, "executeFrames(%zd)\n", count);
+    
+    auto start = agnus.frame.nr;
+    executeUntil([]() { return false; }, count);
+    
+    return (isize)(agnus.frame.nr - start);
+}
+
+bool
+Amiga::executeUntilPC(u32 addr, isize maxFrames)
+{
+    debug(RUN_DEBUG, "executeUntilPC(%x, %zd)\n", addr, maxFrames);
+
+    addr &= 0xFFFFFE;
+    return executeUntil([&]() { return (cpu.getPC0() & 0xFFFFFF) == addr; }, maxFrames);
+}
+
+bool
+Amiga::executeUntilValue(u32 addr, u8 value, isize maxFrames)
+{
+    debug(RUN_DEBUG, "executeUntilValue(%x, %x, %zd)\n", addr, value, maxFrames);
+
+    u32 even = addr & 0xFFFFFE;
+    isize shift = IS_EVEN(addr) ? 8 : 0;
+    
+    return executeUntil([&]() {
+        return (u8)(mem.spypeek16<ACCESSOR_CPU>(even) >> shift) == value;
+    }, maxFrames);
+}
+
+bool
+Amiga::executeUntilCycle(Cycle cycle)
+{
+    debug(RUN_DEBUG, "executeUntilCycle(%lld)\n", cycle);
+
+    // Compute a frame limit that is large enough to reach the target cycle
+    auto frames = (cycle - agnus.clock) / DMA_CYCLES(HPOS_CNT * VPOS_CNT) + 2;
+    
+    return executeUntil([&]() { return agnus.clock >= cycle; }, (isize)frames);
+}
+
+template <class Condition> bool
+Amiga::executeUntil(Condition cond, isize maxFrames)
+{
+    // Never call this function on a running emulator
+    assert(isPaused());
+    
+    // Run as fast as possible
+    bool wasWarping = warpMode;
+    if (!wasWarping) HardwareComponent::warpOn();
+
+    auto target = agnus.frame.nr + maxFrames;
+    bool result = false;
+    
+    while (agnus.frame.nr < target) {
+        
+        // Check the stop condition
+        if (cond()) { result = true; break; }
+        
+        // Emulate the next CPU instruction
+        {
+            PROFILE(PROBE_CPU);
+            cpu.execute();
+        }
+        
+        // Check if special action needs to be taken
+        if (runLoopCtrl) {
+            
+            if (runLoopCtrl & RL_AUTO_SNAPSHOT) {
+                autoSnapshot = Snapshot::makeWithAmiga(this);
+                msgQueue.put(MSG_AUTO_SNAPSHOT_TAKEN);
+                clearControlFlags(RL_AUTO_SNAPSHOT);
+            }
+            
+            if (runLoopCtrl & RL_USER_SNAPSHOT) {
+                userSnapshot = Snapshot::makeWithAmiga(this);
+                msgQueue.put(MSG_USER_SNAPSHOT_TAKEN);
+                clearControlFlags(RL_USER_SNAPSHOT);
+            }
+            
+            if (runLoopCtrl & RL_DELTA_SNAPSHOT) {
+                snapshotChain.record();
+                clearControlFlags(RL_DELTA_SNAPSHOT);
+            }
+            
+            if (runLoopCtrl & RL_INSPECT) {
+                inspect();
+                clearControlFlags(RL_INSPECT);
+            }
+            
+            if (runLoopCtrl & RL_BREAKPOINT_REACHED) {
+                msgQueue.put(MSG_BREAKPOINT_REACHED);
+                clearControlFlags(RL_BREAKPOINT_REACHED);
+                break;
+            }
+            
+            if (runLoopCtrl & RL_WATCHPOINT_REACHED) {
+                msgQueue.put(MSG_WATCHPOINT_REACHED);
+                clearControlFlags(RL_WATCHPOINT_REACHED);
+                break;
+            }
+            
+            if (runLoopCtrl & RL_STOP) {
+                clearControlFlags(RL_STOP);
+                break;
+            }
+            
+            // Warp mode is restored below
+            clearControlFlags(RL_WARP_ON | RL_WARP_OFF);
+        }
+    }
+    
+    /* Restore warp mode. The warp policy is bypassed, but if it has switched
+     * warp mode on in the meantime, warp mode is kept and the policy switches
+     * it off later.
+     */
+    if (!wasWarping && !oscillator.inAutoWarp()) HardwareComponent::warpOff();
+    
+    // Update the recorded debug information
+    inspect();
+    
+    return result;
+}
+
 void
 Amiga::requestAutoSnapshot()
 {
@@ -905,6 +1065,21 @@ Amiga::requestUserSnapshot()
     }
 }
 
+void
+Amiga::requestDeltaSnapshot()
+{
+    if (!isRunning()) {
+        
+        // Take snapshot immediately
+        snapshotChain.record();
+        
+    } else {
+        
+        // Schedule the snapshot to be taken
+        signalDeltaSnapshot();
+    }
+}
+
 Snapshot *
 Amiga::latestAutoSnapshot()
 {
@@ -941,3 +1116,19 @@ Amiga::loadFromSnapshotSafe(Snapshot *snapshot)
     loadFromSnapshotUnsafe(snapshot);
     resume();
 }
+
+void
+Amiga::loadFromSnapshotChain(isize nr)
+{
+    trace(SNP_DEBUG, "loadFromSnapshotChain(%zd)\n", nr);
+    
+    if (nr < 0 || nr >= snapshotChain.count()) {
+        throw VAError(ERROR_SNP_NOT_RECORDED);
+    }
+    
+    suspend();
+    snapshotChain.restore(nr);
+    resume();
+
+    msgQueue.put(MSG_SNAPSHOT_RESTORED);
+}
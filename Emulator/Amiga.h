@@ -16,15 +16,19 @@
 #include "CPU.h"
 #include "Denise.h"
 #include "Drive.h"
+#include "GuestProfiler.h"
+#include "HdController.h"
 #include "Keyboard.h"
 #include "Memory.h"
 #include "MsgQueue.h"
 #include "Oscillator.h"
 #include "Paula.h"
+#include "Profiler.h"
 #include "RegressionTester.h"
 #include "RetroShell.h"
 #include "RTC.h"
 #include "SerialPort.h"
+#include "SnapshotChain.h"
 #include "ZorroManager.h"
 
 void threadTerminated(void *thisAmiga);
@@ -86,6 +90,9 @@ public:
     // Shortcuts to all four drives
     Drive *df[4] = { &df0, &df1, &df2, &df3 };
     
+    // Hard drive controller
+    HdController hdController = HdController(*this);
+    
     // Command console
     RetroShell retroShell = RetroShell(*this);
     
@@ -95,6 +102,12 @@ public:
     // Regression test manager
     RegressionTester regressionTester;
     
+    // Host time profiler
+    Profiler profiler = Profiler(*this);
+    
+    // Sampling profiler for the emulated software
+    GuestProfiler guestProfiler = GuestProfiler(*this);
+    
     
     //
     // Emulator thread
@@ -129,6 +142,11 @@ private:
     class Snapshot *autoSnapshot = nullptr;
     class Snapshot *userSnapshot = nullptr;
 
+public:
+    
+    // Incrementally recorded snapshots (used for rewinding)
+    SnapshotChain snapshotChain = SnapshotChain(*this);
+
     
     //
     // Initializing
@@ -290,6 +308,7 @@ public:
     void signalWarpOff() { setControlFlags(RL_WARP_OFF); }
     void signalAutoSnapshot() { setControlFlags(RL_AUTO_SNAPSHOT); }
     void signalUserSnapshot() { setControlFlags(RL_USER_SNAPSHOT); }
+    void signalDeltaSnapshot() { setControlFlags(RL_DELTA_SNAPSHOT); }
 
     //
     // Running the emulator
@@ -331,6 +350,34 @@ public:
      * this function should be your starting point.
      */
     void runLoop();
+    
+    /* Emulates the specified number of frames inside the calling thread. This
+     * function is intended for headless front ends that manage threads on
+     * their own, such as the batch runner which drives many Amiga instances
+     * from a worker pool. The Amiga must be powered on and must not be
+     * running. Emulation is performed in warp mode and stops early if a
+     * breakpoint or a watchpoint is reached. The function returns the number
+     * of emulated frames.
+     */
+    isize executeFrames(isize count);
+
+    /* Emulates inside the calling thread until a stop condition is met. The
+     * functions stop when the CPU is about to execute the instruction at the
+     * specified address, when the specified memory byte equals the specified
+     * value (as seen by the CPU), or when the specified master cycle has been
+     * reached. Like executeFrames(), the functions run in warp mode and stop
+     * early if a breakpoint or a watchpoint is reached. They give up after
+     * 'maxFrames' frames and return true iff the condition has been met.
+     * Afterwards, warp mode is restored without involving the warp policy.
+     */
+    bool executeUntilPC(u32 addr, isize maxFrames);
+    bool executeUntilValue(u32 addr, u8 value, isize maxFrames);
+    bool executeUntilCycle(Cycle cycle);
+
+private:
+
+    // Common implementation of the functions above
+    template <class Condition> bool executeUntil(Condition cond, isize maxFrames);
 
     
     //
@@ -346,6 +393,13 @@ public:
      */
     void requestAutoSnapshot();
     void requestUserSnapshot();
+    
+    /* Requests the current state to be appended to the snapshot chain. In
+     * contrast to the functions above, only the memory pages which have been
+     * modified since the previous request are recorded. This makes the
+     * function cheap enough to be called once per frame.
+     */
+    void requestDeltaSnapshot();
      
     // Returns the most recent snapshot or nullptr if none was taken
     Snapshot *latestAutoSnapshot();
@@ -358,4 +412,7 @@ public:
      */
     void loadFromSnapshotUnsafe(Snapshot *snapshot);
     void loadFromSnapshotSafe(Snapshot *snapshot);
+    
+    // Restores a state from the snapshot chain
+    void loadFromSnapshotChain(isize nr) throws;
 };
@@ -25,7 +25,8 @@ enum_u32(RunLoopControlFlag)
     RL_BREAKPOINT_REACHED = 0b000010000,
     RL_WATCHPOINT_REACHED = 0b000100000,
     RL_AUTO_SNAPSHOT      = 0b001000000,
-    RL_USER_SNAPSHOT      = 0b010000000
+    RL_USER_SNAPSHOT      = 0b010000000,
+    RL_DELTA_SNAPSHOT     = 0b100000000
 };
 
 enum_long(CONFIG_SCHEME)
@@ -28,12 +28,14 @@ df0(ref.df0),
 df1(ref.df1),
 df2(ref.df2),
 df3(ref.df3),
+hdController(ref.hdController),
 keyboard(ref.keyboard),
 mem(ref.mem),
 messageQueue(ref.msgQueue),
 oscillator(ref.oscillator),
 paula(ref.paula),
 pixelEngine(ref.denise.pixelEngine),
+profiler(ref.profiler),
 retroShell(ref.retroShell),
 rtc(ref.rtc),
 serialPort(ref.serialPort),
@@ -24,6 +24,7 @@ class Denise;
 class DiskController;
 class DmaDebugger;
 class Drive;
+class HdController;
 class Joystick;
 class Keyboard;
 class Memory;
@@ -32,6 +33,7 @@ class MsgQueue;
 class Oscillator;
 class Paula;
 class PixelEngine;
+class Profiler;
 class RetroShell;
 class RTC;
 class SerialPort;
@@ -61,12 +63,14 @@ protected:
     Drive &df1;
     Drive &df2;
     Drive &df3;
+    HdController &hdController;
     Keyboard &keyboard;
     Memory &mem;
     MsgQueue &messageQueue;
     Oscillator &oscillator;
     Paula &paula;
     PixelEngine &pixelEngine;
+    Profiler &profiler;
     RetroShell &retroShell;
     RTC &rtc;
     SerialPort &serialPort;
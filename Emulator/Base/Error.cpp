@@ -98,6 +98,14 @@ VAError::VAError(ErrorCode code, const string &s)
             description += " and is incompatible with this release.";
             break;
 
+        case ERROR_SNP_NOT_RECORDED:
+            description = "The requested snapshot has not been recorded.";
+            break;
+
+        case ERROR_SNP_CORRUPTED:
+            description = "The snapshot file is corrupted.";
+            break;
+
         case ERROR_MISSING_ROM_KEY:
             description = "No \"rom.key\" file found.";
             break;
@@ -47,6 +47,8 @@ enum_long(ERROR_CODE)
     // Snapshots
     ERROR_SNP_TOO_OLD,
     ERROR_SNP_TOO_NEW,
+    ERROR_SNP_NOT_RECORDED,
+    ERROR_SNP_CORRUPTED,
     
     // Encrypted Roms
     ERROR_MISSING_ROM_KEY,
@@ -129,6 +131,8 @@ struct ErrorCodeEnum : util::Reflection<ErrorCodeEnum, ErrorCode> {
                 
             case ERROR_SNP_TOO_OLD:                 return "SNP_TOO_OLD";
             case ERROR_SNP_TOO_NEW:                 return "SNP_TOO_NEW";
+            case ERROR_SNP_NOT_RECORDED:            return "SNP_NOT_RECORDED";
+            case ERROR_SNP_CORRUPTED:               return "SNP_CORRUPTED";
                 
             case ERROR_MISSING_ROM_KEY:             return "MISSING_ROM_KEY";
             case ERROR_INVALID_ROM_KEY:             return "INVALID_ROM_KEY";
@@ -292,12 +292,19 @@ private:
 // Standard implementations of _reset, _load, and _save
 //
 
+/* The items processed by the standard implementation are of fixed size. Hence,
+ * the snapshot size only depends on the component type and can be computed
+ * once and cached in a static variable.
+ */
 #define COMPUTE_SNAPSHOT_SIZE \
+static const isize cachedSize = [this]() { \
 util::SerCounter counter; \
 applyToPersistentItems(counter); \
 applyToHardResetItems(counter); \
 applyToResetItems(counter); \
-return counter.count;
+return counter.count; \
+}(); \
+return cachedSize;
 
 #define RESET_SNAPSHOT_ITEMS(hard) \
 { \
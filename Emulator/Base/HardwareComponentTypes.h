@@ -21,6 +21,13 @@ enum_long(OPT)
     // Agnus
     OPT_AGNUS_REVISION,
     OPT_SLOW_RAM_MIRROR,
+    OPT_EVENT_SCHEDULER,
+    
+    // Oscillator
+    OPT_WARP_DISK,
+    OPT_WARP_SCRIPT,
+    OPT_WARP_BOOT,
+    OPT_WARP_DELAY,
     
     // Denise
     OPT_DENISE_REVISION,
@@ -127,6 +134,12 @@ struct OptionEnum : util::Reflection<OptionEnum, Option> {
                 
             case OPT_AGNUS_REVISION:      return "AGNUS_REVISION";
             case OPT_SLOW_RAM_MIRROR:     return "SLOW_RAM_MIRROR";
+            case OPT_EVENT_SCHEDULER:     return "EVENT_SCHEDULER";
+                
+            case OPT_WARP_DISK:           return "WARP_DISK";
+            case OPT_WARP_SCRIPT:         return "WARP_SCRIPT";
+            case OPT_WARP_BOOT:           return "WARP_BOOT";
+            case OPT_WARP_DELAY:          return "WARP_DELAY";
                 
             case OPT_DENISE_REVISION:     return "DENISE_REVISION";
                 
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "Profiler.h"
+#include "IO.h"
+
+#include <iomanip>
+
+Profiler::Profiler(Amiga& ref) : AmigaComponent(ref)
+{
+    clear();
+}
+
+bool
+Profiler::isEnabled()
+{
+#ifdef PROFILING
+    return true;
+#else
+    return false;
+#endif
+}
+
+void
+Profiler::clear()
+{
+    for (isize i = 0; i < SLOT_COUNT; i++) slotCounter[i] = { };
+    for (isize i = 0; i < PROBE_COUNT; i++) probeCounter[i] = { };
+
+    startTicks = ticks();
+    startTime = util::Time::now();
+    frame = 0;
+    sampling = false;
+    sampledFrames = 0;
+    rootTicks = 0;
+}
+
+void
+Profiler::vsyncHandler()
+{
+    if (sampling) sampledFrames++;
+    sampling = ++frame % sampleRate == 0;
+}
+
+void
+Profiler::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+
+    if (category & dump::State) {
+
+        if (!isEnabled()) {
+
+            os << "The profiler has been compiled out. ";
+            os << "Define PROFILING in config.h to enable it." << std::endl;
+            return;
+        }
+
+        // Calibrate the time stamp counter
+        i64 elapsedTicks = ticks() - startTicks;
+        i64 elapsedNs = (util::Time::now() - startTime).asNanoseconds();
+        double nsPerTick = elapsedTicks ? (double)elapsedNs / elapsedTicks : 0;
+
+        os << tab("Elapsed time");
+        os << std::fixed << std::setprecision(3) << elapsedNs / 1e6 << " ms" << std::endl;
+        os << tab("Time stamp counter");
+        os << std::setprecision(3) << (nsPerTick ? 1 / nsPerTick : 0) << " GHz" << std::endl;
+        os << std::endl;
+
+        os << std::left << std::setw(10) << "Probe";
+        os << std::right << std::setw(14) << "Calls";
+        os << std::right << std::setw(14) << "Self (ms)";
+        os << std::right << std::setw(10) << "Share";
+        os << std::right << std::setw(14) << "ns / call" << std::endl;
+
+        for (isize i = 0; i < PROBE_COUNT; i++) {
+
+            dumpCounter(os, ProfilerProbeEnum::key((ProfilerProbe)i),
+                        probeCounter[i], nsPerTick);
+        }
+        for (isize i = 0; i < SLOT_COUNT; i++) {
+
+            if (slotCounter[i].calls == 0) continue;
+            string name = "SLOT_" + string(EventSlotEnum::key((EventSlot)i));
+            dumpCounter(os, name.c_str(), slotCounter[i], nsPerTick);
+        }
+    }
+}
+
+void
+Profiler::dumpCounter(std::ostream& os, const char *name,
+                      const ProfilerCounter &counter, double nsPerTick) const
+{
+    // Extrapolate the ticks measured in sampled frames to all emulated frames
+    i64 sampled = counter.ticks - counter.nested;
+    double scale = sampledFrames ? (double)frame / sampledFrames : 0;
+    double self = sampled * scale;
+
+    os << std::left << std::setw(10) << name;
+    os << std::right << std::setw(14) << counter.calls;
+    os << std::fixed << std::setprecision(3);
+    os << std::right << std::setw(14) << self * nsPerTick / 1e6;
+    os << std::setprecision(2);
+    os << std::right << std::setw(9) << (rootTicks ? 100.0 * sampled / rootTicks : 0) << "%";
+    os << std::setprecision(1);
+    os << std::right << std::setw(14) << (counter.calls ? self * nsPerTick / counter.calls : 0);
+    os << std::endl;
+}
@@ -0,0 +1,187 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "ProfilerTypes.h"
+#include "AmigaComponent.h"
+#include "EventHandlerTypes.h"
+#include "Chrono.h"
+
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+/* This class attributes host time to the emulator's hot paths. Each event
+ * slot handler and a couple of subsystems (see ProfilerProbe) are covered by
+ * a probe which counts the number of calls and the number of elapsed host
+ * ticks. Probes may be nested, e.g., a CPU instruction may trigger the
+ * execution of multiple event handlers. For each probe, the time spent in
+ * nested probes is recorded separately which allows to compute the time
+ * spent in the probed code itself.
+ *
+ * Reading the time stamp counter is the most expensive part of a probe. To
+ * keep the overhead low, the counter is only read in every sampleRate-th
+ * frame. Calls are counted in all frames. When the results are printed, the
+ * measured ticks are scaled up by the ratio of emulated to sampled frames.
+ * Shares refer to the time spent in outermost probes, which excludes any time
+ * spent in pause mode. Nevertheless, a build with probes runs noticeably
+ * slower than a regular build. Its frame rate is therefore not representative
+ * and must not be used for measuring emulator performance.
+ *
+ * The probes are compiled out unless PROFILING is defined in config.h.
+ */
+class Profiler : public AmigaComponent {
+
+    friend class ProfilerScope;
+
+    // Counters for all event slots and all subsystem probes
+    ProfilerCounter slotCounter[SLOT_COUNT];
+    ProfilerCounter probeCounter[PROBE_COUNT];
+
+    // The counter of the innermost running probe
+    ProfilerCounter *current = nullptr;
+
+    // Only every sampleRate-th frame is timed
+    static constexpr isize sampleRate = 8;
+
+    // Number of emulated frames and the sampling state of the current frame
+    i64 frame = 0;
+    bool sampling = false;
+
+    // Number of sampled frames
+    i64 sampledFrames = 0;
+
+    // Host ticks spent in outermost probes (in sampled frames)
+    i64 rootTicks = 0;
+
+    // Reference points taken when the counters were cleared
+    i64 startTicks = 0;
+    util::Time startTime;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    Profiler(Amiga& ref);
+
+    const char *getDescription() const override { return "Profiler"; }
+
+private:
+
+    void _initialize() override { };
+    void _reset(bool hard) override { };
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    // Checks whether the probes have been compiled in
+    static bool isEnabled();
+
+    const ProfilerCounter &getSlotCounter(EventSlot nr) const { return slotCounter[nr]; }
+    const ProfilerCounter &getProbeCounter(ProfilerProbe nr) const { return probeCounter[nr]; }
+
+    // Resets all counters
+    void clear();
+
+private:
+
+    void _dump(dump::Category category, std::ostream& os) const override;
+    void dumpCounter(std::ostream& os, const char *name,
+                     const ProfilerCounter &counter, double nsPerTick) const;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Probing
+    //
+
+public:
+
+    // Reads the host's time stamp counter
+    static i64 ticks()
+    {
+#if defined(__i386__) || defined(__x86_64__)
+        return (i64)__rdtsc();
+#else
+        return util::Time::now().asNanoseconds();
+#endif
+    }
+
+    ProfilerCounter &slot(EventSlot nr) { return slotCounter[nr]; }
+    ProfilerCounter &probe(ProfilerProbe nr) { return probeCounter[nr]; }
+
+    // Decides whether the next frame is timed (called once per frame)
+    void vsyncHandler();
+};
+
+/* A probe. The object counts a call in the provided counter. In sampled
+ * frames, it also records the host ticks elapsed between its construction and
+ * its destruction.
+ */
+class ProfilerScope {
+
+    Profiler &profiler;
+    ProfilerCounter &counter;
+    ProfilerCounter *parent = nullptr;
+    i64 start = 0;
+    bool timed;
+
+public:
+
+    ProfilerScope(Profiler &p, ProfilerCounter &c) :
+    profiler(p), counter(c), timed(p.sampling)
+    {
+        counter.calls++;
+        
+        if (timed) {
+            
+            parent = profiler.current;
+            profiler.current = &counter;
+            start = Profiler::ticks();
+        }
+    }
+
+    ~ProfilerScope()
+    {
+        if (!timed) return;
+        
+        i64 elapsed = Profiler::ticks() - start;
+
+        counter.ticks += elapsed;
+        if (parent) parent->nested += elapsed;
+        else profiler.rootTicks += elapsed;
+        profiler.current = parent;
+    }
+};
+
+#ifdef PROFILING
+#define PROFILE(nr) ProfilerScope _profilerScope(profiler, profiler.probe(nr))
+#define PROFILE_SLOT(nr) ProfilerScope _profilerScope(profiler, profiler.slot(nr))
+#else
+#define PROFILE(nr)
+#define PROFILE_SLOT(nr)
+#endif
@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include "Reflection.h"
+
+//
+// Enumerations
+//
+
+enum_long(PROBE)
+{
+    PROBE_CPU,          // CPU instruction execution
+    PROBE_CIA,          // CIA execution
+    PROBE_DENISE,       // Denise line drawing
+    PROBE_MUXER,        // Audio synthesis
+    PROBE_DISK,         // Disk DMA
+
+    PROBE_COUNT
+};
+typedef PROBE ProfilerProbe;
+
+#ifdef __cplusplus
+struct ProfilerProbeEnum : util::Reflection<ProfilerProbeEnum, ProfilerProbe> {
+
+    static bool isValid(long value)
+    {
+        return (unsigned long)value < PROBE_COUNT;
+    }
+
+    static const char *prefix() { return "PROBE"; }
+    static const char *key(ProfilerProbe value)
+    {
+        switch (value) {
+
+            case PROBE_CPU:     return "CPU";
+            case PROBE_CIA:     return "CIA";
+            case PROBE_DENISE:  return "DENISE";
+            case PROBE_MUXER:   return "MUXER";
+            case PROBE_DISK:    return "DISK";
+            case PROBE_COUNT:   return "???";
+        }
+        return "???";
+    }
+};
+#endif
+
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Number of times the probed code has been executed
+    i64 calls;
+
+    // Host ticks spent inside the probed code (in sampled frames)
+    i64 ticks;
+
+    // Host ticks spent inside nested probes (in sampled frames)
+    i64 nested;
+}
+ProfilerCounter;
@@ -10,9 +10,29 @@
 #include "config.h"
 #include "RegressionTester.h"
 #include "Amiga.h"
+#include "Checksum.h"
+#include "Compression.h"
 #include "IO.h"
 
 #include <fstream>
+#include <iomanip>
+
+// Magic bytes of reference images
+static const u8 refMagic[] = { 'V', 'A', 'R', 'E', 'F' };
+
+// Writes a 32-bit value in little endian format
+static void write32(std::ostream &stream, u32 value)
+{
+    for (isize i = 0; i < 4; i++) stream.put((char)(value >> (8 * i)));
+}
+
+// Reads a 32-bit value in little endian format
+static u32 read32(std::istream &stream)
+{
+    u32 result = 0;
+    for (isize i = 0; i < 4; i++) result |= (u32)(u8)stream.get() << (8 * i);
+    return result;
+}
 
 void
 RegressionTester::dumpTexture(Amiga &amiga) const
@@ -23,10 +43,11 @@ RegressionTester::dumpTexture(Amiga &amiga) const
 void
 RegressionTester::dumpTexture(Amiga &amiga, const string &filename) const
 {
-    /* This function is used for automatic regression testing. It generates a
-     * TIFF image of the current emulator texture in the /tmp directory and
-     * exits the application. The regression testing script will pick up the
+    /* This function is used by the external regression testing script. It
+     * generates a TIFF image of the current emulator texture in the /tmp
+     * directory and exits the application. The script will pick up the
      * texture and compare it against a previously recorded reference image.
+     * Use verify() to compare the texture in place without exiting.
      */
     std::ofstream file;
         
@@ -35,7 +56,7 @@ RegressionTester::dumpTexture(Amiga &amiga, const string &filename) const
     string tiffFile = "/tmp/" + filename + ".tiff";
 
     // Open an output stream
-    file.open(rawFile.c_str());
+    file.open(rawFile.c_str(), std::ios::binary);
     
     // Dump texture
     dumpTexture(amiga, file);
@@ -57,21 +78,183 @@ RegressionTester::dumpTexture(Amiga &amiga, const string &filename) const
 
 void
 RegressionTester::dumpTexture(Amiga &amiga, std::ostream& os) const
+{
+    std::vector<u8> rgb;
+    grabCutout(amiga, rgb);
+
+    os.write((const char *)rgb.data(), rgb.size());
+}
+
+void
+RegressionTester::grabCutout(Amiga &amiga, std::vector<u8> &rgb) const
 {
     auto buffer = amiga.denise.pixelEngine.getStableBuffer();
-    
+
+    isize w = std::max(x2 - x1, (isize)0);
+    isize h = std::max(y2 - y1, (isize)0);
+    rgb.resize(3 * w * h);
+
+    u8 *dst = rgb.data();
     for (isize y = y1; y < y2; y++) {
 
-        for (isize x = x1; x < x2; x++) {
-            
-            char *cptr = (char *)(buffer.data + y * HPIXELS + x);
-            os.write(cptr + 0, 1);
-            os.write(cptr + 1, 1);
-            os.write(cptr + 2, 1);
+        const u8 *src = (const u8 *)(buffer.data + y * HPIXELS + x1);
+        for (isize x = 0; x < w; x++, src += 4) {
+
+            *dst++ = src[0];
+            *dst++ = src[1];
+            *dst++ = src[2];
         }
     }
 }
 
+u64
+RegressionTester::computeHash(Amiga &amiga) const
+{
+    std::vector<u8> rgb;
+    grabCutout(amiga, rgb);
+
+    return util::fnv_1a_64(rgb.data(), (isize)rgb.size());
+}
+
+void
+RegressionTester::saveReference(Amiga &amiga, const string &path) const
+{
+    std::vector<u8> rgb;
+    grabCutout(amiga, rgb);
+
+    std::vector<u8> compressed(util::lz4Bound((isize)rgb.size()));
+    isize len = util::lz4Compress(rgb.data(), (isize)rgb.size(), compressed.data());
+
+    std::ofstream stream(path, std::ios::binary);
+    if (!stream.is_open()) throw VAError(ERROR_FILE_CANT_CREATE);
+
+    stream.write((const char *)refMagic, sizeof(refMagic));
+    write32(stream, (u32)(x2 - x1));
+    write32(stream, (u32)(y2 - y1));
+    write32(stream, (u32)len);
+    stream.write((const char *)compressed.data(), len);
+
+    if (!stream) throw VAError(ERROR_FILE_CANT_WRITE);
+}
+
+void
+RegressionTester::loadReference(const string &path, isize &width, isize &height,
+                                std::vector<u8> &rgb) const
+{
+    std::ifstream stream(path, std::ios::binary);
+    if (!stream.is_open()) throw VAError(ERROR_FILE_NOT_FOUND, path);
+
+    if (!util::matchingStreamHeader(stream, refMagic, sizeof(refMagic))) {
+        throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    }
+
+    stream.seekg(sizeof(refMagic), std::ios::beg);
+    width = read32(stream);
+    height = read32(stream);
+    isize len = read32(stream);
+
+    if (!stream || width > HPIXELS || height > VPIXELS) {
+        throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    }
+
+    std::vector<u8> compressed(len);
+    stream.read((char *)compressed.data(), len);
+    if (!stream) throw VAError(ERROR_FILE_CANT_READ);
+
+    rgb.resize(3 * width * height);
+    if (util::lz4Decompress(compressed.data(), len,
+                            rgb.data(), (isize)rgb.size()) != (isize)rgb.size()) {
+        throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    }
+}
+
+bool
+RegressionTester::verify(Amiga &amiga, const string &name, const string &reference)
+{
+    // Compare against a hash value if no reference image exists
+    if (!util::fileExists(reference)) {
+
+        try {
+
+            usize pos;
+            u64 hash = std::stoull(reference, &pos, 16);
+            if (pos != reference.size()) throw VAError(ERROR_FILE_NOT_FOUND, reference);
+            return verify(amiga, name, hash);
+
+        } catch (std::logic_error &) {
+            throw VAError(ERROR_FILE_NOT_FOUND, reference);
+        }
+    }
+
+    isize width, height;
+    std::vector<u8> expected, rgb;
+
+    loadReference(reference, width, height, expected);
+    grabCutout(amiga, rgb);
+
+    Result result;
+    result.name = name;
+    result.hash = util::fnv_1a_64(rgb.data(), (isize)rgb.size());
+
+    if (width != x2 - x1 || height != y2 - y1) {
+
+        // The cutouts don't match. Count all pixels as mismatches
+        result.mismatches = std::max(width * height, (x2 - x1) * (y2 - y1));
+
+    } else {
+
+        result.mismatches = 0;
+        for (usize i = 0; i < rgb.size(); i += 3) {
+
+            if (rgb[i] != expected[i] ||
+                rgb[i + 1] != expected[i + 1] ||
+                rgb[i + 2] != expected[i + 2]) result.mismatches++;
+        }
+    }
+    result.passed = result.mismatches == 0;
+
+    results.push_back(result);
+    return result.passed;
+}
+
+bool
+RegressionTester::verify(Amiga &amiga, const string &name, u64 hash)
+{
+    Result result;
+    result.name = name;
+    result.hash = computeHash(amiga);
+    result.mismatches = -1;
+    result.passed = result.hash == hash;
+
+    results.push_back(result);
+    return result.passed;
+}
+
+isize
+RegressionTester::failures() const
+{
+    isize result = 0;
+    for (auto &it : results) if (!it.passed) result++;
+    return result;
+}
+
+void
+RegressionTester::report(std::ostream& os) const
+{
+    for (auto &it : results) {
+
+        os << std::left << std::setw(32) << it.name << std::right;
+        os << (it.passed ? "  PASS  " : "  FAIL  ");
+        os << std::hex << std::setw(16) << std::setfill('0') << it.hash;
+        os << std::dec << std::setfill(' ');
+        if (it.mismatches > 0) os << "  " << it.mismatches << " pixels differ";
+        os << std::endl;
+    }
+
+    os << std::endl;
+    os << "Tests:  " << results.size() << " (" << failures() << " failed)" << std::endl;
+}
+
 void
 RegressionTester::setErrorCode(u8 value)
 {
@@ -12,52 +12,124 @@
 #include "AmigaObject.h"
 #include "Constants.h"
 
+#include <vector>
+
+/* The regression tester compares the emulator texture with a reference. Only
+ * the pixels inside the texture cutout (x1,y1) - (x2,y2) are considered. A
+ * reference is either a 64-bit FNV-1a hash of the cutout or a reference image.
+ * Reference images store the cutout as 24-bit RGB data compressed in the LZ4
+ * block format:
+ *
+ *     Header:  Magic bytes ('V','A','R','E','F')
+ *              Width and height of the cutout (u32)
+ *              Size of the compressed data (u32)
+ *     Data:    Compressed RGB data
+ *
+ * All numbers are stored in little endian format. The outcome of each check
+ * is recorded and the emulator keeps on running, which allows to process many
+ * tests inside a single emulator instance.
+ */
 class RegressionTester : public AmigaObject {
 
 public:
-        
+
+    struct Result {
+
+        // Name of the test
+        string name;
+
+        // Outcome
+        bool passed;
+
+        // Hash of the texture cutout
+        u64 hash;
+
+        // Number of differing pixels (only computed for reference images)
+        isize mismatches;
+    };
+
     // Filename of the test image
     string dumpTexturePath = "texture";
-    
+
     // Texture cutout
     isize x1 = 4 * (HBLANK_MAX + 1);
     isize y1 = VBLANK_MAX + 1;
     isize x2 = HPIXELS;
     isize y2 = VPIXELS;
-    
+
+    // Recorded test results
+    std::vector<Result> results;
+
 private:
-    
+
     // When the emulator exits, this value is returned to the test script
     u8 retValue = 0;
 
-    
+
     //
     // Methods from AmigaObject
     //
-    
+
 private:
-    
+
     const char *getDescription() const override { return "RegressionTester"; }
-    
-    
+
+
     //
     // Taking screenshots
     //
 
 public:
-    
+
     // Creates the test image and exits the emulator
     void dumpTexture(class Amiga &amiga) const;
     void dumpTexture(class Amiga &amiga, const string &filename) const;
     void dumpTexture(class Amiga &amiga, std::ostream& os) const;
 
-    
+private:
+
+    // Copies the texture cutout into a buffer (24-bit RGB)
+    void grabCutout(class Amiga &amiga, std::vector<u8> &rgb) const;
+
+
+    //
+    // Comparing screenshots
+    //
+
+public:
+
+    // Computes the hash of the texture cutout
+    u64 computeHash(class Amiga &amiga) const;
+
+    // Saves the texture cutout as a reference image
+    void saveReference(class Amiga &amiga, const string &path) const throws;
+
+    /* Compares the texture cutout with a reference and records the result.
+     * The reference is either the path to a reference image or a hash value
+     * in hexadecimal notation.
+     */
+    bool verify(class Amiga &amiga, const string &name, const string &reference) throws;
+    bool verify(class Amiga &amiga, const string &name, u64 hash);
+
+    // Returns the number of failed tests
+    isize failures() const;
+
+    // Prints all recorded results
+    void report(std::ostream& os) const;
+
+private:
+
+    // Reads a reference image
+    void loadReference(const string &path, isize &width, isize &height,
+                       std::vector<u8> &rgb) const throws;
+
+
     //
     // Handling errors
     //
 
 public:
-    
+
     // Assigns the return code
     void setErrorCode(u8 value);
 };
@@ -16,6 +16,7 @@
 #include "Memory.h"
 #include "MsgQueue.h"
 #include "Paula.h"
+#include "Profiler.h"
 #include "SerialPort.h"
 
 #define CIA_DEBUG (nr == 0 ? CIAA_DEBUG : CIAB_DEBUG)
@@ -339,6 +340,8 @@ CIA::todInterrupt()
 void
 CIA::executeOneCycle()
 {
+    PROFILE(PROBE_CIA);
+    
     clock += CIA_CYCLES(1);
     
     // debug("Executing CIA: new clock = %lld\n", clock);
@@ -15,6 +15,8 @@
 #include "Memory.h"
 #include "MsgQueue.h"
 
+#include <algorithm>
+
 //
 // Moira
 //
@@ -31,16 +33,49 @@ Moira::sync(int cycles)
     agnus.executeUntil(CPU_CYCLES(clock));
 }
 
+void
+Moira::syncStopped(int cycles)
+{
+    /* The IPL lines can only change after an event has modified INTREQ or
+     * INTENA. Hence, all steps that complete before the next event of this
+     * kind is due can be merged into a single one. All other events (e.g.,
+     * bitplane DMA) are served by Agnus as usual. The number of merged steps
+     * is small, because the RAS slot contains an HSYNC event in each line.
+     */
+    i64 steps = (AS_CPU_CYCLES(agnus.nextIrqTrigger()) - clock) / cycles;
+    steps = std::clamp(steps, (i64)1, (i64)HPOS_CNT);
+    
+    sync((int)(steps * cycles));
+}
+
 u8
 Moira::read8(u32 addr)
 {
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    
+    // Fast path: Access Fast Ram and Roms directly
+    if (u8 *page = mem.cpuReadPage[bank]) {
+        
+        (*mem.cpuReadCounter[bank])++;
+        return R8BE_ALIGNED(page + (addr & 0xFFFF));
+    }
+    
     return mem.peek8 <ACCESSOR_CPU> (addr);
 }
 
 u16
 Moira::read16(u32 addr)
 {
-    return mem.peek16 <ACCESSOR_CPU> (addr); 
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    
+    // Fast path: Access Fast Ram and Roms directly
+    if (u8 *page = mem.cpuReadPage[bank]) {
+        
+        (*mem.cpuReadCounter[bank])++;
+        return R16BE_ALIGNED(page + (addr & 0xFFFF));
+    }
+    
+    return mem.peek16 <ACCESSOR_CPU> (addr);
 }
 
 u16
@@ -60,6 +95,17 @@ Moira::write8(u32 addr, u8 val)
 {
     trace(XFILES && addr - reg.pc < 5, "XFILES: write8 close to PC %x\n", reg.pc);
 
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    
+    // Fast path: Access Fast Ram and unlocked Wom directly
+    if (u8 *page = mem.cpuWritePage[bank]) {
+        
+        (*mem.cpuWriteCounter[bank])++;
+        mem.cpuWriteDirty[bank][(addr & 0xFFFF) >> Memory::dirtyPageShift] = 1;
+        W8BE_ALIGNED(page + (addr & 0xFFFF), val);
+        return;
+    }
+    
     mem.poke8 <ACCESSOR_CPU> (addr, val);
 }
 
@@ -68,6 +114,17 @@ Moira::write16 (u32 addr, u16 val)
 {
     trace(XFILES && addr - reg.pc < 5, "XFILES: write16 close to PC %x\n", reg.pc);
 
+    isize bank = (addr & 0xFFFFFF) >> 16;
+    
+    // Fast path: Access Fast Ram and unlocked Wom directly
+    if (u8 *page = mem.cpuWritePage[bank]) {
+        
+        (*mem.cpuWriteCounter[bank])++;
+        mem.cpuWriteDirty[bank][(addr & 0xFFFF) >> Memory::dirtyPageShift] = 1;
+        W16BE_ALIGNED(page + (addr & 0xFFFF), val);
+        return;
+    }
+    
     mem.poke16 <ACCESSOR_CPU> (addr, val);
 }
 
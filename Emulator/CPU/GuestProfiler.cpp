@@ -0,0 +1,346 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "GuestProfiler.h"
+#include "Agnus.h"
+#include "CPU.h"
+#include "IO.h"
+#include "Memory.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+void
+GuestProfiler::_reset(bool hard)
+{
+    // Agnus has wiped out all events. Continue sampling if requested
+    if (running) agnus.scheduleRel<SLOT_PRF>(DMA_CYCLES(period), PRF_SAMPLE);
+}
+
+void
+GuestProfiler::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+
+    if (category & dump::State) {
+
+        os << tab("Sampling");
+        os << bol(running) << std::endl;
+        os << tab("Period");
+        os << dec(period) << " DMA cycles" << std::endl;
+        os << tab("Stack depth");
+        os << dec(depth) << std::endl;
+        os << tab("Samples");
+        os << dec(samples) << std::endl;
+        os << tab("Call stacks");
+        os << dec((i64)stacks.size()) << std::endl;
+
+        for (auto &region : regions) {
+
+            os << tab("Region " + region.name);
+            os << hex(region.start) << " - " << hex(region.end) << std::endl;
+        }
+        os << std::endl;
+
+        flatProfile(os);
+    }
+}
+
+void
+GuestProfiler::flatProfile(std::ostream& os, isize count) const
+{
+    auto percent = [&](i64 value) {
+        return samples ? 100.0 * value / samples : 0.0;
+    };
+
+    os << std::dec << std::setfill(' ');
+
+    // Aggregate samples per region or memory area
+    std::map<string, i64> areas;
+    for (auto &it : histogram) {
+
+        auto region = lookup(it.first);
+        areas[region ? region->name : areaName(it.first)] += it.second;
+    }
+
+    std::vector<std::pair<string, i64>> sortedAreas(areas.begin(), areas.end());
+    std::sort(sortedAreas.begin(), sortedAreas.end(),
+              [](auto &a, auto &b) { return a.second > b.second; });
+
+    os << std::left << std::setw(28) << "Region";
+    os << std::right << std::setw(12) << "Samples";
+    os << std::right << std::setw(10) << "Share" << std::endl;
+
+    for (auto &it : sortedAreas) {
+
+        os << std::left << std::setw(28) << it.first;
+        os << std::right << std::setw(12) << it.second;
+        os << std::fixed << std::setprecision(2);
+        os << std::right << std::setw(9) << percent(it.second) << "%" << std::endl;
+    }
+    os << std::endl;
+
+    // Sort instruction addresses by the number of samples
+    std::vector<std::pair<u32, i64>> sorted(histogram.begin(), histogram.end());
+    std::sort(sorted.begin(), sorted.end(), [](auto &a, auto &b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+    if ((isize)sorted.size() > count) sorted.resize(count);
+
+    os << std::left << std::setw(28) << "Location";
+    os << std::right << std::setw(12) << "Samples";
+    os << std::right << std::setw(10) << "Share" << std::endl;
+
+    for (auto &it : sorted) {
+
+        os << std::left << std::setw(28) << symbolize(it.first);
+        os << std::right << std::setw(12) << it.second;
+        os << std::fixed << std::setprecision(2);
+        os << std::right << std::setw(9) << percent(it.second) << "%" << std::endl;
+    }
+}
+
+void
+GuestProfiler::exportFolded(const string &path) const
+{
+    std::ofstream os(path);
+    if (!os.is_open()) throw VAError(ERROR_FILE_CANT_CREATE);
+
+    for (auto &it : stacks) {
+
+        for (usize i = 0; i < it.first.size(); i++) {
+            os << (i ? ";" : "") << symbolize(it.first[i]);
+        }
+        os << " " << it.second << std::endl;
+    }
+    if (!os.good()) throw VAError(ERROR_FILE_CANT_WRITE);
+}
+
+void
+GuestProfiler::setPeriod(isize dmaCycles)
+{
+    if (dmaCycles < 1) throw VAError(ERROR_OPT_INVALID_ARG);
+    period = dmaCycles;
+}
+
+void
+GuestProfiler::setDepth(isize value)
+{
+    if (value < 0 || value > scanLimit) throw VAError(ERROR_OPT_INVALID_ARG);
+    depth = value;
+}
+
+void
+GuestProfiler::addRegion(const string &name, u32 start, u32 end)
+{
+    if (start >= end) throw VAError(ERROR_OPT_INVALID_ARG);
+
+    // Replace an existing region with the same name
+    regions.erase(std::remove_if(regions.begin(), regions.end(),
+                                 [&](auto &r) { return r.name == name; }),
+                  regions.end());
+
+    regions.push_back(Region { name, start, end });
+}
+
+void
+GuestProfiler::addSegList(const string &name, u32 seglist)
+{
+    /* A segment list is a chain of memory blocks, one per hunk. Each block
+     * starts with a BCPL pointer to the next block which is followed by the
+     * hunk data. The longword in front of the block contains the size of the
+     * allocation, including the size field and the link field.
+     */
+    auto read32 = [&](u32 addr) {
+        return HI_W_LO_W(mem.spypeek16<ACCESSOR_CPU>(addr),
+                         mem.spypeek16<ACCESSOR_CPU>(addr + 2));
+    };
+
+    isize hunk = 0;
+    for (u32 bptr = seglist; bptr; hunk++) {
+
+        u32 addr = bptr << 2;
+        if (hunk > 255 || !isReadable(addr - 4)) throw VAError(ERROR_OPT_INVALID_ARG);
+
+        u32 size = read32(addr - 4);
+        if (size < 8) throw VAError(ERROR_OPT_INVALID_ARG);
+
+        addRegion(name + ".hunk" + std::to_string(hunk), addr + 4, addr - 4 + size);
+        bptr = read32(addr);
+    }
+}
+
+string
+GuestProfiler::symbolize(u32 addr) const
+{
+    std::stringstream ss;
+
+    if (auto region = lookup(addr)) {
+        ss << region->name << "+$" << std::hex << (addr - region->start);
+    } else {
+        ss << "$" << std::hex << std::setw(6) << std::setfill('0') << addr;
+    }
+    return ss.str();
+}
+
+const GuestProfiler::Region *
+GuestProfiler::lookup(u32 addr) const
+{
+    for (auto &region : regions) {
+        if (addr >= region.start && addr < region.end) return &region;
+    }
+    return nullptr;
+}
+
+const char *
+GuestProfiler::areaName(u32 addr) const
+{
+    switch (mem.cpuMemSrc[(addr & 0xFFFFFF) >> 16]) {
+
+        case MEM_CHIP: case MEM_CHIP_MIRROR:    return "Chip Ram";
+        case MEM_SLOW: case MEM_SLOW_MIRROR:    return "Slow Ram";
+        case MEM_FAST:                          return "Fast Ram";
+        case MEM_ROM: case MEM_ROM_MIRROR:      return "Kickstart Rom";
+        case MEM_WOM:                           return "Kickstart Wom";
+        case MEM_EXT:                           return "Extension Rom";
+        case MEM_ZOR:                           return "Zorro II board";
+
+        default:
+            return "Unmapped";
+    }
+}
+
+void
+GuestProfiler::start()
+{
+    suspend();
+
+    if (!running) {
+
+        running = true;
+        agnus.scheduleRel<SLOT_PRF>(DMA_CYCLES(period), PRF_SAMPLE);
+    }
+
+    resume();
+}
+
+void
+GuestProfiler::stop()
+{
+    suspend();
+
+    running = false;
+    agnus.cancel<SLOT_PRF>();
+
+    resume();
+}
+
+void
+GuestProfiler::clear()
+{
+    suspend();
+
+    samples = 0;
+    histogram.clear();
+    stacks.clear();
+
+    resume();
+}
+
+void
+GuestProfiler::serviceEvent()
+{
+    // The event may stem from a snapshot taken while sampling was enabled
+    if (!running) { agnus.cancel<SLOT_PRF>(); return; }
+
+    u32 pc = cpu.getPC0() & 0xFFFFFF;
+
+    samples++;
+    histogram[pc]++;
+
+    // Record the call stack
+    std::vector<u32> frames;
+    if (depth) walkStack(frames);
+    std::reverse(frames.begin(), frames.end());
+    frames.push_back(pc);
+    stacks[frames]++;
+
+    // Schedule the next sample
+    agnus.rescheduleRel<SLOT_PRF>(DMA_CYCLES(period));
+}
+
+void
+GuestProfiler::walkStack(std::vector<u32> &frames) const
+{
+    u32 sp = cpu.getA(7) & 0xFFFFFE;
+    if (!isReadable(sp)) return;
+
+    // Scan the stack word by word, because the stack is only word-aligned
+    u16 hi = mem.spypeek16<ACCESSOR_CPU>(sp);
+
+    for (isize i = 0; i < scanLimit && (isize)frames.size() < depth; i++) {
+
+        sp += 2;
+        if (!isReadable(sp)) break;
+
+        u16 lo = mem.spypeek16<ACCESSOR_CPU>(sp);
+        u32 value = HI_W_LO_W(hi, lo) & 0xFFFFFF;
+
+        if (isReturnAddress(value)) {
+
+            frames.push_back(value);
+
+            // Continue behind the return address
+            sp += 2;
+            if (!isReadable(sp)) break;
+            lo = mem.spypeek16<ACCESSOR_CPU>(sp);
+        }
+        hi = lo;
+    }
+}
+
+bool
+GuestProfiler::isReturnAddress(u32 addr) const
+{
+    if (IS_ODD(addr) || addr < 6 || !isReadable(addr - 6)) return false;
+
+    // JSR (An), BSR.B
+    u16 op = mem.spypeek16<ACCESSOR_CPU>(addr - 2);
+    if ((op & 0xFFF8) == 0x4E90) return true;
+    if ((op & 0xFF00) == 0x6100 && (op & 0xFF) != 0 && (op & 0xFF) != 0xFF) return true;
+
+    // JSR (d16,An), JSR (d8,An,Xn), JSR (xxx).W, JSR (d16,PC), JSR (d8,PC,Xn), BSR.W
+    op = mem.spypeek16<ACCESSOR_CPU>(addr - 4);
+    if ((op & 0xFFF8) == 0x4EA8 || (op & 0xFFF8) == 0x4EB0) return true;
+    if (op == 0x4EB8 || op == 0x4EBA || op == 0x4EBB || op == 0x6100) return true;
+
+    // JSR (xxx).L, BSR.L
+    op = mem.spypeek16<ACCESSOR_CPU>(addr - 6);
+    return op == 0x4EB9 || op == 0x61FF;
+}
+
+bool
+GuestProfiler::isReadable(u32 addr) const
+{
+    switch (mem.cpuMemSrc[(addr & 0xFFFFFF) >> 16]) {
+
+        case MEM_CHIP: case MEM_CHIP_MIRROR:
+        case MEM_SLOW: case MEM_SLOW_MIRROR:
+        case MEM_FAST:
+        case MEM_ROM: case MEM_ROM_MIRROR:
+        case MEM_WOM:
+        case MEM_EXT:
+            return true;
+
+        default:
+            return false;
+    }
+}
@@ -0,0 +1,176 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "AmigaComponent.h"
+#include "Constants.h"
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+/* This class implements a sampling profiler for the emulated 68k software.
+ * While running, the profiler schedules an event in the profiler slot
+ * (SLOT_PRF) on a periodic basis. Inside the event handler, the address of
+ * the currently executed instruction is recorded. Optionally, the call stack
+ * is reconstructed by scanning the stack for return addresses. A longword
+ * on the stack is considered a return address if it points right behind a
+ * JSR or BSR instruction.
+ *
+ * Samples are symbolized by address regions. Regions can be registered
+ * manually or by walking the segment list of a loaded executable. Addresses
+ * outside all regions are attributed to the memory area they belong to.
+ *
+ * The profiler doesn't cost anything while it is stopped, because no event
+ * is scheduled in this case.
+ */
+class GuestProfiler : public AmigaComponent {
+
+    struct Region {
+
+        string name;
+        u32 start;
+        u32 end;
+    };
+
+    // Indicates if samples are taken
+    bool running = false;
+
+    // Sampling period in DMA cycles (defaults to four rasterlines)
+    isize period = 4 * HPOS_CNT;
+
+    // Maximum number of return addresses recorded per sample (0 = PC only)
+    isize depth = 0;
+
+    // Number of recorded samples
+    i64 samples = 0;
+
+    // Number of samples per instruction address
+    std::unordered_map<u32, i64> histogram;
+
+    // Number of samples per call stack (outermost caller first)
+    std::map<std::vector<u32>, i64> stacks;
+
+    // Registered address regions
+    std::vector<Region> regions;
+
+    // Number of words scanned when searching the stack
+    static const isize scanLimit = 256;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    GuestProfiler(Amiga& ref) : AmigaComponent(ref) { };
+
+    const char *getDescription() const override { return "GuestProfiler"; }
+
+private:
+
+    void _initialize() override { };
+    void _reset(bool hard) override;
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    // Prints a flat profile listing the most frequently sampled addresses
+    void flatProfile(std::ostream& os, isize count = 20) const;
+
+    // Writes all call stacks in the folded format used by flame graph tools
+    void exportFolded(const string &path) const throws;
+
+private:
+
+    void _dump(dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+private:
+
+    isize _size() override { return 0; }
+    isize _load(const u8 *buffer) override { return 0; }
+    isize _save(u8 *buffer) override { return 0; }
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    isize getPeriod() const { return period; }
+    void setPeriod(isize dmaCycles) throws;
+
+    isize getDepth() const { return depth; }
+    void setDepth(isize value) throws;
+
+
+    //
+    // Managing regions
+    //
+
+public:
+
+    // Registers an address region [start; end)
+    void addRegion(const string &name, u32 start, u32 end) throws;
+
+    /* Registers a region for each hunk of a loaded executable. The segment
+     * list is passed as a BCPL pointer as returned by LoadSeg().
+     */
+    void addSegList(const string &name, u32 seglist) throws;
+
+    // Translates an address into a human-readable location
+    string symbolize(u32 addr) const;
+
+private:
+
+    // Returns the region an address belongs to (nullptr if none)
+    const Region *lookup(u32 addr) const;
+
+    // Returns the name of the memory area an address belongs to
+    const char *areaName(u32 addr) const;
+
+
+    //
+    // Sampling
+    //
+
+public:
+
+    bool isSampling() const { return running; }
+
+    void start();
+    void stop();
+    void clear();
+
+    // Takes a sample and schedules the next one
+    void serviceEvent();
+
+private:
+
+    // Collects the return addresses found on the stack (innermost first)
+    void walkStack(std::vector<u32> &frames) const;
+
+    // Checks whether an address points right behind a subroutine call
+    bool isReturnAddress(u32 addr) const;
+
+    // Checks whether an address is located in readable memory
+    bool isReadable(u32 addr) const;
+};
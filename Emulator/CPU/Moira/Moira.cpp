@@ -138,7 +138,7 @@ Moira::execute()
         }
         
         pollIrq();
-        sync(MIMIC_MUSASHI ? 1 : 2);
+        syncStopped(MIMIC_MUSASHI ? 1 : 2);
         return;
     }
 
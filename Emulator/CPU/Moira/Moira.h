@@ -25,6 +25,7 @@ namespace moira {
 class Moira : public AmigaComponent {
 
     friend class Debugger;
+    friend class Guards;
     friend class Breakpoints;
     friend class Watchpoints;
 
@@ -309,6 +310,13 @@ protected:
     void sync(int cycles); 
     // virtual void sync(int cycles) { clock += cycles; }
 
+    /* Advances the clock while the CPU is stopped. The function is called
+     * repeatedly in stopped state and advances the clock by a multiple of the
+     * specified number of cycles. It may skip multiple steps at once if it
+     * knows that the interrupt lines won't change in the meantime.
+     */
+    void syncStopped(int cycles);
+
 
     //
     // Accessing registers
@@ -9,27 +9,12 @@
 
 #include "Moira.h"
 
+#include <algorithm>
 #include <string.h>
 #include <stdio.h>
 
 namespace moira {
 
-//
-// Guard
-//
-
-bool
-Guard::eval(u32 addr, Size S)
-{
-    if (this->addr >= addr && this->addr < addr + S && this->enabled) {
-        if (++hits > skip) {
-            return true;
-        }
-    }
-    return false;
-}
-
-
 //
 // Guards
 //
@@ -43,11 +28,8 @@ Guards::guardWithNr(long nr)
 Guard *
 Guards::guardAtAddr(u32 addr)
 {
-    for (int i = 0; i < count; i++) {
-        if (guards[i].addr == addr) return &guards[i];
-    }
-
-    return nullptr;
+    auto it = index.find(addr);
+    return it != index.end() ? &guards[it->second] : nullptr;
 }
 
 bool
@@ -79,7 +61,7 @@ Guards::isSetAndConditionalAt(u32 addr)
 {
     Guard *guard = guardAtAddr(addr);
 
-    return guard != nullptr && guard->skip != 0;
+    return guard != nullptr && (guard->skip != 0 || guard->cond.source != COND_NONE);
 }
 
 void
@@ -100,6 +82,9 @@ Guards::addAt(u32 addr, long skip)
     guards[count].enabled = true;
     guards[count].hits = 0;
     guards[count].skip = skip;
+    guards[count].cond = Condition { };
+    index[addr] = count;
+    filter.set(page(addr));
     count++;
     setNeedsCheck(true);
 }
@@ -119,6 +104,7 @@ Guards::removeAt(u32 addr)
 
             for (int j = i; j + 1 < count; j++) guards[j] = guards[j + 1];
             count--;
+            updateIndex();
             break;
         }
     }
@@ -132,6 +118,7 @@ Guards::replace(long nr, u32 addr)
     
     guards[nr].addr = addr;
     guards[nr].hits = 0;
+    updateIndex();
 }
 
 bool
@@ -153,15 +140,115 @@ Guards::setEnableAt(u32 addr, bool value)
     if (guard) guard->enabled = value;
 }
 
+void
+Guards::setCondition(long nr, const Condition &cond)
+{
+    if (nr < count) guards[nr].cond = cond;
+}
+
+void
+Guards::setConditionAt(u32 addr, const Condition &cond)
+{
+    Guard *guard = guardAtAddr(addr);
+    if (guard) guard->cond = cond;
+}
+
+void
+Guards::updateIndex()
+{
+    filter.reset();
+    index.clear();
+
+    for (long i = 0; i < count; i++) {
+        
+        index[guards[i].addr] = i;
+        filter.set(page(guards[i].addr));
+    }
+}
+
 bool
 Guards::eval(u32 addr, Size S)
 {
-    for (int i = 0; i < count; i++)
-        if (guards[i].eval(addr, S)) return true;
+    // Quick exit if no guard is located in the accessed pages
+    if (!filter[page(addr)] && !filter[page(addr + S - 1)]) return false;
+
+    // Collect all guards inside the accessed range
+    long matches[4];
+    int found = 0;
+
+    for (u32 i = 0; i < S; i++) {
+
+        auto it = index.find(addr + i);
+        if (it != index.end()) matches[found++] = it->second;
+    }
+
+    /* Evaluate the guards in the order they are stored. This order decides
+     * which hit counters are incremented if more than one guard triggers.
+     */
+    std::sort(matches, matches + found);
+
+    for (int i = 0; i < found; i++) {
+
+        Guard &guard = guards[matches[i]];
+        if (guard.enabled && eval(guard.cond) && ++guard.hits > guard.skip) {
+            return true;
+        }
+    }
 
     return false;
 }
 
+bool
+Guards::eval(const Condition &cond)
+{
+    u32 operand;
+
+    switch (cond.source) {
+
+        case COND_NONE:
+            return true;
+
+        case COND_DREG:
+            operand = moira.reg.d[cond.arg & 7];
+            break;
+
+        case COND_AREG:
+            operand = moira.reg.a[cond.arg & 7];
+            break;
+
+        case COND_MEM8:
+            operand = moira.read16Dasm(cond.arg & ~1);
+            operand = (cond.arg & 1) ? operand & 0xFF : operand >> 8;
+            break;
+
+        case COND_MEM16:
+            operand = moira.read16Dasm(cond.arg & ~1);
+            break;
+
+        case COND_MEM32:
+            operand = moira.read16Dasm(cond.arg & ~1) << 16;
+            operand |= moira.read16Dasm((cond.arg & ~1) + 2);
+            break;
+
+        default:
+            return true;
+    }
+
+    switch (cond.op) {
+
+        case COND_EQ:  return operand == cond.value;
+        case COND_NE:  return operand != cond.value;
+        case COND_LT:  return operand <  cond.value;
+        case COND_LE:  return operand <= cond.value;
+        case COND_GT:  return operand >  cond.value;
+        case COND_GE:  return operand >= cond.value;
+        case COND_ANY: return (operand & cond.value) != 0;
+
+        default:
+            return true;
+    }
+}
+
 void
 Breakpoints::setNeedsCheck(bool value)
 {
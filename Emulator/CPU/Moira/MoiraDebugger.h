@@ -9,8 +9,29 @@
 
 #pragma once
 
+#include <bitset>
+#include <unordered_map>
+
 namespace moira {
 
+// Condition attached to a breakpoint or watchpoint
+struct Condition {
+
+    // The compared operand
+    CondSource source = COND_NONE;
+
+    /* Register number (COND_DREG, COND_AREG) or memory address (COND_MEMx).
+     * Words and long words are read from the next lower even address.
+     */
+    u32 arg = 0;
+
+    // The comparison operator
+    CondOp op = COND_EQ;
+
+    // The value the operand is compared with
+    u32 value = 0;
+};
+
 // Base structure for a single breakpoint or watchpoint
 struct Guard {
 
@@ -26,11 +47,8 @@ struct Guard {
     // Number of skipped hits before a match is signalled
     long skip;
 
-public:
-
-    // Returns true if the guard hits
-    bool eval(u32 addr, Size S = Byte);
-
+    // Optional condition which is evaluated when the address matches
+    Condition cond;
 };
 
 // Base class for a collection of guards
@@ -56,6 +74,15 @@ protected:
     // Number of currently stored guards
     long count = 0;
 
+    /* Lookup structures. The page filter contains a bit for each 256 byte
+     * page of the 24-bit address space. It is set iff a guard is located
+     * inside this page. The address index maps each observed address to the
+     * position of its guard in the guards array. Both structures are rebuilt
+     * whenever the guard list changes.
+     */
+    std::bitset<0x10000> filter;
+    std::unordered_map<u32, long> index;
+
     // Indicates if guard checking is necessary
     virtual void setNeedsCheck(bool value) = 0;
 
@@ -91,7 +118,7 @@ public:
     void removeAt(u32 addr);
 
     void remove(long nr);
-    void removeAll() { count = 0; setNeedsCheck(false); }
+    void removeAll() { count = 0; updateIndex(); setNeedsCheck(false); }
 
     void replace(long nr, u32 addr);
 
@@ -110,13 +137,26 @@ public:
     void enableAt(u32 addr) { setEnableAt(addr, true); }
     void disableAt(u32 addr) { setEnableAt(addr, false); }
 
+    //
+    // Attaching conditions
+    //
+
+    void setCondition(long nr, const Condition &cond);
+    void setConditionAt(u32 addr, const Condition &cond);
+    void removeCondition(long nr) { setCondition(nr, Condition { }); }
+    void removeConditionAt(u32 addr) { setConditionAt(addr, Condition { }); }
+
     //
     // Checking a guard
     //
 
 private:
 
+    static u32 page(u32 addr) { return (addr >> 8) & 0xFFFF; }
+    void updateIndex();
+
     bool eval(u32 addr, Size S = Byte);
+    bool eval(const Condition &cond);
 };
 
 class Breakpoints : public Guards {
@@ -240,6 +240,29 @@ typedef struct
 }
 AEStackFrame;
 
+typedef enum
+{
+    COND_NONE,            // Guard triggers unconditionally
+    COND_DREG,            // Compares data register Dn
+    COND_AREG,            // Compares address register An
+    COND_MEM8,            // Compares a byte in memory
+    COND_MEM16,           // Compares a word in memory
+    COND_MEM32            // Compares a long word in memory
+}
+CondSource;
+
+typedef enum
+{
+    COND_EQ,              // Operand == value
+    COND_NE,              // Operand != value
+    COND_LT,              // Operand <  value (unsigned)
+    COND_LE,              // Operand <= value (unsigned)
+    COND_GT,              // Operand >  value (unsigned)
+    COND_GE,              // Operand >= value (unsigned)
+    COND_ANY              // (Operand & value) != 0
+}
+CondOp;
+
 struct StatusRegister {
 
     bool t;               // Trace flag
@@ -13,6 +13,7 @@
 #include "Amiga.h"
 #include "ControlPort.h"
 #include "IO.h"
+#include "Profiler.h"
 #include "SSEUtils.h"
 
 Denise::Denise(Amiga& ref) : AmigaComponent(ref)
@@ -288,17 +289,13 @@ Denise::updateShiftRegisters()
         case 1: shiftReg[0] = bpldatPipe[0];
     }
     
-    // On Intel machines, call the optimized SSE code
-    #if (defined(__i386__) || defined(__x86_64__)) && defined(__MACH__)
-    
+    // Use the fastest SIMD implementation available on the host CPU
     if (!NO_SSE) {
-        util::transposeSSE(shiftReg, slice);
+        util::transpose(shiftReg, slice);
         return;
     }
     
-    #endif
-    
-    // On all other machines, fallback to the slower standard implementation
+    // Fallback to the slower standard implementation
     u32 mask = 0x8000;
     for (isize i = 0; i < 16; i++, mask >>= 1) {
         
@@ -1187,6 +1184,8 @@ Denise::beginOfLine(int vpos)
 void
 Denise::endOfLine(int vpos)
 {
+    PROFILE(PROBE_DENISE);
+    
     // debug("endOfLine pixel = %d HPIXELS = %d\n", pixel, HPIXELS);
 
     // Check if we are below the VBLANK area
@@ -1227,6 +1226,9 @@ Denise::endOfLine(int vpos)
     
     // Encode a HIRES / LORES marker in the first HBLANK pixel
     *denise.pixelEngine.pixelAddr(HBLANK_MIN * 4) = hires() ? 0 : -1;
+    
+    // Check if the line differs from the previous frame
+    pixelEngine.updateDirtyMap(vpos);
 }
 
 void
@@ -90,7 +90,7 @@ public:
      * written to. This is emulated in function fillShiftRegister().
      *
      * Note: The upper two array elements are dummy elements. We need them in
-     * order to pass the array as parameter to function transposeSSE().
+     * order to pass the array as parameter to function transpose().
      */
     u16 __attribute__ ((aligned (64))) shiftReg[8];
 
@@ -16,11 +16,17 @@
 
 #include <fstream>
 
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
 PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 {
     // Allocate frame buffers
-    emuTexture[0].data = new u32[PIXELS];
-    emuTexture[1].data = new u32[PIXELS];
+    for (isize i = 0; i < textureCnt; i++) {
+        emuTexture[i].data = new u32[PIXELS];
+        emuTexture[i].dirty = new bool[VPIXELS];
+    }
     
     // Create random background noise pattern
     const isize noiseSize = 2 * VPIXELS * HPIXELS;
@@ -32,8 +38,10 @@ PixelEngine::PixelEngine(Amiga& ref) : AmigaComponent(ref)
 
 PixelEngine::~PixelEngine()
 {
-    delete[] emuTexture[0].data;
-    delete[] emuTexture[1].data;
+    for (isize i = 0; i < textureCnt; i++) {
+        delete[] emuTexture[i].data;
+        delete[] emuTexture[i].dirty;
+    }
     delete[] noise;
 }
 
@@ -46,8 +54,11 @@ PixelEngine::_initialize()
     config.saturation = 50;
     
     // Start with a long frame
-    emuTexture[0].longFrame = true;
-    emuTexture[1].longFrame = true;
+    for (isize i = 0; i < textureCnt; i++) {
+        emuTexture[i].longFrame = true;
+        emuTexture[i].nr = 0;
+        std::fill_n(emuTexture[i].dirty, VPIXELS, true);
+    }
     
     // Setup ECS BRDRBLNK color
     indexedRgba[64] = GpuColor(0x00, 0x00, 0x00).rawValue;
@@ -68,7 +79,6 @@ PixelEngine::_reset(bool hard)
 {
     RESET_SNAPSHOT_ITEMS(hard)
     
-    frameBuffer = & emuTexture[0];
     updateRGBA();
 }
 
@@ -88,10 +98,12 @@ PixelEngine::_powerOn()
 
             isize pos = line * HPIXELS + i;
             u32 col = (line / 4) % 2 == (i / 8) % 2 ? 0xFF222222 : 0xFF444444;
-            emuTexture[0].data[pos] = col;
-            emuTexture[1].data[pos] = col;
+            for (isize j = 0; j < textureCnt; j++) emuTexture[j].data[pos] = col;
         }
     }
+    for (isize j = 0; j < textureCnt; j++) {
+        std::fill_n(emuTexture[j].dirty, VPIXELS, true);
+    }
 }
 
 i64
@@ -285,14 +297,39 @@ PixelEngine::adjustRGB(u8 &r, u8 &g, u8 &b)
 ScreenBuffer
 PixelEngine::getStableBuffer()
 {
-    ScreenBuffer result;
-    
-    synchronized {
-        result = (frameBuffer == &emuTexture[0]) ? emuTexture[1] : emuTexture[0];
+    return emuTexture[stableBuffer];
+}
+
+ScreenBuffer
+PixelEngine::lockStableBuffer()
+{
+    while (1) {
+        
+        isize nr = stableBuffer;
+        readers[nr]++;
+
+        /* The emulator might have handed over a new frame in the meantime and
+         * picked the buffer as the new working buffer. In that case, the lock
+         * is released and the procedure is repeated.
+         */
+        if (stableBuffer == nr) return emuTexture[nr];
+        readers[nr]--;
     }
-    
-    assert(result.data);
-    return result;
+}
+
+void
+PixelEngine::unlockStableBuffer(const ScreenBuffer &buffer)
+{
+    for (isize i = 0; i < textureCnt; i++) {
+        
+        if (emuTexture[i].data == buffer.data) {
+            
+            assert(readers[i] > 0);
+            readers[i]--;
+            return;
+        }
+    }
+    assert(false);
 }
 
 u32 *
@@ -316,12 +353,32 @@ PixelEngine::pixelAddr(isize pixel) const
 void
 PixelEngine::beginOfFrame()
 {
-    // Switch the working buffer
-    synchronized {
-        frameBuffer = (frameBuffer == &emuTexture[0]) ? &emuTexture[1] : &emuTexture[0];
-        frameBuffer->longFrame = agnus.frame.lof;
+    isize done = frameBuffer - emuTexture;
+    isize stable = stableBuffer;
+    
+    // Look for a buffer that is neither the stable buffer nor being read
+    for (isize i = 1; i < textureCnt; i++) {
+        
+        isize next = (done + i) % textureCnt;
+        if (next == stable || readers[next]) continue;
+
+        // Hand over the completed frame
+        frameBuffer->nr = ++frameCnt;
+        stableBuffer = done;
+
+        // Switch the working buffer
+        frameBuffer = &emuTexture[next];
+        break;
     }
     
+    /* If all buffers are locked, the completed frame is dropped and the
+     * working buffer is reused.
+     */
+    frameBuffer->longFrame = agnus.frame.lof;
+    
+    // Lines that won't be drawn are considered dirty
+    std::fill_n(frameBuffer->dirty, VPIXELS, true);
+    
     dmaDebugger.vSyncHandler();
 }
 
@@ -334,6 +391,15 @@ PixelEngine::endOfVBlankLine()
     }
 }
 
+void
+PixelEngine::updateDirtyMap(isize line)
+{
+    const u32 *current = frameBuffer->data + line * HPIXELS;
+    const u32 *previous = emuTexture[stableBuffer].data + line * HPIXELS;
+    
+    frameBuffer->dirty[line] = memcmp(current, previous, sizeof(u32) * HPIXELS) != 0;
+}
+
 void
 PixelEngine::applyRegisterChange(const RegChange &change)
 {
@@ -393,8 +459,29 @@ PixelEngine::colorize(isize line)
     colChanges.clear();
 }
 
+bool
+PixelEngine::hasGather()
+{
+    #if defined(__i386__) || defined(__x86_64__)
+    static const bool result = __builtin_cpu_supports("avx2");
+    return result;
+    #else
+    return false;
+    #endif
+}
+
 void
 PixelEngine::colorize(u32 *dst, Pixel from, Pixel to)
+{
+    if (hasGather()) {
+        colorizeGather(dst, from, to);
+    } else {
+        colorizeScalar(dst, from, to);
+    }
+}
+
+void
+PixelEngine::colorizeScalar(u32 *dst, Pixel from, Pixel to)
 {
     u8 *mbuf = denise.mBuffer;
 
@@ -403,6 +490,39 @@ PixelEngine::colorize(u32 *dst, Pixel from, Pixel to)
     }
 }
 
+#if defined(__i386__) || defined(__x86_64__)
+
+__attribute__((target("avx2"))) void
+PixelEngine::colorizeGather(u32 *dst, Pixel from, Pixel to)
+{
+    u8 *mbuf = denise.mBuffer;
+    Pixel i = from;
+    
+    // Translate eight pixels at once
+    for (; i + 8 <= to; i += 8) {
+        
+        __m128i bytes = _mm_loadl_epi64((const __m128i *)(mbuf + i));
+        __m256i indices = _mm256_cvtepu8_epi32(bytes);
+        __m256i colors = _mm256_i32gather_epi32((const int *)indexedRgba, indices, 4);
+        _mm256_storeu_si256((__m256i *)(dst + i), colors);
+    }
+    
+    // Translate the remaining pixels
+    for (; i < to; i++) {
+        dst[i] = indexedRgba[mbuf[i]];
+    }
+}
+
+#else
+
+void
+PixelEngine::colorizeGather(u32 *dst, Pixel from, Pixel to)
+{
+    colorizeScalar(dst, from, to);
+}
+
+#endif
+
 void
 PixelEngine::colorizeHAM(u32 *dst, Pixel from, Pixel to, u16& ham)
 {
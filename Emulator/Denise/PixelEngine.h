@@ -14,6 +14,8 @@
 #include "ChangeRecorder.h"
 #include "Constants.h"
 
+#include <atomic>
+
 class PixelEngine : public AmigaComponent {
 
     friend class DmaDebugger;
@@ -44,17 +46,29 @@ private:
     // Screen buffers
     //
 
-    /* The emulator uses double-buffering for storing the computed textures.
-     * At any time, one of the two buffers is the "working buffer" and the other
-     * one the "stable buffer". All drawing functions write to the working
-     * buffer whereas the GPU reads from the stable buffer. Once a frame has
-     * been completed, the working buffer and the stable buffer are switched.
+    /* The emulator stores the computed textures in a ring of frame buffers.
+     * At any time, one of the buffers is the "working buffer" and another one
+     * the "stable buffer". All drawing functions write to the working buffer
+     * whereas consumers read from the stable buffer. Once a frame has been
+     * completed, the working buffer becomes the stable buffer and a new
+     * working buffer is picked among the buffers not being read. The handoff
+     * is lock-free. Neither the emulator thread nor a consumer ever blocks.
      */
-    ScreenBuffer emuTexture[2];
+    static const isize textureCnt = 4;
+    ScreenBuffer emuTexture[textureCnt];
 
     // Pointer to the "working buffer"
     ScreenBuffer *frameBuffer = &emuTexture[0];
 
+    // Index of the "stable buffer"
+    std::atomic<isize> stableBuffer = 1;
+
+    // Number of consumers holding a lock on a certain buffer
+    std::atomic<isize> readers[textureCnt] = { };
+
+    // Number of frames handed over to consumers
+    i64 frameCnt = 0;
+
     // Buffer with background noise (random black and white pixels)
     u32 *noise = nullptr;
 
@@ -203,9 +217,20 @@ private:
 
 public:
 
-    // Returns the stable frame buffer for long frames
+    /* Returns the most recently completed frame. The returned buffer is only
+     * guaranteed to stay intact until the emulator completes the next frame.
+     * Hence, this function is meant to be called from within the emulator
+     * thread or while the emulator is paused.
+     */
     ScreenBuffer getStableBuffer();
 
+    /* Locks and unlocks the most recently completed frame. As long as a
+     * buffer is locked, it won't be reused by the emulator. These functions
+     * are meant to be called by consumers running in a separate thread.
+     */
+    ScreenBuffer lockStableBuffer();
+    void unlockStableBuffer(const ScreenBuffer &buffer);
+
     // Returns a pointer to randon noise
     u32 *getNoise() const;
     
@@ -215,6 +240,12 @@ public:
     // Called after each line in the VBLANK area
     void endOfVBlankLine();
 
+    /* Called after a line has been drawn completely. The function compares
+     * the line with the same line in the stable buffer and records the
+     * result in the dirty-line map.
+     */
+    void updateDirtyMap(isize line);
+
     // Called after each frame to switch the frame buffers
     void beginOfFrame();
 
@@ -241,9 +272,20 @@ public:
      */
     void colorize(isize line);
     
+    /* Colorizes a range of pixels. The first function uses the fastest
+     * implementation available on the host CPU. The others are exposed for
+     * benchmarking and verification purposes. colorizeScalar() serves as the
+     * reference implementation.
+     */
+    void colorize(u32 *dst, Pixel from, Pixel to);
+    void colorizeScalar(u32 *dst, Pixel from, Pixel to);
+    void colorizeGather(u32 *dst, Pixel from, Pixel to);
+
+    // Checks if colorizeGather() is supported by the host CPU
+    static bool hasGather();
+    
 private:
     
-    void colorize(u32 *dst, Pixel from, Pixel to);
     void colorizeHAM(u32 *dst, Pixel from, Pixel to, u16& ham);
     
     /* Hides some graphics layers. This function is an optional stage applied
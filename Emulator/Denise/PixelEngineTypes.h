@@ -63,6 +63,14 @@ typedef struct
 {
     u32 *data;
     bool longFrame;
+    
+    // Frame number (increases with every completed frame)
+    i64 nr;
+    
+    /* Dirty-line map (one entry per line). A line is marked dirty if it
+     * differs from the same line in the previously completed frame.
+     */
+    bool *dirty;
 }
 ScreenBuffer;
 
@@ -14,12 +14,24 @@
 #include "MsgQueue.h"
 #include "Paula.h"
 
+#include <algorithm>
+
 Recorder::Recorder(Amiga& ref) : AmigaComponent(ref)
 {
     subComponents = std::vector<HardwareComponent *> {
         
         &muxer
     };
+    
+    // Fall back to the built-in encoder if FFmpeg is not installed
+    if (!hasFFmpeg()) backend = REC_BACKEND_AVI;
+}
+
+Recorder::~Recorder()
+{
+    // Terminate the encoder thread, even if a recording is in progress
+    closeQueue();
+    waitForEncoder();
 }
 
 bool
@@ -47,11 +59,15 @@ Recorder::_dump(dump::Category category, std::ostream& os) const
 {
     using namespace util;
     
+    os << tab("Backend") << RecorderBackendEnum::key(backend) << std::endl;
     os << tab("FFmpeg path") << ffmpegPath() << std::endl;
     os << tab("Installed") << bol(hasFFmpeg()) << std::endl;
     os << tab("Video pipe") << bol(videoPipe != -1) << std::endl;
     os << tab("Audio pipe") << bol(audioPipe != -1) << std::endl;
     os << tab("Recording") << bol(isRecording()) << std::endl;
+    os << tab("Encoder thread") << bol(encoderRunning) << std::endl;
+    os << tab("Dropped frames") << dec(droppedFrames) << std::endl;
+    os << tab("Repeated frames") << dec(repeatedFrames) << std::endl;
 }
     
 util::Time
@@ -60,34 +76,34 @@ Recorder::getDuration() const
     return (isRecording() ? util::Time::now() : recStop) - recStart;
 }
 
+bool
+Recorder::setBackend(RecorderBackend value)
+{
+    if (!RecorderBackendEnum::isValid(value)) return false;
+    if (isRecording()) return false;
+    if (value == REC_BACKEND_FFMPEG && !hasFFmpeg()) return false;
+    
+    backend = value;
+    return true;
+}
+
 bool
 Recorder::startRecording(int x1, int y1, int x2, int y2,
                                long bitRate,
                                long aspectX,
                                long aspectY)
 {
+    if (isRecording()) return false;
+
+    // Wait for the encoder thread of the previous recording to finish
+    waitForEncoder();
+    
     synchronized {
                 
         debug(REC_DEBUG, "startRecording(%d,%d,%d,%d,%ld,%ld,%ld)\n",
               x1, y1, x2, y2, bitRate, aspectX, aspectY);
 
         if (isRecording()) return false;
-
-        // Create pipes
-        debug(REC_DEBUG, "Creating pipes...\n");
-        
-        unlink(videoPipePath().c_str());
-        unlink(audioPipePath().c_str());
-        if (mkfifo(videoPipePath().c_str(), 0666) == -1) return false;
-        if (mkfifo(audioPipePath().c_str(), 0666) == -1) return false;
-        
-        debug(REC_DEBUG, "Pipes created\n");
-        dump();
-        
-        debug(REC_DEBUG, "startRecording(%d,%d,%d,%d,%ld,%ld,%ld)\n",
-              x1, y1, x2, y2, bitRate, aspectX, aspectY);
-        
-        if (isRecording()) return false;
         
         // Make sure the screen dimensions are even
         if ((x2 - x1) % 2) x2--;
@@ -106,115 +122,149 @@ Recorder::startRecording(int x1, int y1, int x2, int y2,
         sampleRate = 44100;
         samplesPerFrame = sampleRate / frameRate;
         
-        // Create pipes
-        debug(REC_DEBUG, "Creating pipes...\n");
-        
-        unlink(videoPipePath().c_str());
-        unlink(audioPipePath().c_str());
-        if (mkfifo(videoPipePath().c_str(), 0666) == -1) return false;
-        if (mkfifo(audioPipePath().c_str(), 0666) == -1) return false;
-        
-        debug(REC_DEBUG, "Pipes created\n");
-        dump();
-        
-        //
-        // Assemble the command line arguments for the video encoder
-        //
-        
-        // Path to the FFmpeg executable
-        string cmd1 = ffmpegPath() + " -nostdin";
-        
-        // Verbosity
-        cmd1 += " -loglevel " + loglevel();
-        
-        // Input stream format
-        cmd1 += " -f:v rawvideo -pixel_format rgba";
-        
-        // Frame rate
-        cmd1 += " -r " + std::to_string(frameRate);
-        
-        // Frame size (width x height)
-        cmd1 += " -s:v " + std::to_string(x2 - x1) + "x" + std::to_string(y2 - y1);
-        
-        // Input source (named pipe)
-        cmd1 += " -i " + videoPipePath();
-        
-        // Output stream format
-        cmd1 += " -f mp4 -pix_fmt yuv420p";
-        
-        // Bit rate
-        cmd1 += " -b:v " + std::to_string(bitRate) + "k";
-        
-        // Aspect ratio
-        cmd1 += " -bsf:v ";
-        cmd1 += "\"h264_metadata=sample_aspect_ratio=";
-        cmd1 += std::to_string(aspectX) + "/" + std::to_string(2*aspectY) + "\"";
-        
-        // Output file
-        cmd1 += " -y " + videoStreamPath();
-        
-        
-        //
-        // Assemble the command line arguments for the audio encoder
-        //
-        
-        // Path to the FFmpeg executable
-        string cmd2 = ffmpegPath() + " -nostdin";
-        
-        // Verbosity
-        cmd2 += " -loglevel " + loglevel();
-        
-        // Audio format and number of channels
-        cmd2 += " -f:a f32le -ac 2";
-        
-        // Sampling rate
-        cmd2 += " -sample_rate " + std::to_string(sampleRate);
-        
-        // Input source (named pipe)
-        cmd2 += " -i " + audioPipePath();
-        
-        // Output stream format
-        cmd2 += " -f mp4";
-        
-        // Output file
-        cmd2 += " -y " + audioStreamPath();
-        
-        //
-        // Launch FFmpeg instances
-        //
-        
-        assert(videoFFmpeg == nullptr);
-        assert(audioFFmpeg == nullptr);
-        
-        msg("\nStarting video encoder with options:\n%s\n", cmd1.c_str());
-        videoFFmpeg = popen(cmd1.c_str(), "w");
-        msg(videoFFmpeg ? "Success\n" : "Failed to launch\n");
-        
-        msg("\nStarting audio encoder with options:\n%s\n", cmd2.c_str());
-        audioFFmpeg = popen(cmd2.c_str(), "w");
-        msg(audioFFmpeg ? "Success\n" : "Failed to launch\n");
-        
-        // Open pipes
-        msg("Opening video pipe\n");
-        videoPipe = open(videoPipePath().c_str(), O_WRONLY);
-        if (!videoPipe) {
-            msg("Failed to launch the video pipe\n");
-            return false;
-        }
-        msg("Opening audio pipe\n");
-        audioPipe = open(audioPipePath().c_str(), O_WRONLY);
-        if (!audioPipe) {
-            msg("Failed to launch the audio pipe\n");
-            return false;
+        // Launch the encoder
+        switch (backend) {
+                
+            case REC_BACKEND_FFMPEG:
+                
+                if (!startFFmpeg(bitRate, aspectX, aspectY)) return false;
+                break;
+                
+            case REC_BACKEND_AVI:
+                
+                if (!avi.open(aviStreamPath(), x2 - x1, y2 - y1,
+                              frameRate, sampleRate)) return false;
+                break;
+                
+            default:
+                return false;
         }
         
-        msg("Success\n");
+        // Launch the encoder thread
+        queueClosed = false;
+        droppedFrames = 0;
+        repeatedFrames = 0;
+        lastRecordedNr = -1;
+        pthread_create(&encoder, nullptr, encoderMain, (void *)this);
+        encoderRunning = true;
+
         state = State::prepare;
     }
 
     return true;
 }
 
+bool
+Recorder::startFFmpeg(long bitRate, long aspectX, long aspectY)
+{
+    int x1 = cutout.x1, x2 = cutout.x2, y1 = cutout.y1, y2 = cutout.y2;
+    
+    // Create pipes
+    debug(REC_DEBUG, "Creating pipes...\n");
+    
+    unlink(videoPipePath().c_str());
+    unlink(audioPipePath().c_str());
+    if (mkfifo(videoPipePath().c_str(), 0666) == -1) return false;
+    if (mkfifo(audioPipePath().c_str(), 0666) == -1) return false;
+    
+    debug(REC_DEBUG, "Pipes created\n");
+    dump();
+    
+    //
+    // Assemble the command line arguments for the video encoder
+    //
+    
+    // Path to the FFmpeg executable
+    string cmd1 = ffmpegPath() + " -nostdin";
+    
+    // Verbosity
+    cmd1 += " -loglevel " + loglevel();
+    
+    // Input stream format
+    cmd1 += " -f:v rawvideo -pixel_format rgba";
+    
+    // Frame rate
+    cmd1 += " -r " + std::to_string(frameRate);
+    
+    // Frame size (width x height)
+    cmd1 += " -s:v " + std::to_string(x2 - x1) + "x" + std::to_string(y2 - y1);
+    
+    // Input source (named pipe)
+    cmd1 += " -i " + videoPipePath();
+    
+    // Output stream format
+    cmd1 += " -f mp4 -pix_fmt yuv420p";
+    
+    // Bit rate
+    cmd1 += " -b:v " + std::to_string(bitRate) + "k";
+    
+    // Aspect ratio
+    cmd1 += " -bsf:v ";
+    cmd1 += "\"h264_metadata=sample_aspect_ratio=";
+    cmd1 += std::to_string(aspectX) + "/" + std::to_string(2*aspectY) + "\"";
+    
+    // Output file
+    cmd1 += " -y " + videoStreamPath();
+    
+    
+    //
+    // Assemble the command line arguments for the audio encoder
+    //
+    
+    // Path to the FFmpeg executable
+    string cmd2 = ffmpegPath() + " -nostdin";
+    
+    // Verbosity
+    cmd2 += " -loglevel " + loglevel();
+    
+    // Audio format and number of channels
+    cmd2 += " -f:a f32le -ac 2";
+    
+    // Sampling rate
+    cmd2 += " -sample_rate " + std::to_string(sampleRate);
+    
+    // Input source (named pipe)
+    cmd2 += " -i " + audioPipePath();
+    
+    // Output stream format
+    cmd2 += " -f mp4";
+    
+    // Output file
+    cmd2 += " -y " + audioStreamPath();
+    
+    //
+    // Launch FFmpeg instances
+    //
+    
+    assert(videoFFmpeg == nullptr);
+    assert(audioFFmpeg == nullptr);
+    
+    msg("\nStarting video encoder with options:\n%s\n", cmd1.c_str());
+    videoFFmpeg = popen(cmd1.c_str(), "w");
+    msg(videoFFmpeg ? "Success\n" : "Failed to launch\n");
+    
+    msg("\nStarting audio encoder with options:\n%s\n", cmd2.c_str());
+    audioFFmpeg = popen(cmd2.c_str(), "w");
+    msg(audioFFmpeg ? "Success\n" : "Failed to launch\n");
+    
+    // Open pipes
+    msg("Opening video pipe\n");
+    videoPipe = open(videoPipePath().c_str(), O_WRONLY);
+    if (!videoPipe) {
+        msg("Failed to launch the video pipe\n");
+        return false;
+    }
+    msg("Opening audio pipe\n");
+    audioPipe = open(audioPipePath().c_str(), O_WRONLY);
+    if (!audioPipe) {
+        msg("Failed to launch the audio pipe\n");
+        return false;
+    }
+    
+    msg("Success\n");
+    return true;
+}
+
 void
 Recorder::stopRecording()
 {
@@ -233,6 +283,24 @@ Recorder::exportAs(const string &path)
 {
     if (isRecording()) return false;
     
+    // Wait for the encoder thread to write the last frame
+    waitForEncoder();
+    
+    if (backend == REC_BACKEND_AVI) {
+        
+        // The built-in encoder produces the final file right away
+        debug(REC_DEBUG, "Moving %s to %s\n", aviStreamPath().c_str(), path.c_str());
+        
+        if (std::rename(aviStreamPath().c_str(), path.c_str()) != 0) {
+            
+            std::ifstream src(aviStreamPath(), std::ios::binary);
+            std::ofstream dst(path, std::ios::binary);
+            if (!src.is_open() || !dst.is_open()) return false;
+            dst << src.rdbuf();
+        }
+        return true;
+    }
+    
     //
     // Assemble the command line arguments for the video encoder
     //
@@ -299,37 +367,71 @@ Recorder::prepare()
 void
 Recorder::record(Cycle target)
 {
-    assert(videoFFmpeg != nullptr);
-    assert(audioFFmpeg != nullptr);
-    assert(videoPipe != -1);
-    assert(audioPipe != -1);
+    assert(encoderRunning);
+    
+    RecordedFrame frame;
+    
+    // Drop the frame if the encoder can't keep up
+    queueLock.lock();
+    bool full = isize(queue.size()) >= queueCapacity;
+    queueLock.unlock();
+    
+    if (!full) recordVideo(frame);
+    
+    // Always synthesize audio to keep the audio clock in sync
+    recordAudio(frame, target);
     
-    recordVideo(target);
-    recordAudio(target);
+    if (full) {
+        
+        droppedFrames++;
+        return;
+    }
+    
+    // Hand the frame over to the encoder thread
+    queueLock.lock();
+    queue.push_back(std::move(frame));
+    queueLock.unlock();
+    queueCond.signal();
 }
 
 void
-Recorder::recordVideo(Cycle target)
+Recorder::recordVideo(RecordedFrame &frame)
 {
-    ScreenBuffer buffer = denise.pixelEngine.getStableBuffer();
+    ScreenBuffer buffer = pixelEngine.lockStableBuffer();
+    
+    /* If the buffer succeeds the previously recorded one and none of the
+     * recorded lines has changed, the frame is passed without video data.
+     * The encoder repeats the previous frame in this case.
+     */
+    bool unchanged = buffer.nr == lastRecordedNr;
+    if (buffer.nr == lastRecordedNr + 1) {
+        unchanged = std::none_of(buffer.dirty + cutout.y1,
+                                 buffer.dirty + cutout.y2,
+                                 [](bool dirty) { return dirty; });
+    }
+    lastRecordedNr = buffer.nr;
     
-    isize width = sizeof(u32) * (cutout.x2 - cutout.x1);
+    if (unchanged) {
+        
+        pixelEngine.unlockStableBuffer(buffer);
+        repeatedFrames++;
+        return;
+    }
+    
+    isize width = cutout.x2 - cutout.x1;
     isize height = cutout.y2 - cutout.y1;
     isize offset = cutout.y1 * HPIXELS + cutout.x1 + HBLANK_MIN * 4;
-    u8 *data = new u8[width * height];
-    u8 *src = (u8 *)(buffer.data + offset);
-    u8 *dst = data;
-    for (isize y = 0; y < height; y++, src += 4 * HPIXELS, dst += width) {
-        memcpy(dst, src, width);
+    frame.video.resize(width * height);
+    u32 *src = buffer.data + offset;
+    u32 *dst = frame.video.data();
+    for (isize y = 0; y < height; y++, src += HPIXELS, dst += width) {
+        memcpy(dst, src, sizeof(u32) * width);
     }
-    
-    // Feed the video pipe
-    assert(videoPipe != -1);
-    (void)write(videoPipe, data, width * height);
+    pixelEngine.unlockStableBuffer(buffer);
 }
 
 void
-Recorder::recordAudio(Cycle target)
+Recorder::recordAudio(RecordedFrame &frame, Cycle target)
 {
     
     // Clone Paula's muxer contents
@@ -348,31 +450,125 @@ Recorder::recordAudio(Cycle target)
     audioClock = target;
     
     // Copy samples to buffer
-    float *samples = new float[2 * samplesPerFrame];
-    muxer.copy(samples, samplesPerFrame);
-    
-    // Feed the audio pipe
-    assert(audioPipe != -1);
-    (void)write(audioPipe, (u8 *)samples, 2 * sizeof(float) * samplesPerFrame);
+    frame.audio.resize(2 * samplesPerFrame);
+    muxer.copy(frame.audio.data(), samplesPerFrame);
 }
 
 void
 Recorder::finalize()
-{    
-    // Close pipes
-    close(videoPipe);
-    close(audioPipe);
-    videoPipe = -1;
-    audioPipe = -1;
-    
-    // Shut down encoders
-    pclose(videoFFmpeg);
-    pclose(audioFFmpeg);
-    videoFFmpeg = nullptr;
-    audioFFmpeg = nullptr;
+{
+    // Tell the encoder thread to shut down when the queue has been processed
+    closeQueue();
     
     // Switch state and inform the GUI
     state = State::wait;
     recStop = util::Time::now();
     messageQueue.put(MSG_RECORDING_STOPPED);
 }
+
+void *
+Recorder::encoderMain(void *recorder)
+{
+    ((Recorder *)recorder)->encode();
+    return nullptr;
+}
+
+void
+Recorder::encode()
+{
+    std::vector<u32> prevVideo;
+    bool full = false;
+    
+    while (1) {
+        
+        // Wait for the next frame
+        queueLock.lock();
+        while (queue.empty() && !queueClosed) queueCond.wait(queueLock);
+        if (queue.empty()) { queueLock.unlock(); break; }
+        
+        RecordedFrame frame = std::move(queue.front());
+        queue.pop_front();
+        queueLock.unlock();
+        
+        isize width = cutout.x2 - cutout.x1;
+        auto &video = frame.video;
+        auto &audio = frame.audio;
+        
+        switch (backend) {
+                
+            case REC_BACKEND_FFMPEG:
+                
+                // Raw video streams can't skip frames. Repeat the previous one
+                if (video.empty()) video = prevVideo;
+                
+                if (!video.empty()) {
+                    (void)write(videoPipe, video.data(), sizeof(u32) * video.size());
+                }
+                (void)write(audioPipe, audio.data(), sizeof(float) * audio.size());
+                break;
+                
+            case REC_BACKEND_AVI:
+                
+                if (!full) {
+                    
+                    full |= !avi.writeVideo(video.empty() ? nullptr : video.data(), width);
+                    full |= !avi.writeAudio(audio.data(), (isize)audio.size() / 2);
+                    if (full) warn("Maximum AVI file size reached\n");
+                }
+                break;
+                
+            default:
+                break;
+        }
+        
+        if (!video.empty()) prevVideo = std::move(video);
+    }
+    
+    // Shut down the encoders
+    switch (backend) {
+            
+        case REC_BACKEND_FFMPEG:
+            
+            // Close pipes
+            close(videoPipe);
+            close(audioPipe);
+            videoPipe = -1;
+            audioPipe = -1;
+            
+            // Shut down encoders
+            pclose(videoFFmpeg);
+            pclose(audioFFmpeg);
+            videoFFmpeg = nullptr;
+            audioFFmpeg = nullptr;
+            break;
+            
+        case REC_BACKEND_AVI:
+            
+            avi.close();
+            break;
+            
+        default:
+            break;
+    }
+    
+    debug(REC_DEBUG, "Encoder thread terminated (%ld frames dropped)\n", droppedFrames);
+}
+
+void
+Recorder::closeQueue()
+{
+    queueLock.lock();
+    queueClosed = true;
+    queueLock.unlock();
+    queueCond.signal();
+}
+
+void
+Recorder::waitForEncoder()
+{
+    if (encoderRunning) {
+        
+        pthread_join(encoder, nullptr);
+        encoderRunning = false;
+    }
+}
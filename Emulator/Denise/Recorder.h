@@ -9,10 +9,15 @@
 
 #pragma once
 
+#include "RecorderTypes.h"
 #include "AmigaComponent.h"
+#include "AviWriter.h"
 #include "Chrono.h"
+#include "Concurrency.h"
 #include "Muxer.h"
 
+#include <deque>
+
 class Recorder : public AmigaComponent {
 
     //
@@ -30,6 +35,12 @@ class Recorder : public AmigaComponent {
     static string videoStreamPath() { return "/tmp/video.mp4"; }
     static string audioStreamPath() { return "/tmp/audio.mp4"; }
 
+    // Path to the temporary output file of the built-in encoder
+    static string aviStreamPath() { return "/tmp/video.avi"; }
+
+    // Maximum number of frames waiting to be encoded
+    static const isize queueCapacity = 64;
+
     // Log level passed to FFmpef
     static const string loglevel() { return REC_DEBUG ? "verbose" : "warning"; }
     
@@ -54,6 +65,44 @@ class Recorder : public AmigaComponent {
     int videoPipe = -1;
     int audioPipe = -1;
 
+    // Output file of the built-in encoder
+    util::AviWriter avi;
+
+    
+    //
+    // Encoder thread
+    //
+    
+    /* The emulator thread never talks to the encoders directly. It hands
+     * over each recorded frame to the encoder thread through a bounded queue.
+     * If the queue is full, the frame is dropped as a whole, i.e., its video
+     * data and its audio data. This keeps both streams in sync.
+     */
+    struct RecordedFrame {
+        
+        std::vector<u32> video;     // Empty if the frame has been dropped
+        std::vector<float> audio;   // Interleaved stereo samples
+    };
+    
+    pthread_t encoder;
+    bool encoderRunning = false;
+    
+    std::deque<RecordedFrame> queue;
+    util::Mutex queueLock;
+    util::Condition queueCond;
+    
+    // Indicates that no more frames will be added to the queue
+    bool queueClosed = false;
+    
+    // Number of frames that could not be handed over to the encoder
+    isize droppedFrames = 0;
+    
+    // Number of frames that were unchanged and passed as repeat frames
+    isize repeatedFrames = 0;
+    
+    // Number of the most recently recorded screen buffer
+    i64 lastRecordedNr = -1;
+    
     
     //
     // Recording status
@@ -71,6 +120,9 @@ class Recorder : public AmigaComponent {
     // Recording parameters
     //
     
+    // The selected encoder
+    RecorderBackend backend = REC_BACKEND_FFMPEG;
+    
     // Frame rate, Bit rate, Sample rate
     isize frameRate = 0;
     isize bitRate = 0;
@@ -94,6 +146,7 @@ class Recorder : public AmigaComponent {
 public:
     
     Recorder(Amiga& ref);
+    ~Recorder();
     
     const char *getDescription() const override { return "ScreenRecorder"; }
 
@@ -150,6 +203,20 @@ public:
     isize getFrameRate() const { return frameRate; }
     isize getBitRate() const { return bitRate; }
     isize getSampleRate() const { return sampleRate; }
+    isize getDroppedFrames() const { return droppedFrames; }
+    isize getRepeatedFrames() const { return repeatedFrames; }
+    
+    
+    //
+    // Selecting an encoder
+    //
+    
+public:
+    
+    RecorderBackend getBackend() const { return backend; }
+    
+    // Selects the encoder used for the next recording
+    bool setBackend(RecorderBackend value);
     
 
     //
@@ -187,7 +254,26 @@ private:
     
     void prepare();
     void record(Cycle target);
-    void recordVideo(Cycle target);
-    void recordAudio(Cycle target);
+    void recordVideo(RecordedFrame &frame);
+    void recordAudio(RecordedFrame &frame, Cycle target);
     void finalize();
+    
+    
+    //
+    // Encoding (executed in the encoder thread)
+    //
+    
+private:
+    
+    static void *encoderMain(void *recorder);
+    void encode();
+    
+    // Tells the encoder thread to terminate once the queue is empty
+    void closeQueue();
+
+    // Waits until the encoder thread has processed all queued frames
+    void waitForEncoder();
+    
+    // Launches the FFmpeg instances
+    bool startFFmpeg(long bitRate, long aspectX, long aspectY);
 };
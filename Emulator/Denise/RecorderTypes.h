@@ -0,0 +1,48 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include "Reflection.h"
+
+//
+// Enumerations
+//
+
+enum_long(REC_BACKEND)
+{
+    REC_BACKEND_FFMPEG,     // External FFmpeg encoders fed via named pipes
+    REC_BACKEND_AVI,        // Built-in writer for uncompressed AVI files
+    
+    REC_BACKEND_COUNT
+};
+typedef REC_BACKEND RecorderBackend;
+
+#ifdef __cplusplus
+struct RecorderBackendEnum : util::Reflection<RecorderBackendEnum, RecorderBackend> {
+    
+    static bool isValid(long value)
+    {
+        return (unsigned long)value < REC_BACKEND_COUNT;
+    }
+
+    static const char *prefix() { return "REC_BACKEND"; }
+    static const char *key(RecorderBackend value)
+    {
+        switch (value) {
+                
+            case REC_BACKEND_FFMPEG:  return "FFMPEG";
+            case REC_BACKEND_AVI:     return "AVI";
+            case REC_BACKEND_COUNT:   return "???";
+        }
+        return "???";
+    }
+};
+#endif
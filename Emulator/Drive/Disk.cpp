@@ -11,6 +11,70 @@
 #include "Disk.h"
 #include "DiskFile.h"
 
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+/* Lookup tables for the MFM encoder and decoder. The first table spreads the
+ * bits of a byte to the odd bit positions of a word. The second table collects
+ * the bits in the odd positions of a byte (bits 6, 4, 2, 0) into a nibble.
+ */
+static struct MFMTables {
+    
+    u16 spread[256];
+    u8 collect[256];
+    
+    MFMTables() {
+        
+        for (isize i = 0; i < 256; i++) {
+            
+            spread[i] = 0;
+            collect[i] = 0;
+            
+            for (isize b = 0; b < 8; b++) {
+                if (i & (1 << b)) spread[i] |= (u16)(1 << (2 * b));
+            }
+            for (isize b = 0; b < 4; b++) {
+                if (i & (1 << (2 * b))) collect[i] |= (u8)(1 << b);
+            }
+        }
+    }
+    
+} mfmTables;
+
+/* Returns the random data used to initialize a disk. The data is generated
+ * once, because calling rand() for each byte slows down disk insertion
+ * considerably.
+ */
+static const u8 *noise()
+{
+    static const std::vector<u8> result = []() {
+
+        std::vector<u8> bytes(168 * 32768);
+        srand(0);
+        for (auto &byte : bytes) byte = rand() & 0xFF;
+        return bytes;
+    }();
+
+    return result.data();
+}
+
+// Registry of shared track buffers (see Disk::lookupTrack)
+static struct {
+
+    std::mutex mutex;
+    std::map<std::tuple<u64, DiskDiameter, DiskDensity, Track>,
+    std::weak_ptr<std::vector<u8>>> tracks;
+
+} registry;
+
+// Reads or writes eight bytes at once
+static inline u64 load64(const u8 *p) { u64 v; memcpy(&v, p, 8); return v; }
+static inline void store64(u8 *p, u64 v) { memcpy(p, &v, 8); }
+
 Disk::Disk(DiskDiameter type, DiskDensity density)
 {    
     this->diameter = type;
@@ -41,8 +105,6 @@ Disk::makeWithFile(DiskFile *file)
         return nullptr;
     }
     
-    disk->fnv = file->fnv();
-    
     return disk;
 }
 
@@ -51,6 +113,8 @@ Disk::makeWithReader(util::SerReader &reader, DiskDiameter type, DiskDensity den
 {
     Disk *disk = new Disk(type, density);
     disk->applyToPersistentItems(reader);
+    disk->readTrackData(reader);
+    disk->invalidateSyncMarks();
     
     return disk;
 }
@@ -68,6 +132,59 @@ Disk::dump()
     msg("  writeProtected : %s\n", writeProtected ? "yes" : "no");
     msg("        modified : %s\n", modified ? "yes" : "no");
     msg("             fnv : %llu\n", fnv);
+
+    isize dirtyTracks = 0, sharedTracks = 0;
+    for (Track t = 0; t < numTracks(); t++) {
+        if (dirty[t]) dirtyTracks++;
+        if (data[t].use_count() > 1) sharedTracks++;
+    }
+    msg("    dirty tracks : %zd\n", dirtyTracks);
+    msg("   shared tracks : %zd\n", sharedTracks);
+}
+
+isize
+Disk::trackDataSize() const
+{
+    isize result = 0;
+    for (Track t = 0; t < numTracks(); t++) result += length.track[t];
+
+    return result;
+}
+
+void
+Disk::readTrackData(util::SerReader &reader)
+{
+    for (Track t = 0; t < numTracks(); t++) {
+
+        isize count = length.track[t];
+
+        // Unmodified tracks are shared if an identical buffer exists
+        if (!dirty[t]) {
+
+            auto shared = lookupTrack(fnv, t);
+
+            if (shared && memcmp(shared->data(), reader.ptr, count) == 0) {
+
+                data[t] = shared;
+                reader.ptr += count;
+                continue;
+            }
+
+            reader.copy(allocateTrack(t), count);
+            if (!shared) registerTrack(fnv, t);
+            continue;
+        }
+
+        reader.copy(allocateTrack(t), count);
+    }
+}
+
+void
+Disk::writeTrackData(util::SerWriter &writer) const
+{
+    for (Track t = 0; t < numTracks(); t++) {
+        writer.copy(trackData(t), length.track[t]);
+    }
 }
 
 u8
@@ -76,7 +193,7 @@ Disk::readByte(Track t, u16 offset) const
     assert(t < numTracks());
     assert(offset < length.track[t]);
 
-    return data.track[t][offset];
+    return (*data[t])[offset];
 }
 
 u8
@@ -86,7 +203,7 @@ Disk::readByte(Cylinder c, Side s, u16 offset) const
     assert(s < numSides());
     assert(offset < length.cylinder[c][s]);
 
-    return data.cylinder[c][s][offset];
+    return (*data[2 * c + s])[offset];
 }
 
 void
@@ -95,7 +212,7 @@ Disk::writeByte(u8 value, Track t, u16 offset)
     assert(t < numTracks());
     assert(offset < length.track[t]);
 
-    data.track[t][offset] = value;
+    writableTrackData(t)[offset] = value;
 }
 
 void
@@ -105,29 +222,90 @@ Disk::writeByte(u8 value, Cylinder c, Side s, u16 offset)
     assert(s < numSides());
     assert(offset < length.cylinder[c][s]);
 
-    data.cylinder[c][s][offset] = value;
+    writableTrackData(2 * c + s)[offset] = value;
+}
+
+u8 *
+Disk::writableTrackData(Track t)
+{
+    // Create a private copy of a shared track
+    if (!dirty[t]) {
+
+        data[t] = std::make_shared<std::vector<u8>>(*data[t]);
+        dirty[t] = true;
+    }
+
+    invalidateSyncMarks(t);
+    return data[t]->data();
+}
+
+const std::vector<u16> &
+Disk::getSyncMarks(Track t)
+{
+    assert(t < numTracks());
+
+    if (!syncMarksValid[t]) indexSyncMarks(t);
+    return syncMarks[t];
+}
+
+isize
+Disk::nextSyncMark(Track t, isize offset)
+{
+    auto &marks = getSyncMarks(t);
+    if (marks.empty()) return -1;
+
+    // Wrap around if no sync mark follows
+    auto it = std::lower_bound(marks.begin(), marks.end(), offset);
+    return it != marks.end() ? *it : marks.front();
+}
+
+void
+Disk::indexSyncMarks(Track t)
+{
+    const u8 *p = trackData(t);
+    isize len = length.track[t];
+
+    syncMarks[t].clear();
+    for (isize i = 0; i < len; i++) {
+
+        // A sync mark may wrap around at the end of the track
+        if (p[i] == 0x44 && p[(i + 1) % len] == 0x89) syncMarks[t].push_back((u16)i);
+    }
+    syncMarksValid[t] = true;
+}
+
+void
+Disk::invalidateSyncMarks()
+{
+    for (isize t = 0; t < 168; t++) syncMarksValid[t] = false;
 }
 
 void
 Disk::clearDisk()
 {
     fnv = 0;
+    invalidateSyncMarks();
 
-    // Initialize with random data
-    srand(0);
-    for (isize i = 0; i < isizeof(data.raw); i++) {
-        data.raw[i] = rand() & 0xFF;
-    }
-    
-    /* In order to make some copy protected game titles work, we smuggle in
-     * some magic values. E.g., Crunch factory expects 0x44A2 on cylinder 80.
-     */
-    if (diameter == INCH_35 && density == DISK_DD) {
+    for (Track t = 0; t < 168; t++) {
+
+        // Share the track with other unformatted disks if possible
+        if ((data[t] = lookupTrack(0, t))) { dirty[t] = false; continue; }
         
-        for (isize t = 0; t < numTracks(); t++) {
-            data.track[t][0] = 0x44;
-            data.track[t][1] = 0xA2;
+        // Initialize with random data
+        u8 *p = allocateTrack(t);
+        memcpy(p, noise() + t * 32768, length.track[t]);
+        
+        /* In order to make some copy protected game titles work, we smuggle
+         * in some magic values. E.g., Crunch factory expects 0x44A2 on
+         * cylinder 80.
+         */
+        if (diameter == INCH_35 && density == DISK_DD) {
+            
+            p[0] = 0x44;
+            p[1] = 0xA2;
         }
+        
+        registerTrack(0, t);
     }
 }
 
@@ -136,10 +314,7 @@ Disk::clearTrack(Track t)
 {
     assert(t < numTracks());
 
-    srand(0);
-    for (isize i = 0; i < length.track[t]; i++) {
-        data.track[t][i] = rand() & 0xFF;
-    }
+    memcpy(allocateTrack(t), noise(), length.track[t]);
 }
 
 void
@@ -147,9 +322,7 @@ Disk::clearTrack(Track t, u8 value)
 {
     assert(t < numTracks());
 
-    for (isize i = 0; i < isizeof(data.track[t]); i++) {
-        data.track[t][i] = value;
-    }
+    memset(allocateTrack(t), value, length.track[t]);
 }
 
 void
@@ -157,9 +330,67 @@ Disk::clearTrack(Track t, u8 value1, u8 value2)
 {
     assert(t < numTracks());
 
+    u8 *p = allocateTrack(t);
     for (isize i = 0; i < length.track[t]; i++) {
-        data.track[t][i] = (i % 2) ? value2 : value1;
+        p[i] = (i % 2) ? value2 : value1;
+    }
+}
+
+u8 *
+Disk::allocateTrack(Track t)
+{
+    data[t] = std::make_shared<std::vector<u8>>(length.track[t]);
+    dirty[t] = true;
+    invalidateSyncMarks(t);
+
+    return data[t]->data();
+}
+
+std::shared_ptr<std::vector<u8>>
+Disk::lookupTrack(u64 checksum, Track t) const
+{
+    std::lock_guard<std::mutex> guard(registry.mutex);
+
+    auto it = registry.tracks.find({ checksum, diameter, density, t });
+    return it != registry.tracks.end() ? it->second.lock() : nullptr;
+}
+
+void
+Disk::registerTrack(u64 checksum, Track t)
+{
+    std::lock_guard<std::mutex> guard(registry.mutex);
+
+    // Remove all entries referring to deleted buffers
+    for (auto it = registry.tracks.begin(); it != registry.tracks.end();) {
+        it = it->second.expired() ? registry.tracks.erase(it) : std::next(it);
+    }
+
+    registry.tracks[{ checksum, diameter, density, t }] = data[t];
+    dirty[t] = false;
+}
+
+bool
+Disk::shareTracks(u64 checksum)
+{
+    std::shared_ptr<std::vector<u8>> shared[168];
+
+    for (Track t = 0; t < numTracks(); t++) {
+        if (!(shared[t] = lookupTrack(checksum, t))) return false;
+    }
+    for (Track t = 0; t < numTracks(); t++) {
+
+        data[t] = shared[t];
+        dirty[t] = false;
     }
+
+    invalidateSyncMarks();
+    return true;
+}
+
+void
+Disk::registerTracks(u64 checksum)
+{
+    for (Track t = 0; t < numTracks(); t++) registerTrack(checksum, t);
 }
 
 bool
@@ -171,8 +402,18 @@ Disk::encodeDisk(DiskFile *df)
     // Start with an unformatted disk
     clearDisk();
 
+    // Reuse the tracks of other disks created from the same image
+    u64 checksum = df->fnv();
+    if (shareTracks(checksum)) { fnv = checksum; return true; }
+
     // Call the MFM encoder
-    return df->encodeDisk(this);
+    bool result = df->encodeDisk(this);
+    invalidateSyncMarks();
+
+    // Make the tracks available to other disks
+    if (result) { registerTracks(checksum); fnv = checksum; }
+
+    return result;
 }
 
 void
@@ -180,15 +421,7 @@ Disk::encodeMFM(u8 *dst, u8 *src, isize count)
 {
     for(isize i = 0; i < count; i++) {
         
-        u16 mfm =
-        ((src[i] & 0b10000000) << 7) |
-        ((src[i] & 0b01000000) << 6) |
-        ((src[i] & 0b00100000) << 5) |
-        ((src[i] & 0b00010000) << 4) |
-        ((src[i] & 0b00001000) << 3) |
-        ((src[i] & 0b00000100) << 2) |
-        ((src[i] & 0b00000010) << 1) |
-        ((src[i] & 0b00000001) << 0);
+        u16 mfm = mfmTables.spread[src[i]];
         
         dst[2*i+0] = HI_BYTE(mfm);
         dst[2*i+1] = LO_BYTE(mfm);
@@ -200,47 +433,85 @@ Disk::decodeMFM(u8 *dst, u8 *src, isize count)
 {
     for(isize i = 0; i < count; i++) {
         
-        u16 mfm = HI_LO(src[2*i], src[2*i+1]);
-        dst[i] =
-        ((mfm & 0b0100000000000000) >> 7) |
-        ((mfm & 0b0001000000000000) >> 6) |
-        ((mfm & 0b0000010000000000) >> 5) |
-        ((mfm & 0b0000000100000000) >> 4) |
-        ((mfm & 0b0000000001000000) >> 3) |
-        ((mfm & 0b0000000000010000) >> 2) |
-        ((mfm & 0b0000000000000100) >> 1) |
-        ((mfm & 0b0000000000000001) >> 0);
+        dst[i] = (u8)(mfmTables.collect[src[2*i]] << 4 | mfmTables.collect[src[2*i+1]]);
     }
 }
 
 void
 Disk::encodeOddEven(u8 *dst, u8 *src, isize count)
 {
-    // Encode odd bits
-    for(isize i = 0; i < count; i++)
-        dst[i] = (src[i] >> 1) & 0x55;
+    const u64 mask = 0x5555555555555555;
+    isize i = 0;
     
-    // Encode even bits
-    for(isize i = 0; i < count; i++)
+    // Process eight bytes at a time (bits never cross a byte boundary)
+    for (; i + 8 <= count; i += 8) {
+        
+        u64 bits = load64(src + i);
+        store64(dst + i, (bits >> 1) & mask);
+        store64(dst + i + count, bits & mask);
+    }
+    
+    // Process the remaining bytes
+    for (; i < count; i++) {
+        
+        dst[i] = (src[i] >> 1) & 0x55;
         dst[i + count] = src[i] & 0x55;
+    }
 }
 
 void
 Disk::decodeOddEven(u8 *dst, u8 *src, isize count)
 {
-    // Decode odd bits
-    for(isize i = 0; i < count; i++)
-        dst[i] = (src[i] & 0x55) << 1;
+    const u64 mask = 0x5555555555555555;
+    isize i = 0;
     
-    // Decode even bits
-    for(isize i = 0; i < count; i++)
-        dst[i] |= src[i + count] & 0x55;
+    // Process eight bytes at a time (bits never cross a byte boundary)
+    for (; i + 8 <= count; i += 8) {
+        
+        u64 odd = load64(src + i);
+        u64 even = load64(src + i + count);
+        store64(dst + i, (odd & mask) << 1 | (even & mask));
+    }
+    
+    // Process the remaining bytes
+    for (; i < count; i++) {
+        
+        dst[i] = (u8)((src[i] & 0x55) << 1 | (src[i + count] & 0x55));
+    }
 }
 
 void
 Disk::addClockBits(u8 *dst, isize count)
 {
-    for (isize i = 0; i < count; i++) {
+    isize i = 0;
+
+    #if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+
+    /* Process eight bytes at a time. The clock bit in bit 7 of each byte
+     * depends on bit 0 of the preceding byte which is located eight bits
+     * below in a little endian word. The clock bits don't need to be stripped
+     * off the preceding byte, because bit 0 is always a data bit.
+     */
+    const u64 data = 0x5555555555555555;
+    const u64 clock = 0xAAAAAAAAAAAAAAAA;
+    u64 carry = count > 0 ? dst[-1] & 1 : 0;
+    
+    for (; i + 8 <= count; i += 8) {
+        
+        u64 value = load64(dst + i) & data;
+        u64 lShifted = value << 1;
+        u64 rShifted =
+        ((value >> 1) & 0x7F7F7F7F7F7F7F7F) |
+        ((value << 15 | carry << 7) & 0x8080808080808080);
+        
+        store64(dst + i, value | (~(lShifted | rShifted) & clock));
+        carry = (value >> 56) & 1;
+    }
+    
+    #endif
+
+    // Process the remaining bytes
+    for (; i < count; i++) {
         dst[i] = addClockBits(dst[i], dst[i-1]);
     }
 }
@@ -264,13 +535,12 @@ Disk::addClockBits(u8 value, u8 previous)
 }
 
 void
-Disk::repeatTracks()
+Disk::repeatTrack(Track t, u8 *dst, isize count) const
 {
-    for (Track t = 0; t < 168; t++) {
-        
-        isize end = length.track[t];
-        for (isize i = end, j = 0; i < isizeof(data.track[t]); i++, j++) {
-            data.track[t][i] = data.track[t][j];
-        }
+    const u8 *src = trackData(t);
+    isize len = length.track[t];
+
+    for (isize i = 0; i < count; i += len) {
+        memcpy(dst + i, src, std::min(len, count - i));
     }
 }
@@ -12,6 +12,9 @@
 #include "DiskTypes.h"
 #include "HardwareComponent.h"
 
+#include <memory>
+#include <vector>
+
 /* MFM encoded disk data of a standard 3.5" DD disk:
  *
  *    Cylinder  Track     Head      Sectors
@@ -45,6 +48,12 @@
  *    - a track usually occupies 11.968 + 700 = 12.668 MFM bytes.
  *    - a cylinder usually occupies 25.328 MFM bytes.
  *    - a disk usually occupies 84 * 2 * 12.664 =  2.127.552 MFM bytes
+ *
+ * Each track is stored in a separate buffer which is sized to the track
+ * length. Track buffers are shared among all disks created from the same
+ * disk image, and unformatted tracks are shared among all disks. A shared
+ * buffer is never written to. When a track is modified for the first time,
+ * the disk creates a private copy of that track (copy-on-write).
  */
 
 class Disk : public AmigaObject {
@@ -64,11 +73,10 @@ public:
 private:
     
     // The MFM encoded disk data
-    union {
-        u8 raw[168*32768];
-        u8 cylinder[84][2][32768];
-        u8 track[168][32768];
-    } data;
+    std::shared_ptr<std::vector<u8>> data[168];
+
+    // Indicates which tracks have been modified (modified tracks are private)
+    bool dirty[168] = { };
         
     // Length of each track in bytes
     union {
@@ -76,6 +84,11 @@ private:
         i32 track[168];
     } length;
 
+    // Offsets of all sync marks in each track (built on demand)
+    std::vector<u16> syncMarks[168];
+
+    // Indicates which entries in the sync mark index are up to date
+    bool syncMarksValid[168] = { };
     
     // Indicates if this disk is write protected
     bool writeProtected = false;
@@ -117,12 +130,19 @@ private:
 
         << diameter
         << density
-        << data.raw
+        << dirty
         << writeProtected
         << modified
         << fnv;
     }
 
+public:
+
+    // Serializes the MFM data of all tracks
+    isize trackDataSize() const;
+    void readTrackData(util::SerReader &reader);
+    void writeTrackData(util::SerWriter &writer) const;
+
 
     //
     // Accessing disk parameters
@@ -145,11 +165,19 @@ public:
     
     u64 getFnv() const { return fnv; }
     
+    bool isDirty(Track t) const { return dirty[t]; }
+    
 
     //
     // Reading and writing
     //
     
+    // Returns a pointer to the MFM data of a track
+    const u8 *trackData(Track t) const { return data[t]->data(); }
+
+    // Returns a pointer to the MFM data of a track that may be written to
+    u8 *writableTrackData(Track t);
+
     // Reads a byte from disk
     u8 readByte(Track track, u16 offset) const;
     u8 readByte(Cylinder cylinder, Side side, u16 offset) const;
@@ -158,6 +186,31 @@ public:
     void writeByte(u8 value, Track track, u16 offset);
     void writeByte(u8 value, Cylinder cylinder, Side side, u16 offset);
         
+
+    //
+    // Indexing sync marks
+    //
+
+public:
+
+    // Returns the offsets of all sync marks (0x4489) found on a track
+    const std::vector<u16> &getSyncMarks(Track t);
+
+    /* Returns the offset of the first sync mark at or behind the specified
+     * offset. The search wraps around at the end of the track. -1 is returned
+     * if the track doesn't contain any sync mark.
+     */
+    isize nextSyncMark(Track t, isize offset);
+
+private:
+
+    // Scans a track for sync marks
+    void indexSyncMarks(Track t);
+
+    // Discards the sync mark index
+    void invalidateSyncMarks();
+    void invalidateSyncMarks(Track t) { syncMarksValid[t] = false; }
+
     
     //
     // Erasing disks
@@ -173,6 +226,32 @@ public:
     void clearTrack(Track t, u8 value);
     void clearTrack(Track t, u8 value1, u8 value2);
 
+private:
+
+    // Replaces a track by a new private buffer
+    u8 *allocateTrack(Track t);
+    
+
+    //
+    // Sharing tracks
+    //
+
+private:
+
+    /* Track buffers are shared via a process-wide registry. A buffer is
+     * registered under the checksum of the disk image it has been created
+     * from (0 for unformatted tracks), the disk type, and the track number.
+     * The registry doesn't keep the buffers alive.
+     */
+    std::shared_ptr<std::vector<u8>> lookupTrack(u64 checksum, Track t) const;
+    void registerTrack(u64 checksum, Track t);
+
+    // Replaces all tracks by the registered tracks of a disk image
+    bool shareTracks(u64 checksum);
+
+    // Registers all tracks of this disk
+    void registerTracks(u64 checksum);
+
     
     //
     // Encoding
@@ -196,9 +275,14 @@ public:
     static void encodeOddEven(u8 *dst, u8 *src, isize count);
     static void decodeOddEven(u8 *dst, u8 *src, isize count);
 
+    /* Adds clock bits to a data stream. The first byte is computed with
+     * respect to dst[-1] which must therefore point to valid memory.
+     */
     static void addClockBits(u8 *dst, isize count);
     static u8 addClockBits(u8 value, u8 previous);
 
-    // Repeats the MFM data inside the track buffer to ease decoding
-    void repeatTracks(); 
+    /* Copies the MFM data of a track into a buffer. The data is repeated
+     * until the buffer is full which allows to scan beyond the track end.
+     */
+    void repeatTrack(Track t, u8 *dst, isize count) const;
 };
@@ -16,6 +16,9 @@
 #include "FSDevice.h"
 #include "MsgQueue.h"
 
+#include <algorithm>
+#include <cstring>
+
 Drive::Drive(Amiga& ref, isize n) : AmigaComponent(ref), nr(n)
 {
     assert(nr < 4);
@@ -274,7 +277,7 @@ Drive::_size()
         // Add the disk type and disk state
         counter << disk->getDiameter() << disk->getDensity();
         disk->applyToPersistentItems(counter);
-        // counter.count += disk->geometry.diskSize;
+        counter.count += disk->trackDataSize();
     }
 
     return counter.count;
@@ -336,6 +339,7 @@ Drive::_save(u8 *buffer)
 
         // Write the disk's state
         disk->applyToPersistentItems(writer);
+        disk->writeTrackData(writer);
     }
     
     result = (isize)(writer.ptr - buffer);
@@ -497,7 +501,7 @@ Drive::readByte() const
     }
 
     // Case 2: A step operation is in progress
-    if (config.mechanicalDelays && (agnus.clock - stepCycle) < config.stepDelay) {
+    if (stepInProgress()) {
         return (u8)rand(); // 0xFF;
     }
     
@@ -522,6 +526,37 @@ Drive::readWordAndRotate()
     return HI_LO(byte1, byte2);
 }
 
+void
+Drive::readBytesAndRotate(u8 *buffer, isize count)
+{
+    // Take the slow path if the disk doesn't rotate normally
+    if (!disk || !motor || stepInProgress()) {
+
+        for (isize i = 0; i < count; i++) buffer[i] = readByteAndRotate();
+        return;
+    }
+
+    const u8 *track = disk->trackData(2 * head.cylinder + head.side);
+    isize length = disk->length.cylinder[head.cylinder][head.side];
+
+    // Copy the data in chunks reaching up to the end of the track
+    while (count > 0) {
+
+        isize chunk = std::min(count, length - head.offset);
+        memcpy(buffer, track + head.offset, chunk);
+
+        buffer += chunk;
+        count -= chunk;
+        head.offset = (u16)(head.offset + chunk);
+
+        if (head.offset >= length) {
+
+            head.offset = 0;
+            if (isSelected()) ciab.emulateFallingEdgeOnFlagPin();
+        }
+    }
+}
+
 void
 Drive::writeByte(u8 value)
 {
@@ -563,6 +598,12 @@ Drive::rotate()
 void
 Drive::findSyncMark()
 {
+    if (seekSyncMark()) {
+
+        trace(DSK_DEBUG, "Moving to SYNC mark at offset %d\n", head.offset);
+        return;
+    }
+
     long length = disk->length.cylinder[head.cylinder][head.side];
     for (isize i = 0; i < length; i++) {
         
@@ -574,6 +615,43 @@ Drive::findSyncMark()
     trace(DSK_DEBUG, "Moving to SYNC mark at offset %d\n", head.offset);
 }
 
+bool
+Drive::stepInProgress() const
+{
+    return config.mechanicalDelays && (agnus.clock - stepCycle) < config.stepDelay;
+}
+
+bool
+Drive::seekSyncMark()
+{
+    // Only proceed if the disk rotates normally
+    if (!disk || !motor || stepInProgress()) return false;
+
+    Track t = (Track)(2 * head.cylinder + head.side);
+    isize length = disk->length.track[t];
+    isize offset = head.offset;
+
+    isize mark = disk->nextSyncMark(t, offset);
+    if (mark < 0) return false;
+
+    /* findSyncMark() scans the track byte pair by byte pair. If the sync mark
+     * is preceded by 0x44, the scanner might be out of phase and skip it. We
+     * let the scanner decide in this rare case.
+     */
+    if (mark != offset && disk->readByte(t, (u16)((mark + length - 1) % length)) == 0x44) {
+        return false;
+    }
+
+    // Rotate the disk to the position right behind the sync mark
+    isize distance = (mark - offset + length) % length + 2;
+    for (isize i = 0; i < (offset + distance) / length; i++) {
+        if (isSelected()) ciab.emulateFallingEdgeOnFlagPin();
+    }
+    head.offset = (u16)((offset + distance) % length);
+
+    return true;
+}
+
 bool
 Drive::readyToStep() const
 {
@@ -214,6 +214,7 @@ public:
     u8 readByte() const;
     u8 readByteAndRotate();
     u16 readWordAndRotate();
+    void readBytesAndRotate(u8 *buffer, isize count);
 
     // Writes a value to the drive head and optionally rotates the disk
     void writeByte(u8 value);
@@ -226,6 +227,16 @@ public:
     // Rotates the disk to the next sync mark
     void findSyncMark();
 
+private:
+
+    // Checks whether the drive head is moving to another cylinder
+    bool stepInProgress() const;
+
+    // Moves to the next sync mark with the help of the sync mark index
+    bool seekSyncMark();
+
+public:
+
     //
     // Moving the drive head
     //
@@ -0,0 +1,574 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "HdController.h"
+#include "HdControllerRom.h"
+#include "CPU.h"
+#include "HDFFile.h"
+#include "IO.h"
+#include "Memory.h"
+
+// Offsets into struct Library
+static const u32 LN_TYPE = 8;
+static const u32 LN_NAME = 10;
+static const u32 LIB_FLAGS = 14;
+static const u32 LIB_VERSION = 20;
+static const u32 LIB_IDSTRING = 24;
+static const u32 LIB_OPENCNT = 32;
+
+// Offsets into struct IOStdReq
+static const u32 IO_DEVICE = 20;
+static const u32 IO_UNIT = 24;
+static const u32 IO_COMMAND = 28;
+static const u32 IO_ERROR = 31;
+static const u32 IO_ACTUAL = 32;
+static const u32 IO_LENGTH = 36;
+static const u32 IO_DATA = 40;
+static const u32 IO_OFFSET = 44;
+
+// Node types and library flags
+static const u8 NT_MESSAGE = 5;
+static const u8 NT_DEVICE = 3;
+static const u8 NT_REPLYMSG = 7;
+static const u8 LIBF_CHANGED = 0x02;
+static const u8 LIBF_SUMUSED = 0x04;
+static const u8 LIBF_DELEXP = 0x08;
+
+// I/O commands
+static const u16 CMD_RESET = 1;
+static const u16 CMD_READ = 2;
+static const u16 CMD_WRITE = 3;
+static const u16 CMD_UPDATE = 4;
+static const u16 CMD_CLEAR = 5;
+static const u16 CMD_STOP = 6;
+static const u16 CMD_START = 7;
+static const u16 CMD_FLUSH = 8;
+static const u16 TD_MOTOR = 9;
+static const u16 TD_SEEK = 10;
+static const u16 TD_FORMAT = 11;
+static const u16 TD_REMOVE = 12;
+static const u16 TD_CHANGENUM = 13;
+static const u16 TD_CHANGESTATE = 14;
+static const u16 TD_PROTSTATUS = 15;
+static const u16 TD_GETDRIVETYPE = 18;
+static const u16 TD_GETNUMTRACKS = 19;
+static const u16 TD_GETGEOMETRY = 22;
+static const u16 TD_READ64 = 24;
+static const u16 TD_WRITE64 = 25;
+static const u16 TD_FORMAT64 = 27;
+static const u16 NSCMD_DEVICEQUERY = 0x4000;
+static const u16 NSCMD_TD_READ64 = 0xC000;
+static const u16 NSCMD_TD_WRITE64 = 0xC001;
+static const u16 NSCMD_TD_SEEK64 = 0xC002;
+static const u16 NSCMD_TD_FORMAT64 = 0xC003;
+
+// I/O errors
+static const i8 IOERR_OPENFAIL = -1;
+static const i8 IOERR_NOCMD = -3;
+static const i8 IOERR_BADLENGTH = -4;
+static const i8 IOERR_BADADDRESS = -5;
+
+// Product number of the board
+static const u8 HDR_PRODUCT = 0x88;
+
+HdController::HdController(Amiga& ref) : AmigaComponent(ref)
+{
+}
+
+HdController::~HdController()
+{
+    delete hdf;
+}
+
+void
+HdController::_initialize()
+{
+
+}
+
+void
+HdController::_reset(bool hard)
+{
+    RESET_SNAPSHOT_ITEMS(hard)
+}
+
+void
+HdController::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+
+    if (category & dump::State) {
+
+        os << tab("Hard drive");
+        os << (hdf ? hdf->path : "none") << std::endl;
+        if (hdf) {
+            os << tab("Mapping");
+            os << (hdf->isMapped() ? "Memory-mapped" : "In memory") << std::endl;
+            os << tab("Size");
+            os << dec(hdf->size) << " bytes" << std::endl;
+        }
+        os << tab("Configured");
+        os << bol(configured) << std::endl;
+        os << tab("Base address");
+        os << hex(baseAddr) << std::endl;
+        os << tab("DiagArea copy");
+        os << hex(romCopy) << std::endl;
+        os << tab("Reads");
+        os << dec(stats.reads) << " (" << dec(stats.bytesRead) << " bytes)" << std::endl;
+        os << tab("Writes");
+        os << dec(stats.writes) << " (" << dec(stats.bytesWritten) << " bytes)" << std::endl;
+        os << tab("Other requests");
+        os << dec(stats.others) << std::endl;
+        os << tab("Errors");
+        os << dec(stats.errors) << std::endl;
+    }
+}
+
+void
+HdController::attach(const string &path, bool writeThrough)
+{
+    if (isPoweredOn()) throw VAError(ERROR_OPT_LOCKED);
+
+    HDFFile *file = HDFFile::makeWithMappedFile(path, writeThrough);
+
+    detach();
+    hdf = file;
+    clearStats();
+}
+
+void
+HdController::detach()
+{
+    if (isPoweredOn()) throw VAError(ERROR_OPT_LOCKED);
+
+    delete hdf;
+    hdf = nullptr;
+}
+
+u8
+HdController::peekACF(u32 addr) const
+{
+    trace(HDR_DEBUG, "peekACF(%x)\n", addr & 0xFFFF);
+
+    /* This board is a Zorro II board without memory and a size of 64 KB. All
+     * registers except er_Type return their values negated.
+     */
+    switch (addr & 0xFFFF) {
+
+        case 0x00: return 0b1101;                   // er_Type (Zorro II, Rom)
+        case 0x02: return 0b0001;                   // er_Type (64 KB)
+        case 0x04: return ~HDR_PRODUCT >> 4 & 0xF;  // er_Product
+        case 0x06: return ~HDR_PRODUCT & 0xF;
+        case 0x10: return 0xF;                      // er_Manufacturer
+        case 0x12: return 0x8;
+        case 0x14: return 0x4;
+        case 0x16: return 0x6;
+        case 0x18: return 0xA;                      // er_SerialNumber
+        case 0x1A: return 0xF;
+        case 0x1C: return 0xB;
+        case 0x1E: return 0xE;
+        case 0x20: return 0xA;
+        case 0x22: return 0xA;
+        case 0x24: return 0xB;
+        case 0x26: return 0x2;
+        case 0x28: return 0xE;                      // er_InitDiagVec ($1000)
+        case 0x2A: return 0xF;
+        case 0x2C: return 0xF;
+        case 0x2E: return 0xF;
+
+        default:
+            return 0xF;
+    }
+}
+
+void
+HdController::pokeACF(u32 addr, u8 value)
+{
+    trace(HDR_DEBUG, "pokeACF(%x,%x)\n", addr & 0xFFFF, value);
+
+    switch (addr & 0xFFFF) {
+
+        case 0x48: // ec_BaseAddress (A23 - A20)
+
+            baseAddr |= (value & 0xF0) << 16;
+            configured = true;
+            trace(HDR_DEBUG, "Hard drive controller mapped to $%x\n", baseAddr);
+            mem.updateMemSrcTables();
+            return;
+
+        case 0x4A: // ec_BaseAddress (A19 - A16)
+
+            baseAddr = (value & 0xF0) << 12;
+            return;
+
+        case 0x4C: // ec_Shutup
+
+            configured = true;
+            baseAddr = 0;
+            return;
+
+        default:
+            return;
+    }
+}
+
+u8
+HdController::peek8(u32 addr) const
+{
+    u16 word = peek16(addr & ~1);
+    return IS_EVEN(addr) ? HI_BYTE(word) : LO_BYTE(word);
+}
+
+u16
+HdController::peek16(u32 addr) const
+{
+    isize offset = (isize)(addr & 0xFFFF) - 0x1000;
+
+    // The boot Rom is located at offset $1000 (see er_InitDiagVec)
+    if (offset >= 0 && offset < HDR_ROM_SIZE) return hdrom[offset / 2];
+    return 0;
+}
+
+void
+HdController::poke8(u32 addr, u8 value)
+{
+    trace(HDR_DEBUG, "poke8(%x,%x)\n", addr, value);
+}
+
+void
+HdController::poke16(u32 addr, u16 value)
+{
+    trace(HDR_DEBUG, "poke16(%x,%x)\n", addr, value);
+
+    // The command register is located at offset 0
+    if ((addr & 0xFFFF) == 0) execute(value);
+}
+
+void
+HdController::execute(u16 cmd)
+{
+    switch (cmd) {
+
+        case HDC_CMD_DIAG:      processDiag(); break;
+        case HDC_CMD_INIT:      processInit(); break;
+        case HDC_CMD_OPEN:      processOpen(); break;
+        case HDC_CMD_CLOSE:     processClose(); break;
+        case HDC_CMD_BEGINIO:   processBeginIO(); break;
+
+        default:
+            trace(HDR_DEBUG, "Invalid command: %d\n", cmd);
+    }
+}
+
+void
+HdController::processDiag()
+{
+    // A2 points to the DiagArea copy, A3 to the ConfigDev structure
+    romCopy = cpu.getA(2);
+    u32 configDev = cpu.getA(3);
+
+    trace(HDR_DEBUG, "DiagPoint: DiagArea = %x ConfigDev = %x\n", romCopy, configDev);
+
+    // Relocate pointers
+    for (auto offset : { HDR_RT_MATCHTAG, HDR_RT_ENDSKIP, HDR_RT_NAME,
+        HDR_RT_IDSTRING, HDR_RT_INIT, HDR_FUNC_TABLE, HDR_INIT_ROUTINE }) {
+
+        u32 addr = romCopy + offset;
+        write32(addr, read32(addr) + romCopy);
+    }
+
+    // Fill in variables
+    write32(romCopy + HDR_BOARD_BASE, baseAddr);
+    write32(romCopy + HDR_CONFIG_DEV, configDev);
+
+    // Fill in the parameter packet for MakeDosNode
+    u32 numCyls = hdf ? (u32)hdf->numCyls() : 0;
+    u32 heads = hdf ? (u32)hdf->numSides() : 1;
+    u32 sectors = hdf ? (u32)hdf->numSectors() : 32;
+    u32 dosType = 0x444F5300;
+    if (hdf && hdf->size >= 4 && strncmp((char *)hdf->data, "DOS", 3) == 0) {
+        dosType |= hdf->data[3];
+    }
+
+    u32 packet[] = {
+
+        romCopy + HDR_DOS_NAME,     // DOS device name
+        romCopy + HDR_DEV_NAME,     // Exec device name
+        0,                          // Unit
+        0,                          // OpenDevice flags
+        16,                         // de_TableSize
+        128,                        // de_SizeBlock (longs)
+        0,                          // de_SecOrg
+        heads,                      // de_Surfaces
+        1,                          // de_SectorPerBlock
+        sectors,                    // de_BlocksPerTrack
+        2,                          // de_Reserved
+        0,                          // de_PreAlloc
+        0,                          // de_Interleave
+        0,                          // de_LowCyl
+        numCyls - 1,                // de_HighCyl
+        30,                         // de_NumBuffers
+        1,                          // de_BufMemType (MEMF_PUBLIC)
+        0x7FFFFFFF,                 // de_MaxTransfer
+        0xFFFFFFFE,                 // de_Mask
+        0,                          // de_BootPri
+        dosType                     // de_DosType
+    };
+    for (isize i = 0; i < isizeof(packet) / 4; i++) {
+        write32(romCopy + HDR_PARAM_PACKET + 4 * (u32)i, packet[i]);
+    }
+}
+
+void
+HdController::processInit()
+{
+    // D0 points to the device created by MakeLibrary
+    u32 device = cpu.getD(0);
+
+    trace(HDR_DEBUG, "Init: Device = %x\n", device);
+
+    write8(device + LN_TYPE, NT_DEVICE);
+    write32(device + LN_NAME, romCopy + HDR_DEV_NAME);
+    write8(device + LIB_FLAGS, LIBF_SUMUSED | LIBF_CHANGED);
+    write16(device + LIB_VERSION, 1);
+    write32(device + LIB_IDSTRING, romCopy + HDR_ID_STRING);
+}
+
+void
+HdController::processOpen()
+{
+    // A1 points to the I/O request, D0 contains the unit, A6 the device
+    u32 io = cpu.getA(1);
+    u32 unit = cpu.getD(0);
+    u32 device = cpu.getA(6);
+
+    trace(HDR_DEBUG, "Open: Unit = %d\n", unit);
+
+    if (unit != 0 || !hdf) {
+
+        write8(io + IO_ERROR, (u8)IOERR_OPENFAIL);
+        return;
+    }
+
+    u16 openCnt = mem.spypeek16 <ACCESSOR_CPU> (device + LIB_OPENCNT);
+    u8 flags = (u8)(mem.spypeek16 <ACCESSOR_CPU> (device + LIB_FLAGS) >> 8);
+    write16(device + LIB_OPENCNT, openCnt + 1);
+    write8(device + LIB_FLAGS, flags & ~LIBF_DELEXP);
+
+    write8(io + LN_TYPE, NT_REPLYMSG);
+    write32(io + IO_UNIT, romCopy);
+    write8(io + IO_ERROR, 0);
+}
+
+void
+HdController::processClose()
+{
+    // A1 points to the I/O request, A6 to the device
+    u32 io = cpu.getA(1);
+    u32 device = cpu.getA(6);
+
+    trace(HDR_DEBUG, "Close\n");
+
+    u16 openCnt = mem.spypeek16 <ACCESSOR_CPU> (device + LIB_OPENCNT);
+    if (openCnt) write16(device + LIB_OPENCNT, openCnt - 1);
+
+    write32(io + IO_DEVICE, 0xFFFFFFFF);
+    write32(io + IO_UNIT, 0xFFFFFFFF);
+}
+
+void
+HdController::processBeginIO()
+{
+    // A1 points to the I/O request
+    u32 io = cpu.getA(1);
+    u16 cmd = mem.spypeek16 <ACCESSOR_CPU> (io + IO_COMMAND);
+    u32 actual = 0;
+
+    write8(io + LN_TYPE, NT_MESSAGE);
+
+    i8 error = processRequest(io, cmd, actual);
+    if (error) stats.errors++;
+
+    trace(HDR_DEBUG, "BeginIO: cmd = %x error = %d actual = %d\n", cmd, error, actual);
+
+    write8(io + IO_ERROR, (u8)error);
+    write32(io + IO_ACTUAL, actual);
+}
+
+i8
+HdController::processRequest(u32 io, u16 cmd, u32 &actual)
+{
+    u32 data = read32(io + IO_DATA);
+    u32 length = read32(io + IO_LENGTH);
+    u64 offset = read32(io + IO_OFFSET);
+    i8 error;
+
+    if (!hdf) return IOERR_OPENFAIL;
+
+    switch (cmd) {
+
+        case TD_READ64:
+        case NSCMD_TD_READ64:
+
+            offset |= (u64)read32(io + IO_ACTUAL) << 32;
+            [[fallthrough]];
+
+        case CMD_READ:
+
+            stats.reads++;
+            error = transfer(data, length, offset, false);
+            if (!error) stats.bytesRead += length;
+            actual = error ? 0 : length;
+            return error;
+
+        case TD_WRITE64:
+        case TD_FORMAT64:
+        case NSCMD_TD_WRITE64:
+        case NSCMD_TD_FORMAT64:
+
+            offset |= (u64)read32(io + IO_ACTUAL) << 32;
+            [[fallthrough]];
+
+        case CMD_WRITE:
+        case TD_FORMAT:
+
+            stats.writes++;
+            error = transfer(data, length, offset, true);
+            if (!error) stats.bytesWritten += length;
+            actual = error ? 0 : length;
+            return error;
+
+        case CMD_RESET:
+        case CMD_UPDATE:
+        case CMD_CLEAR:
+        case CMD_STOP:
+        case CMD_START:
+        case CMD_FLUSH:
+        case TD_MOTOR:
+        case TD_SEEK:
+        case NSCMD_TD_SEEK64:
+        case TD_REMOVE:
+        case TD_CHANGENUM:
+        case TD_CHANGESTATE:
+        case TD_PROTSTATUS:
+
+            // Disk is present, not write protected, and never changes
+            stats.others++;
+            return 0;
+
+        case TD_GETDRIVETYPE:
+
+            stats.others++;
+            actual = 1; // DRIVE3_5
+            return 0;
+
+        case TD_GETNUMTRACKS:
+
+            stats.others++;
+            actual = (u32)(hdf->numCyls() * hdf->numSides());
+            return 0;
+
+        case TD_GETGEOMETRY:
+        {
+            u32 blocks = (u32)hdf->numBlocks();
+            u32 geometry[] = {
+
+                (u32)hdf->bsize(),                              // dg_SectorSize
+                blocks,                                         // dg_TotalSectors
+                (u32)hdf->numCyls(),                            // dg_Cylinders
+                (u32)(hdf->numSectors() * hdf->numSides()),     // dg_CylSectors
+                (u32)hdf->numSides(),                           // dg_Heads
+                (u32)hdf->numSectors(),                         // dg_TrackSectors
+                1,                                              // dg_BufMemType
+                0                                               // dg_DeviceType, dg_Flags
+            };
+
+            stats.others++;
+            if (length < sizeof(geometry)) return IOERR_BADLENGTH;
+            if (!mem.ramPtr(data, sizeof(geometry), true)) return IOERR_BADADDRESS;
+            for (isize i = 0; i < 8; i++) write32(data + 4 * (u32)i, geometry[i]);
+            actual = sizeof(geometry);
+            return 0;
+        }
+        case NSCMD_DEVICEQUERY:
+        {
+            u32 result[] = {
+
+                0,                                              // DevQueryFormat
+                16,                                             // SizeAvailable
+                5 << 16,                                        // NSDEVTYPE_TRACKDISK
+                romCopy + HDR_CMD_LIST                          // SupportedCommands
+            };
+
+            stats.others++;
+            if (length < sizeof(result)) return IOERR_BADLENGTH;
+            if (!mem.ramPtr(data, sizeof(result), true)) return IOERR_BADADDRESS;
+            for (isize i = 0; i < 4; i++) write32(data + 4 * (u32)i, result[i]);
+            actual = sizeof(result);
+            return 0;
+        }
+        default:
+
+            stats.others++;
+            return IOERR_NOCMD;
+    }
+}
+
+i8
+HdController::transfer(u32 data, u32 length, u64 offset, bool write)
+{
+    isize bsize = hdf->bsize();
+
+    // Only full blocks can be transferred
+    if (length % bsize || offset % bsize) return IOERR_BADLENGTH;
+
+    // Check the range without risking an overflow (offset is 64 bit wide)
+    u64 size = (u64)hdf->size;
+    if (offset > size || length > size - offset) return IOERR_BADADDRESS;
+    if (length == 0) return 0;
+
+    // Get direct access to the Amiga memory
+    u8 *ram = mem.ramPtr(data, length, !write);
+    if (!ram) return IOERR_BADADDRESS;
+
+    // Copy the data from or to the mapped image
+    if (write) {
+        memcpy(hdf->data + offset, ram, length);
+    } else {
+        memcpy(ram, hdf->data + offset, length);
+    }
+    return 0;
+}
+
+u32
+HdController::read32(u32 addr) const
+{
+    u16 hi = mem.spypeek16 <ACCESSOR_CPU> (addr);
+    u16 lo = mem.spypeek16 <ACCESSOR_CPU> (addr + 2);
+    return HI_W_LO_W(hi, lo);
+}
+
+void
+HdController::write8(u32 addr, u8 value)
+{
+    if (u8 *p = mem.ramPtr(addr, 1, true)) *p = value;
+}
+
+void
+HdController::write16(u32 addr, u16 value)
+{
+    if (u8 *p = mem.ramPtr(addr, 2, true)) W16BE(p, value);
+}
+
+void
+HdController::write32(u32 addr, u32 value)
+{
+    if (u8 *p = mem.ramPtr(addr, 4, true)) W32BE(p, value);
+}
@@ -0,0 +1,175 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "HdControllerTypes.h"
+#include "AmigaComponent.h"
+
+class HDFFile;
+
+/* This class emulates a hard drive controller in the Zorro II space. The
+ * controller is an autoconfig board with a boot Rom containing a minimal
+ * device driver (see HdControllerRom.h). The driver forwards each I/O request
+ * by writing a command code into the command register of the board. The
+ * controller processes the request immediately by copying the requested
+ * blocks between Amiga memory and the attached HDF. The HDF is mapped into
+ * memory which means that no block is ever read or buffered in advance.
+ */
+class HdController : public AmigaComponent {
+
+public:
+
+    // Commands written into the command register by the boot Rom
+    enum : u16 {
+
+        HDC_CMD_DIAG = 1,
+        HDC_CMD_INIT,
+        HDC_CMD_OPEN,
+        HDC_CMD_CLOSE,
+        HDC_CMD_BEGINIO
+    };
+
+private:
+
+    // The attached hard drive (nullptr if no drive is attached)
+    HDFFile *hdf = nullptr;
+
+    // Current configuration state (0 = unconfigured)
+    bool configured;
+
+    // Base address of the board (provided by Kickstart)
+    u32 baseAddr;
+
+    // Location of the DiagArea copy in Ram (provided by Kickstart)
+    u32 romCopy;
+
+    // Throughput counters
+    HdControllerStats stats = { };
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    HdController(Amiga& ref);
+    ~HdController();
+
+    const char *getDescription() const override { return "HdController"; }
+
+private:
+
+    void _initialize() override;
+    void _reset(bool hard) override;
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    HdControllerStats getStats() { return stats; }
+    void clearStats() { stats = { }; }
+
+private:
+
+    void _dump(dump::Category category, std::ostream& os) const override;
+
+
+    //
+    // Serializing
+    //
+
+public:
+
+    template <class T>
+    void applyToPersistentItems(T& worker)
+    {
+    }
+
+    template <class T>
+    void applyToHardResetItems(T& worker)
+    {
+    }
+
+    template <class T>
+    void applyToResetItems(T& worker)
+    {
+        worker
+
+        << configured
+        << baseAddr
+        << romCopy;
+    }
+
+    isize _size() override { COMPUTE_SNAPSHOT_SIZE }
+    isize _load(const u8 *buffer) override { LOAD_SNAPSHOT_ITEMS }
+    isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
+
+
+    //
+    // Attaching a hard drive
+    //
+
+public:
+
+    bool isAttached() const { return hdf != nullptr; }
+
+    /* Attaches a hard drive image. By default, the image is mapped in private
+     * mode which means that all modifications are discarded when the drive is
+     * detached. In write-through mode, modifications are written back into
+     * the image file.
+     */
+    void attach(const string &path, bool writeThrough = false) throws;
+    void detach() throws;
+
+
+    //
+    // Emulating the board
+    //
+
+public:
+
+    bool isConfigured() const { return configured; }
+    u32 getBaseAddr() const { return baseAddr; }
+
+    // Accesses the autoconfig space
+    u8 peekACF(u32 addr) const;
+    void pokeACF(u32 addr, u8 value);
+
+    // Accesses the board after it has been configured
+    u8 peek8(u32 addr) const;
+    u16 peek16(u32 addr) const;
+    void poke8(u32 addr, u8 value);
+    void poke16(u32 addr, u16 value);
+
+private:
+
+    // Executes a command issued by the boot Rom
+    void execute(u16 cmd);
+
+    void processDiag();
+    void processInit();
+    void processOpen();
+    void processClose();
+    void processBeginIO();
+
+    // Processes an I/O request and returns the error code
+    i8 processRequest(u32 io, u16 cmd, u32 &actual);
+    i8 transfer(u32 data, u32 length, u64 offset, bool write);
+
+    // Accesses Amiga memory
+    u32 read32(u32 addr) const;
+    void write8(u32 addr, u8 value);
+    void write16(u32 addr, u16 value);
+    void write32(u32 addr, u32 value);
+};
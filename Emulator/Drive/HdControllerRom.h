@@ -0,0 +1,180 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+/* Boot Rom of the hard drive controller. The Rom is a DiagArea containing a
+ * minimal exec device (hdrive.device). During autoconfiguration, Kickstart
+ * copies the DiagArea into Ram and calls DiagPoint which signals the
+ * controller to relocate all pointers in the copy and to fill in the
+ * variables and the parameter packet. Afterwards, Kickstart initializes the
+ * embedded resident which creates the device and adds a boot node for DH0.
+ *
+ * The device functions are stubs. Each of them writes a command code into
+ * the command register of the board which makes the controller execute the
+ * request immediately. BeginIO replies the request afterwards unless it has
+ * been sent with IOF_QUICK set.
+ */
+
+// Pointers to be relocated (the Rom stores offsets relative to the DiagArea)
+static const u32 HDR_RT_MATCHTAG   = 0x0010;
+static const u32 HDR_RT_ENDSKIP    = 0x0014;
+static const u32 HDR_RT_NAME       = 0x001C;
+static const u32 HDR_RT_IDSTRING   = 0x0020;
+static const u32 HDR_RT_INIT       = 0x0024;
+static const u32 HDR_FUNC_TABLE    = 0x002C;
+static const u32 HDR_INIT_ROUTINE  = 0x0034;
+
+// Variables to be filled in by the controller
+static const u32 HDR_BOARD_BASE    = 0x0038;
+static const u32 HDR_CONFIG_DEV    = 0x003C;
+static const u32 HDR_PARAM_PACKET  = 0x0050;
+
+// Other items
+static const u32 HDR_CMD_LIST      = 0x00A4;
+static const u32 HDR_DEV_NAME      = 0x016A;
+static const u32 HDR_ID_STRING     = 0x0178;
+static const u32 HDR_DOS_NAME      = 0x018E;
+static const u32 HDR_ROM_SIZE      = 0x01B0;
+
+static const u16 hdrom[] = {
+
+    // DiagArea
+    /* 0000 */ 0x9000,                                           // da_Config = DAC_WORDWIDE | DAC_CONFIGTIME, da_Flags = 0
+    /* 0002 */ 0x01B0,                                           // da_Size
+    /* 0004 */ 0x00D2,                                           // da_DiagPoint
+    /* 0006 */ 0x00DA,                                           // da_BootPoint
+    /* 0008 */ 0x016A,                                           // da_Name
+    /* 000A */ 0x0000,                                           // da_Reserved01
+    /* 000C */ 0x0000,                                           // da_Reserved02
+
+    // Resident structure
+    /* 000E */ 0x4AFC,                                           // rt_MatchWord
+    /* 0010 */ 0x0000, 0x000E,                                   // rt_MatchTag (relocated)
+    /* 0014 */ 0x0000, 0x01B0,                                   // rt_EndSkip (relocated)
+    /* 0018 */ 0x8101,                                           // rt_Flags = RTF_AUTOINIT | RTF_COLDSTART, rt_Version = 1
+    /* 001A */ 0x0300,                                           // rt_Type = NT_DEVICE, rt_Pri = 0
+    /* 001C */ 0x0000, 0x016A,                                   // rt_Name (relocated)
+    /* 0020 */ 0x0000, 0x0178,                                   // rt_IdString (relocated)
+    /* 0024 */ 0x0000, 0x0028,                                   // rt_Init (relocated)
+
+    // Init table (RTF_AUTOINIT)
+    /* 0028 */ 0x0000, 0x0022,                                   // Size of the device base (struct Library)
+    /* 002C */ 0x0000, 0x0040,                                   // Function table (relocated)
+    /* 0030 */ 0x0000, 0x0000,                                   // Data table (unused)
+    /* 0034 */ 0x0000, 0x00F2,                                   // Init routine (relocated)
+
+    // Variables (patched by the controller)
+    /* 0038 */ 0x0000, 0x0000,                                   // Board base address (patched)
+    /* 003C */ 0x0000, 0x0000,                                   // ConfigDev (patched)
+
+    // Function table
+    /* 0040 */ 0xFFFF,                                           // Relative function table
+    /* 0042 */ 0x00F6,                                           // Open
+    /* 0044 */ 0x0100,                                           // Close
+    /* 0046 */ 0x0108,                                           // Expunge
+    /* 0048 */ 0x0108,                                           // Reserved
+    /* 004A */ 0x010C,                                           // BeginIO
+    /* 004C */ 0x0108,                                           // AbortIO
+    /* 004E */ 0xFFFF,                                           // End of table
+
+    // Parameter packet for MakeDosNode (filled in by the controller)
+    /* 0050 */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    /* 005C */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    /* 0068 */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    /* 0074 */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    /* 0080 */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    /* 008C */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+    /* 0098 */ 0x0000, 0x0000, 0x0000, 0x0000, 0x0000, 0x0000,
+
+    // Supported commands (NSCMD_DEVICEQUERY)
+    /* 00A4 */ 0x0002, 0x0003, 0x0004, 0x0005, 0x0009, 0x000A, 0x000B,
+    /* 00B2 */ 0x000C, 0x000D, 0x000E, 0x000F, 0x0012, 0x0013, 0x0016,
+    /* 00C0 */ 0x0018, 0x0019, 0x001B, 0x4000, 0xC000, 0xC001, 0xC002,
+    /* 00CE */ 0xC003, 0x0000,
+
+    // DiagPoint (A0 = board, A2 = DiagArea copy, A3 = ConfigDev, A6 = ExecBase)
+    /* 00D2 */ 0x30BC, 0x0001,                                   // move.w  #HDC_CMD_DIAG,(a0)
+    /* 00D6 */ 0x7001,                                           // moveq   #1,d0
+    /* 00D8 */ 0x4E75,                                           // rts
+
+    // BootPoint (only used by Kickstart 1.3)
+    /* 00DA */ 0x43FA, 0x00C8,                                   // lea     dosLib(pc),a1
+    /* 00DE */ 0x4EAE, 0xFFA0,                                   // jsr     _LVOFindResident(a6)
+    /* 00E2 */ 0x4A80,                                           // tst.l   d0
+    /* 00E4 */ 0x6708,                                           // beq.s   .fail
+    /* 00E6 */ 0x2040,                                           // move.l  d0,a0
+    /* 00E8 */ 0x2068, 0x0016,                                   // move.l  RT_INIT(a0),a0
+    /* 00EC */ 0x4ED0,                                           // jmp     (a0)
+    /* 00EE */ 0x70FF,                                           // moveq   #-1,d0
+    /* 00F0 */ 0x4E75,                                           // rts
+
+    // Init (D0 = device, A0 = segment list, A6 = ExecBase)
+    /* 00F2 */ 0x2F00,                                           // move.l  d0,-(sp)
+    /* 00F4 */ 0x2F0E,                                           // move.l  a6,-(sp)
+    /* 00F6 */ 0x227A, 0xFF40,                                   // move.l  boardBase(pc),a1
+    /* 00FA */ 0x32BC, 0x0002,                                   // move.w  #HDC_CMD_INIT,(a1)
+    /* 00FE */ 0x43FA, 0x0092,                                   // lea     expLib(pc),a1
+    /* 0102 */ 0x7024,                                           // moveq   #36,d0
+    /* 0104 */ 0x4EAE, 0xFDD8,                                   // jsr     _LVOOpenLibrary(a6)
+    /* 0108 */ 0x4A80,                                           // tst.l   d0
+    /* 010A */ 0x6724,                                           // beq.s   .done
+    /* 010C */ 0x2C40,                                           // move.l  d0,a6
+    /* 010E */ 0x41FA, 0xFF40,                                   // lea     paramPacket(pc),a0
+    /* 0112 */ 0x4EAE, 0xFF70,                                   // jsr     _LVOMakeDosNode(a6)
+    /* 0116 */ 0x4A80,                                           // tst.l   d0
+    /* 0118 */ 0x670E,                                           // beq.s   .close
+    /* 011A */ 0x2040,                                           // move.l  d0,a0
+    /* 011C */ 0x7000,                                           // moveq   #0,d0
+    /* 011E */ 0x7200,                                           // moveq   #0,d1
+    /* 0120 */ 0x227A, 0xFF1A,                                   // move.l  configDev(pc),a1
+    /* 0124 */ 0x4EAE, 0xFFDC,                                   // jsr     _LVOAddBootNode(a6)
+    /* 0128 */ 0x224E,                                           // move.l  a6,a1
+    /* 012A */ 0x2C57,                                           // move.l  (sp),a6
+    /* 012C */ 0x4EAE, 0xFE62,                                   // jsr     _LVOCloseLibrary(a6)
+    /* 0130 */ 0x2C5F,                                           // move.l  (sp)+,a6
+    /* 0132 */ 0x201F,                                           // move.l  (sp)+,d0
+    /* 0134 */ 0x4E75,                                           // rts
+
+    // Open (A1 = IORequest, D0 = unit, D1 = flags, A6 = device)
+    /* 0136 */ 0x207A, 0xFF00,                                   // move.l  boardBase(pc),a0
+    /* 013A */ 0x30BC, 0x0003,                                   // move.w  #HDC_CMD_OPEN,(a0)
+    /* 013E */ 0x4E75,                                           // rts
+
+    // Close (A1 = IORequest, A6 = device)
+    /* 0140 */ 0x207A, 0xFEF6,                                   // move.l  boardBase(pc),a0
+    /* 0144 */ 0x30BC, 0x0004,                                   // move.w  #HDC_CMD_CLOSE,(a0)
+
+    // Expunge, AbortIO
+    /* 0148 */ 0x7000,                                           // moveq   #0,d0
+    /* 014A */ 0x4E75,                                           // rts
+
+    // BeginIO (A1 = IORequest, A6 = device)
+    /* 014C */ 0x207A, 0xFEEA,                                   // move.l  boardBase(pc),a0
+    /* 0150 */ 0x30BC, 0x0005,                                   // move.w  #HDC_CMD_BEGINIO,(a0)
+    /* 0154 */ 0x0829, 0x0000, 0x001E,                           // btst    #IOB_QUICK,IO_FLAGS(a1)
+    /* 015A */ 0x660C,                                           // bne.s   .done
+    /* 015C */ 0x2F0E,                                           // move.l  a6,-(sp)
+    /* 015E */ 0x2C78, 0x0004,                                   // move.l  4.w,a6
+    /* 0162 */ 0x4EAE, 0xFE86,                                   // jsr     _LVOReplyMsg(a6)
+    /* 0166 */ 0x2C5F,                                           // move.l  (sp)+,a6
+    /* 0168 */ 0x4E75,                                           // rts
+
+    // Strings
+    /* 016A */ 0x6864, 0x7269, 0x7665, 0x2E64, 0x6576, 0x6963,   // "hdrive.device"
+    /* 0176 */ 0x6500,
+    /* 0178 */ 0x6864, 0x7269, 0x7665, 0x2031, 0x2E30, 0x2028,   // "hdrive 1.0 (vAmiga)\r\n"
+    /* 0184 */ 0x7641, 0x6D69, 0x6761, 0x290D, 0x0A00,
+    /* 018E */ 0x4448, 0x3000,                                   // "DH0"
+    /* 0192 */ 0x6578, 0x7061, 0x6E73, 0x696F, 0x6E2E, 0x6C69,   // "expansion.library"
+    /* 019E */ 0x6272, 0x6172, 0x7900,
+    /* 01A4 */ 0x646F, 0x732E, 0x6C69, 0x6272, 0x6172, 0x7900,   // "dos.library"
+};
@@ -0,0 +1,32 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Number of processed I/O requests
+    i64 reads;
+    i64 writes;
+    i64 others;
+    
+    // Number of failed I/O requests
+    i64 errors;
+    
+    // Number of transferred bytes
+    i64 bytesRead;
+    i64 bytesWritten;
+}
+HdControllerStats;
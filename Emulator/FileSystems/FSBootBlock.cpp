@@ -96,7 +96,7 @@ FSBootBlock::checksum() const {
     }
 
     // Second boot block
-    u8 *p = partition.dev.blocks[1]->data;
+    u8 *p = partition.dev.blockPtr(1)->data;
     
     for (isize i = 0; i < bsize() / 4; i++) {
         
@@ -104,6 +104,51 @@ FSDevice::makeWithHDF(HDFFile *hdf, ErrorCode *error)
     return volume;
 }
 
+FSDevice *
+FSDevice::makeWithHDF(const string &path, ErrorCode *error)
+{
+    HDFFile *hdf = HDFFile::makeWithMappedFile(path, false, error);
+    if (!hdf) return nullptr;
+    
+    // Get a device descriptor for the HDF
+    FSDeviceDescriptor layout = hdf->layout();
+    
+    // Only proceed if the HDF contains the right amount of data
+    if (layout.numBlocks * layout.bsize > hdf->size) {
+        *error = ERROR_FS_WRONG_CAPACITY;
+        delete hdf;
+        return nullptr;
+    }
+    // Only proceed if all partitions contain a valid file system
+    for (auto &it : layout.partitions) {
+        if (it.dos == FS_NODOS) {
+            *error = ERROR_FS_UNSUPPORTED;
+            delete hdf;
+            return nullptr;
+        }
+    }
+    
+    // Create the device without creating any blocks
+    FSDevice *dev = new FSDevice(layout.numBlocks);
+    
+    dev->numCyls    = layout.numCyls;
+    dev->numHeads   = layout.numHeads;
+    dev->numSectors = layout.numSectors;
+    dev->bsize      = layout.bsize;
+    dev->numBlocks  = layout.numBlocks;
+    dev->image      = hdf;
+    
+    for (auto& descriptor : layout.partitions) {
+        dev->partitions.push_back(FSPartition::makeWithLayout(*dev, descriptor));
+    }
+    
+    // Set the current directory to '/'
+    dev->cd = dev->partitions[0]->rootBlock;
+    
+    *error = ERROR_OK;
+    return dev;
+}
+
 FSDevice *
 FSDevice::make(DiskDiameter type, DiskDensity density, const string &path)
 {
@@ -147,6 +192,7 @@ FSDevice::~FSDevice()
 {
     for (auto &p : partitions) delete p;
     for (auto &b : blocks) delete b;
+    delete image;
 }
 
 void
@@ -168,7 +214,7 @@ FSDevice::dump()
     // Dump all blocks
     for (isize i = 0; i < numBlocks; i++)  {
         
-        if (blocks[i]->type() == FS_EMPTY_BLOCK) continue;
+        if (blockPtr((Block)i)->type() == FS_EMPTY_BLOCK) continue;
         
         msg("\nBlock %zu (%d):", i, blocks[i]->nr);
         msg(" %s\n", FSBlockTypeEnum::key(blocks[i]->type()));
@@ -178,7 +224,7 @@ FSDevice::dump()
 }
 
 isize
-FSDevice::partitionForBlock(Block nr)
+FSDevice::partitionForBlock(Block nr) const
 {
     for (isize i = 0; i < (isize)partitions.size(); i++) {
         if (nr >= partitions[i]->firstBlock && nr <= partitions[i]->lastBlock) return i;
@@ -203,13 +249,87 @@ FSDevice::itemType(Block nr, isize pos) const
 FSBlock *
 FSDevice::blockPtr(Block nr) const
 {
-    return nr < blocks.size() ? blocks[nr] : nullptr;
+    if (nr >= blocks.size()) return nullptr;
+    
+    // Import the block if it is accessed the first time
+    if (blocks[nr] == nullptr && image) blocks[nr] = importBlock(nr);
+    
+    return blocks[nr];
+}
+
+FSBlock *
+FSDevice::importBlock(Block nr) const
+{
+    assert(image);
+    assert(blocks[nr] == nullptr);
+    
+    const u8 *data = image->data + nr * bsize;
+    FSPartition &p = *partitions[partitionForBlock(nr)];
+    
+    FSBlock *block = FSBlock::makeWithType(p, nr, p.predictBlockType(nr, data));
+    assert(block != nullptr);
+    
+    block->importBlock(data, bsize);
+    cached++;
+    
+    return block;
+}
+
+bool
+FSDevice::isClean(Block nr) const
+{
+    assert(image);
+    assert(blocks[nr] != nullptr);
+    
+    FSBlock *block = blocks[nr];
+    const u8 *data = image->data + nr * bsize;
+
+    // Keep the results of the last integrity check
+    if (block->corrupted) return false;
+    
+    // Check if the block has been replaced by a block of a different type
+    if (block->type() != block->partition.predictBlockType(nr, data)) return false;
+
+    // Check if the block data has been modified
+    return block->data == nullptr || memcmp(block->data, data, bsize) == 0;
+}
+
+void
+FSDevice::trim() const
+{
+    if (!image) return;
+    
+    isize remaining = 0;
+    
+    for (isize i = 0; i < numBlocks; i++) {
+        
+        if (blocks[i] == nullptr) continue;
+        
+        if (isClean((Block)i)) {
+            delete blocks[i];
+            blocks[i] = nullptr;
+        } else {
+            remaining++;
+        }
+    }
+    
+    debug(FS_DEBUG, "Trimmed %zd blocks (%zd remaining)\n", cached - remaining, remaining);
+    
+    // Don't trim again before the cache has grown significantly
+    cached = remaining;
+    trimThreshold = std::max(cacheCapacity, 2 * remaining);
+}
+
+void
+FSDevice::trimIfNeeded() const
+{
+    if (cached > trimThreshold) trim();
 }
 
 FSBootBlock *
 FSDevice::bootBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_BOOT_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_BOOT_BLOCK) {
         return (FSBootBlock *)blocks[nr];
     }
     return nullptr;
@@ -218,7 +338,7 @@ FSDevice::bootBlockPtr(Block nr)
 FSRootBlock *
 FSDevice::rootBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_ROOT_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_ROOT_BLOCK) {
         return (FSRootBlock *)blocks[nr];
     }
     return nullptr;
@@ -227,7 +347,7 @@ FSDevice::rootBlockPtr(Block nr)
 FSBitmapBlock *
 FSDevice::bitmapBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_BITMAP_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_BITMAP_BLOCK) {
         return (FSBitmapBlock *)blocks[nr];
     }
     return nullptr;
@@ -236,7 +356,7 @@ FSDevice::bitmapBlockPtr(Block nr)
 FSBitmapExtBlock *
 FSDevice::bitmapExtBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_BITMAP_EXT_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_BITMAP_EXT_BLOCK) {
         return (FSBitmapExtBlock *)blocks[nr];
     }
     return nullptr;
@@ -245,7 +365,7 @@ FSDevice::bitmapExtBlockPtr(Block nr)
 FSUserDirBlock *
 FSDevice::userDirBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_USERDIR_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_USERDIR_BLOCK) {
         return (FSUserDirBlock *)blocks[nr];
     }
     return nullptr;
@@ -254,7 +374,7 @@ FSDevice::userDirBlockPtr(Block nr)
 FSFileHeaderBlock *
 FSDevice::fileHeaderBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_FILEHEADER_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_FILEHEADER_BLOCK) {
         return (FSFileHeaderBlock *)blocks[nr];
     }
     return nullptr;
@@ -263,7 +383,7 @@ FSDevice::fileHeaderBlockPtr(Block nr)
 FSFileListBlock *
 FSDevice::fileListBlockPtr(Block nr)
 {
-    if (nr < blocks.size() && blocks[nr]->type() == FS_FILELIST_BLOCK) {
+    if (blockPtr(nr) && blocks[nr]->type() == FS_FILELIST_BLOCK) {
         return (FSFileListBlock *)blocks[nr];
     }
     return nullptr;
@@ -272,7 +392,7 @@ FSDevice::fileListBlockPtr(Block nr)
 FSDataBlock *
 FSDevice::dataBlockPtr(Block nr)
 {
-    FSBlockType t = nr < blocks.size() ? blocks[nr]->type() : FS_UNKNOWN_BLOCK;
+    FSBlockType t = blockPtr(nr) ? blocks[nr]->type() : FS_UNKNOWN_BLOCK;
 
     if (t == FS_DATA_BLOCK_OFS || t == FS_DATA_BLOCK_FFS) {
         return (FSDataBlock *)blocks[nr];
@@ -283,7 +403,7 @@ FSDevice::dataBlockPtr(Block nr)
 FSBlock *
 FSDevice::hashableBlockPtr(Block nr)
 {
-    FSBlockType t = nr < blocks.size() ? blocks[nr]->type() : FS_UNKNOWN_BLOCK;
+    FSBlockType t = blockPtr(nr) ? blocks[nr]->type() : FS_UNKNOWN_BLOCK;
     
     if (t == FS_USERDIR_BLOCK || t == FS_FILEHEADER_BLOCK) {
         return blocks[nr];
@@ -295,7 +415,9 @@ void
 FSDevice::updateChecksums()
 {
     for (isize i = 0; i < numBlocks; i++) {
-        blocks[i]->updateChecksum();
+        
+        // Blocks that haven't been imported yet are left untouched
+        if (blocks[i]) blocks[i]->updateChecksum();
     }
 }
 
@@ -606,13 +728,14 @@ FSDevice::check(bool strict) const
     // Analyze all blocks
     for (isize i = 0; i < numBlocks; i++) {
 
-        if (blocks[i]->check(strict) > 0) {
+        if (blockPtr((Block)i)->check(strict) > 0) {
             min = std::min(min, i);
             max = std::max(max, i);
             blocks[i]->corrupted = ++total;
         } else {
             blocks[i]->corrupted = 0;
         }
+        trimIfNeeded();
     }
 
     // Record findings
@@ -632,7 +755,7 @@ FSDevice::check(bool strict) const
 ErrorCode
 FSDevice::check(Block nr, isize pos, u8 *expected, bool strict) const
 {
-    return blocks[nr]->check(pos, expected, strict);
+    return blockPtr(nr)->check(pos, expected, strict);
 }
 
 ErrorCode
@@ -721,7 +844,8 @@ FSDevice::readByte(Block nr, isize offset) const
     assert(offset < bsize);
 
     if (nr < (Block)numBlocks) {
-        return blocks[nr]->data ? blocks[nr]->data[offset] : 0;
+        FSBlock *block = blockPtr(nr);
+        return block->data ? block->data[offset] : 0;
     }
     
     return 0;
@@ -801,10 +925,13 @@ FSDevice::importVolume(const u8 *src, isize size, ErrorCode *err)
     
     if (err) *err = ERROR_OK;
     debug(FS_DEBUG, "Success\n");
-    info();
-    dump();
-    util::hexdump(blocks[0]->data, 512);
-    printDirectory(true);
+    
+    if (FS_DEBUG) {
+        info();
+        dump();
+        util::hexdump(blocks[0]->data, 512);
+        printDirectory(true);
+    }
     return true;
 }
 
@@ -871,7 +998,17 @@ FSDevice::exportBlocks(Block first, Block last, u8 *dst, isize size, ErrorCode *
     // Export all blocks
     for (isize i = 0; i < count; i++) {
         
-        blocks[first + i]->exportBlock(dst + i * bsize, bsize);
+        Block nr = first + (Block)i;
+        
+        if (blocks[nr] == nullptr && image) {
+            
+            // Blocks that haven't been imported yet are copied from the source
+            memcpy(dst + i * bsize, image->data + nr * bsize, bsize);
+            
+        } else {
+            
+            blockPtr(nr)->exportBlock(dst + i * bsize, bsize);
+        }
     }
 
     debug(FS_DEBUG, "Success\n");
@@ -959,6 +1096,7 @@ FSDevice::exportDirectory(const string &path)
             msg("Export error: %lld\n", error);
             return error; 
         }
+        trimIfNeeded();
     }
     
     msg("Exported %zu items", items.size());
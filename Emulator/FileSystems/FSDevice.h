@@ -34,6 +34,9 @@
 
 class FSDevice : AmigaObject {
     
+    // Number of imported blocks kept in a lazily imported volume (typical)
+    static constexpr isize cacheCapacity = 4096;
+    
     friend struct FSPartition;
     friend struct FSBlock;
     friend struct FSEmptyBlock;
@@ -64,8 +67,22 @@ protected:
     // The partition table
     std::vector<FSPartitionPtr> partitions;
     
-    // The block storage
-    std::vector<BlockPtr> blocks;
+    /* The block storage. If the volume has been imported lazily, blocks are
+     * created on first access and the vector may contain null pointers.
+     */
+    mutable std::vector<BlockPtr> blocks;
+    
+    /* Source of a lazily imported volume. Blocks are created from the source
+     * data when they are accessed the first time. Since each block gets its
+     * own copy of the data, the source is never modified.
+     */
+    class HDFFile *image = nullptr;
+    
+    // Number of blocks in the block storage of a lazily imported volume
+    mutable isize cached = 0;
+    
+    // Number of cached blocks that causes trimIfNeeded() to call trim()
+    mutable isize trimThreshold = cacheCapacity;
             
     // The currently selected partition
     isize cp = 0;
@@ -89,6 +106,11 @@ public:
     // Creates a file system from an ADF or HDF
     static FSDevice *makeWithADF(class ADFFile *adf, ErrorCode *error);
     static FSDevice *makeWithHDF(class HDFFile *hdf, ErrorCode *error);
+
+    /* Creates a file system from a memory-mapped HDF. The volume is imported
+     * lazily, i.e., blocks are created when they are accessed the first time.
+     */
+    static FSDevice *makeWithHDF(const string &path, ErrorCode *error);
     
     // Creates a file system with the contents of a host file system directory
     static FSDevice *make(DiskDiameter type, DiskDensity density, const string &path);
@@ -150,7 +172,7 @@ public:
     isize numPartitions() { return (isize)partitions.size(); }
     
     // Returns the partition a certain block belongs to
-    isize partitionForBlock(Block nr);
+    isize partitionForBlock(Block nr) const;
 
     // Gets or sets the name of the current partition
     FSName getName() { return partitions[cp]->getName(); }
@@ -183,6 +205,28 @@ public:
     
     // Queries a pointer from the block storage (may return nullptr)
     FSBlock *blockPtr(Block nr) const;
+    
+    // Checks whether the volume is imported lazily
+    bool isLazy() const { return image != nullptr; }
+
+    /* Deletes all imported blocks that haven't been modified. The blocks are
+     * recreated from the source data when they are accessed again. Pointers to
+     * blocks obtained before calling this function become invalid.
+     */
+    void trim() const;
+
+private:
+    
+    // Creates a block from the source data of a lazily imported volume
+    FSBlock *importBlock(Block nr) const;
+
+    // Checks whether an imported block still matches the source data
+    bool isClean(Block nr) const;
+
+    // Calls trim() if the number of imported blocks exceeds the threshold
+    void trimIfNeeded() const;
+
+public:
 
     // Queries a pointer to a block of a certain type (may return nullptr)
     FSBootBlock *bootBlockPtr(Block nr);
@@ -12,6 +12,7 @@
 #include "FSBlock.h"
 #include <algorithm>
 #include <cstring>
+#include <ctime>
 
 FSString::FSString(const string &cppString, isize limit) : FSString(cppString.c_str(), limit)
 {
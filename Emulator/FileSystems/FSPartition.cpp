@@ -15,7 +15,7 @@
 #include <vector>
 
 FSPartition *
-FSPartition::makeWithFormat(FSDevice &dev, FSPartitionDescriptor &layout)
+FSPartition::makeWithLayout(FSDevice &dev, FSPartitionDescriptor &layout)
 {
     FSPartition *p = new FSPartition(dev);
 
@@ -29,6 +29,14 @@ FSPartition::makeWithFormat(FSDevice &dev, FSPartitionDescriptor &layout)
     p->firstBlock  = (Block)(p->lowCyl * dev.numHeads * dev.numSectors);
     p->lastBlock   = (Block)((p->highCyl + 1) * dev.numHeads * dev.numSectors - 1);
     
+    return p;
+}
+
+FSPartition *
+FSPartition::makeWithFormat(FSDevice &dev, FSPartitionDescriptor &layout)
+{
+    FSPartition *p = makeWithLayout(dev, layout);
+    
     // Do some consistency checking
     for (Block i = p->firstBlock; i <= p->lastBlock; i++) assert(dev.blocks[i] == nullptr);
     
@@ -264,7 +272,7 @@ FSPartition::allocateBlockAbove(Block nr)
     assert(nr >= firstBlock && nr <= lastBlock);
     
     for (i64 i = (i64)nr + 1; i <= lastBlock; i++) {
-        if (dev.blocks[i]->type() == FS_EMPTY_BLOCK) {
+        if (dev.blockPtr((Block)i)->type() == FS_EMPTY_BLOCK) {
             markAsAllocated((Block)i);
             return (Block)i;
         }
@@ -278,7 +286,7 @@ FSPartition::allocateBlockBelow(Block nr)
     assert(nr >= firstBlock && nr <= lastBlock);
     
     for (i64 i = (i64)nr - 1; i >= firstBlock; i--) {
-        if (dev.blocks[i]->type() == FS_EMPTY_BLOCK) {
+        if (dev.blockPtr((Block)i)->type() == FS_EMPTY_BLOCK) {
             markAsAllocated((Block)i);
             return (Block)i;
         }
@@ -290,7 +298,7 @@ void
 FSPartition::deallocateBlock(Block nr)
 {
     assert(nr >= firstBlock && nr <= lastBlock);
-    assert(dev.blocks[nr]);
+    assert(dev.blockPtr(nr));
     
     delete dev.blocks[nr];
     dev.blocks[nr] = new FSEmptyBlock(*this, nr);
@@ -464,27 +472,27 @@ FSPartition::locateAllocationBit(Block nr, isize *byte, isize *bit) const
 void
 FSPartition::makeBootable(BootBlockId id)
 {
-    assert(dev.blocks[firstBlock + 0]->type() == FS_BOOT_BLOCK);
-    assert(dev.blocks[firstBlock + 1]->type() == FS_BOOT_BLOCK);
+    assert(dev.blockPtr(firstBlock + 0)->type() == FS_BOOT_BLOCK);
+    assert(dev.blockPtr(firstBlock + 1)->type() == FS_BOOT_BLOCK);
 
-    ((FSBootBlock *)dev.blocks[firstBlock + 0])->writeBootBlock(id, 0);
-    ((FSBootBlock *)dev.blocks[firstBlock + 1])->writeBootBlock(id, 1);
+    ((FSBootBlock *)dev.blockPtr(firstBlock + 0))->writeBootBlock(id, 0);
+    ((FSBootBlock *)dev.blockPtr(firstBlock + 1))->writeBootBlock(id, 1);
 }
 
 void
 FSPartition::killVirus()
 {
-    assert(dev.blocks[firstBlock + 0]->type() == FS_BOOT_BLOCK);
-    assert(dev.blocks[firstBlock + 1]->type() == FS_BOOT_BLOCK);
+    assert(dev.blockPtr(firstBlock + 0)->type() == FS_BOOT_BLOCK);
+    assert(dev.blockPtr(firstBlock + 1)->type() == FS_BOOT_BLOCK);
 
     long id = isOFS() ? BB_AMIGADOS_13 : isFFS() ? BB_AMIGADOS_20 : BB_NONE;
 
     if (id != BB_NONE) {
-        ((FSBootBlock *)dev.blocks[firstBlock + 0])->writeBootBlock(id, 0);
-        ((FSBootBlock *)dev.blocks[firstBlock + 1])->writeBootBlock(id, 1);
+        ((FSBootBlock *)dev.blockPtr(firstBlock + 0))->writeBootBlock(id, 0);
+        ((FSBootBlock *)dev.blockPtr(firstBlock + 1))->writeBootBlock(id, 1);
     } else {
-        memset(dev.blocks[firstBlock + 0]->data + 4, 0, bsize() - 4);
-        memset(dev.blocks[firstBlock + 1]->data, 0, bsize());
+        memset(dev.blockPtr(firstBlock + 0)->data + 4, 0, bsize() - 4);
+        memset(dev.blockPtr(firstBlock + 1)->data, 0, bsize());
     }
 }
 
@@ -497,7 +505,7 @@ FSPartition::check(bool strict, FSErrorReport &report) const
     
     for (Block i = firstBlock; i <= lastBlock; i++) {
 
-        FSBlock *block = dev.blocks[i];
+        FSBlock *block = dev.blockPtr(i);
         if (block->type() == FS_EMPTY_BLOCK && !isFree((Block)i)) {
             report.bitmapErrors++;
             debug(FS_DEBUG, "Empty block %d is marked as allocated\n", i);
@@ -42,6 +42,9 @@ struct FSPartition : AmigaObject {
     
 public:
 
+    // Creates a partition without creating any blocks
+    static FSPartition *makeWithLayout(FSDevice &ref, FSPartitionDescriptor &layout);
+
     // Creates a file system with a custom device descriptor
     static FSPartition *makeWithFormat(FSDevice &ref, FSPartitionDescriptor &layout);
 
@@ -346,10 +346,7 @@ ADFFile::encodeDisk(Disk *disk)
     long tracks = numTracks();
     debug(MFM_DEBUG, "Encoding %ld tracks\n", tracks);
 
-    // Start with an unformatted disk
-    disk->clearDisk();
-
-    // Encode all tracks
+    // Encode all tracks (the caller has cleared the disk already)
     bool result = true;
     for (Track t = 0; t < tracks; t++) result &= encodeTrack(disk, t);
 
@@ -382,13 +379,12 @@ ADFFile::encodeTrack(Disk *disk, Track t)
     for (Sector s = 0; s < sectors; s++) result &= encodeSector(disk, t, s);
     
     // Rectify the first clock bit (where buffer wraps over)
-    if (disk->data.track[t][disk->length.track[t] - 1] & 1) {
-        disk->data.track[t][0] &= 0x7F;
-    }
+    u8 *p = disk->writableTrackData(t);
+    if (p[disk->length.track[t] - 1] & 1) p[0] &= 0x7F;
     
     // Compute a debug checksum
     debug(MFM_DEBUG, "Track %d checksum = %x\n",
-          t, util::fnv_1a_32(disk->data.track[t], disk->length.track[t]));
+          t, util::fnv_1a_32(disk->trackData(t), disk->length.track[t]));
 
     return result;
 }
@@ -411,7 +407,7 @@ ADFFile::encodeSector(Disk *disk, Track t, Sector s)
     //     Data checksum       56      8     Odd/Even encoded
     
     // Determine the start of this sector
-    u8 *p = disk->data.track[t] + 700 + (s * 1088);
+    u8 *p = disk->writableTrackData(t) + 700 + (s * 1088);
     // u8 *p = disk->ptr(t, s);
     
     // Bytes before SYNC
@@ -461,9 +457,7 @@ ADFFile::encodeSector(Disk *disk, Track t, Sector s)
     Disk::encodeOddEven(&p[56], dcheck, sizeof(bcheck));
     
     // Add clock bits
-    for(isize i = 8; i < 1088; i++) {
-        p[i] = Disk::addClockBits(p[i], p[i-1]);
-    }
+    Disk::addClockBits(&p[8], 1080);
     
     return true;
 }
@@ -487,9 +481,6 @@ ADFFile::decodeDisk(Disk *disk)
     if (disk->getDensity() != getDiskDensity()) {
         throw VAError(ERROR_DISK_INVALID_DENSITY);
     }
-        
-    // Make the MFM stream scannable beyond the track end
-    disk->repeatTracks();
 
     for (Track t = 0; t < tracks; t++) {
         if (!decodeTrack(disk, t)) throw VAError(ERROR_DISK_CANT_DECODE);
@@ -503,12 +494,15 @@ ADFFile::decodeTrack(Disk *disk, Track t)
 
     trace(MFM_DEBUG, "Decoding track %d\n", t);
     
-    u8 *src = disk->data.track[t];
     u8 *dst = data + t * sectors * 512;
     
+    // Make the MFM stream scannable beyond the track end
+    u8 src[32768];
+    disk->repeatTrack(t, src, isizeof(src));
+    
     // Seek all sync marks
     isize sectorStart[sectors], nr = 0; isize index = 0;
-    while (index < isizeof(disk->data.track[t]) && nr < sectors) {
+    while (index < isizeof(src) && nr < sectors) {
 
         // Scan MFM stream for $4489 $4489
         if (src[index++] != 0x44) continue;
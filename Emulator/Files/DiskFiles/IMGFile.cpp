@@ -134,10 +134,9 @@ IMGFile::encodeTrack(Disk *disk, Track t)
 
     debug(MFM_DEBUG, "Encoding DOS track %d with %ld sectors\n", t, sectors);
 
-    u8 *p = disk->data.track[t];
-
     // Clear track
     disk->clearTrack(t, 0x92, 0x54);
+    u8 *p = disk->writableTrackData(t);
 
     // Encode track header
     p += 82;                                        // GAP
@@ -157,7 +156,7 @@ IMGFile::encodeTrack(Disk *disk, Track t)
     // Compute a checksum for debugging
     debug(MFM_DEBUG,
           "Track %d checksum = %x\n",
-          t, util::fnv_1a_32(disk->data.track[t], disk->length.track[t]));
+          t, util::fnv_1a_32(disk->trackData(t), disk->length.track[t]));
 
     return result;
 }
@@ -213,7 +212,7 @@ IMGFile::encodeSector(Disk *disk, Track t, Sector s)
     for (isize i = 574; i < isizeof(buf); i++) { buf[i] = 0x4E; }
 
     // Determine the start of this sector
-    u8 *p = disk->data.track[t] + 194 + s * 1300;
+    u8 *p = disk->writableTrackData(t) + 194 + s * 1300;
 
     // Create the MFM data stream
     Disk::encodeMFM(p, buf, sizeof(buf));
@@ -245,9 +244,6 @@ IMGFile::decodeDisk(Disk *disk)
     if (disk->getDensity() != getDiskDensity()) {
         throw VAError(ERROR_DISK_INVALID_DENSITY);
     }
-    
-    // Make the MFM stream scannable beyond the track end
-    disk->repeatTracks();
 
     for (Track t = 0; t < tracks; t++) {
         if (!decodeTrack(disk, t)) throw VAError(ERROR_DISK_CANT_DECODE);
@@ -260,9 +256,12 @@ IMGFile::decodeTrack(Disk *disk, Track t)
     assert(t < disk->numTracks());
         
     long numSectors = 9;
-    u8 *src = disk->data.track[t];
     u8 *dst = data + t * numSectors * 512;
     
+    // Make the MFM stream scannable beyond the track end
+    u8 src[32768];
+    disk->repeatTrack(t, src, isizeof(src));
+    
     trace(MFM_DEBUG, "Decoding DOS track %d\n", t);
 
     // Determine the start of all sectors contained in this track
@@ -271,7 +270,7 @@ IMGFile::decodeTrack(Disk *disk, Track t)
         sectorStart[i] = 0;
     }
     isize cnt = 0;
-    for (isize i = 0; i < isizeof(disk->data.track[t]) - 16;) {
+    for (isize i = 0; i < isizeof(src) - 16;) {
         
         // Seek IDAM block
         if (src[i++] != 0x44) continue;
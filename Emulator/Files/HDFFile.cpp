@@ -15,6 +15,42 @@ HDFFile::HDFFile()
 {
 }
 
+HDFFile::~HDFFile()
+{
+    // Mapped data is released by the mapping, not by AmigaFile
+    if (mapping.isMapped()) data = nullptr;
+}
+
+HDFFile *
+HDFFile::makeWithMappedFile(const string &path, bool shared)
+{
+    if (!isCompatiblePath(path)) throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    if (!util::fileExists(path)) throw VAError(ERROR_FILE_NOT_FOUND, path);
+
+    HDFFile *hdf = new HDFFile();
+    
+    if (!hdf->mapping.map(path, shared)) {
+        delete hdf;
+        throw VAError(ERROR_FILE_CANT_READ, path);
+    }
+    if (hdf->mapping.size % 512) {
+        delete hdf;
+        throw VAError(ERROR_FILE_TYPE_MISMATCH);
+    }
+    
+    hdf->path = path;
+    hdf->data = hdf->mapping.data;
+    hdf->size = hdf->mapping.size;
+    return hdf;
+}
+
+HDFFile *
+HDFFile::makeWithMappedFile(const string &path, bool shared, ErrorCode *err)
+{
+    try { *err = ERROR_OK; return makeWithMappedFile(path, shared); }
+    catch (VAError &exception) { *err = exception.data; return nullptr; }
+}
+
 bool
 HDFFile::isCompatiblePath(const string &path)
 {
@@ -11,11 +11,17 @@
 
 #include "AmigaFile.h"
 #include "FSDevice.h"
+#include "MappedFile.h"
 
 class Disk;
 
 class HDFFile : public AmigaFile {
     
+    /* Optional file mapping. If the HDF has been created by makeWithMappedFile,
+     * the data pointer refers to the mapped file instead of a heap buffer.
+     */
+    util::MappedFile mapping;
+    
 public:
     
     //
@@ -25,6 +31,13 @@ public:
     static bool isCompatiblePath(const string &path);
     static bool isCompatibleStream(std::istream &stream);
     
+    /* Creates an HDF backed by a memory-mapped file. In contrast to the
+     * standard factory methods, the file is not read into memory. In shared
+     * mode, all modifications of the data are written back to the file.
+     */
+    static HDFFile *makeWithMappedFile(const string &path, bool shared = false) throws;
+    static HDFFile *makeWithMappedFile(const string &path, bool shared, ErrorCode *err);
+    
     
     //
     // Initializing
@@ -33,6 +46,7 @@ public:
 public:
 
     HDFFile();
+    ~HDFFile();
     
     const char *getDescription() const override { return "HDF"; }
 
@@ -45,6 +59,9 @@ public:
     
     FileType type() const override { return FILETYPE_HDF; }
 
+    // Checks whether the data is backed by a memory-mapped file
+    bool isMapped() const { return mapping.isMapped(); }
+
 
     //
     // Querying volume information
@@ -10,8 +10,34 @@
 #include "config.h"
 #include "Snapshot.h"
 #include "Amiga.h"
+#include "Compression.h"
 #include "IO.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Magic bytes of raw and compressed snapshots
+static const u8 rawMagic[] = { 'V', 'A', 'S', 'N', 'A', 'P' };
+static const u8 zipMagic[] = { 'V', 'A', 'S', 'N', 'P', 'Z' };
+
+// Flag indicating a chunk that is stored uncompressed
+static const u32 storedFlag = 0x80000000;
+
+// Writes a 32-bit value in little endian format
+static void write32(std::ostream &stream, u32 value)
+{
+    for (isize i = 0; i < 4; i++) stream.put((char)(value >> (8 * i)));
+}
+
+// Reads a 32-bit value in little endian format
+static u32 read32(std::istream &stream)
+{
+    u32 result = 0;
+    for (isize i = 0; i < 4; i++) result |= (u32)(u8)stream.get() << (8 * i);
+    return result;
+}
+
 Thumbnail *
 Thumbnail::makeWithAmiga(Amiga *amiga, isize dx, isize dy)
 {
@@ -24,7 +50,9 @@ Thumbnail::makeWithAmiga(Amiga *amiga, isize dx, isize dy)
 void
 Thumbnail::take(Amiga *amiga, isize dx, isize dy)
 {
-    u32 *source = (u32 *)amiga->denise.pixelEngine.getStableBuffer().data;
+    auto &pixelEngine = amiga->denise.pixelEngine;
+    ScreenBuffer buffer = pixelEngine.lockStableBuffer();
+    u32 *source = buffer.data;
     u32 *target = screen;
     
     isize xStart = 4 * HBLANK_MAX + 1, xEnd = HPIXELS + 4 * HBLANK_MIN;
@@ -42,6 +70,7 @@ Thumbnail::take(Amiga *amiga, isize dx, isize dy)
         source += dy * HPIXELS;
         target += width;
     }
+    pixelEngine.unlockStableBuffer(buffer);
     
     timestamp = time(nullptr);
 }
@@ -55,10 +84,17 @@ Snapshot::isCompatiblePath(const string &path)
 bool
 Snapshot::isCompatibleStream(std::istream &stream)
 {
-    const u8 magicBytes[] = { 'V', 'A', 'S', 'N', 'A', 'P' };
-    
     if (util::streamLength(stream) < 0x15) return false;
-    return util::matchingStreamHeader(stream, magicBytes, sizeof(magicBytes));
+    
+    return
+    util::matchingStreamHeader(stream, rawMagic, sizeof(rawMagic)) ||
+    util::matchingStreamHeader(stream, zipMagic, sizeof(zipMagic));
+}
+
+bool
+Snapshot::isCompressedStream(std::istream &stream)
+{
+    return util::matchingStreamHeader(stream, zipMagic, sizeof(zipMagic));
 }
 
 Snapshot::Snapshot()
@@ -67,15 +103,13 @@ Snapshot::Snapshot()
 
 Snapshot::Snapshot(isize capacity)
 {
-    u8 signature[] = { 'V', 'A', 'S', 'N', 'A', 'P' };
-    
     size = capacity + sizeof(SnapshotHeader);
     data = new u8[size];
     
     SnapshotHeader *header = (SnapshotHeader *)data;
     
-    for (isize i = 0; i < isizeof(signature); i++)
-        header->magic[i] = signature[i];
+    for (isize i = 0; i < isizeof(rawMagic); i++)
+        header->magic[i] = rawMagic[i];
     header->major = SNP_MAJOR;
     header->minor = SNP_MINOR;
     header->subminor = SNP_SUBMINOR;
@@ -97,3 +131,139 @@ Snapshot::takeScreenshot(Amiga &amiga)
 {
     ((SnapshotHeader *)data)->screenshot.take(&amiga);
 }
+
+isize
+Snapshot::readFromStream(std::istream &stream)
+{
+    if (isCompressedStream(stream)) return readCompressedFromStream(stream);
+    return AmigaFile::readFromStream(stream);
+}
+
+isize
+Snapshot::readCompressedFromStream(std::istream &stream)
+{
+    u8 header[sizeof(zipMagic) + 3];
+    
+    // Read the header
+    stream.seekg(0, std::ios::beg);
+    stream.read((char *)header, sizeof(header));
+    isize rawSize = read32(stream);
+    isize chunk = read32(stream);
+    isize count = read32(stream);
+    
+    if (!stream || chunk == 0 || rawSize < isizeof(SnapshotHeader) ||
+        count != (rawSize + chunk - 1) / chunk) {
+        throw VAError(ERROR_SNP_CORRUPTED);
+    }
+    
+    /* Don't trust the size stored in the header. It must not exceed the size
+     * of the largest possible snapshot and each chunk must be present in the
+     * stream with at least its four byte chunk header.
+     */
+    if (rawSize > maxSize || 4 * count > util::streamLength(stream)) {
+        throw VAError(ERROR_SNP_CORRUPTED);
+    }
+    
+    // Allocate memory for the raw snapshot
+    assert(data == nullptr);
+    data = new u8[rawSize];
+    size = rawSize;
+    
+    // Decompress all chunks
+    std::vector<u8> buffer;
+    
+    for (isize i = 0, offset = 0; i < count; i++, offset += chunk) {
+        
+        u32 info = read32(stream);
+        isize len = info & ~storedFlag;
+        isize expected = std::min(chunk, rawSize - offset);
+        
+        if (!stream || len > util::lz4Bound(expected)) {
+            throw VAError(ERROR_SNP_CORRUPTED);
+        }
+        
+        buffer.resize(len);
+        stream.read((char *)buffer.data(), len);
+        if (!stream) throw VAError(ERROR_SNP_CORRUPTED);
+        
+        if (info & storedFlag) {
+            
+            if (len != expected) throw VAError(ERROR_SNP_CORRUPTED);
+            memcpy(data + offset, buffer.data(), len);
+            
+        } else {
+            
+            if (util::lz4Decompress(buffer.data(), len, data + offset, expected) != expected) {
+                throw VAError(ERROR_SNP_CORRUPTED);
+            }
+        }
+    }
+    
+    // Make sure the decompressed data is a snapshot
+    if (!util::matchingBufferHeader(data, rawMagic, sizeof(rawMagic))) {
+        throw VAError(ERROR_SNP_CORRUPTED);
+    }
+    
+    return size;
+}
+
+isize
+Snapshot::writeCompressedToStream(std::ostream &stream)
+{
+    auto header = getHeader();
+    isize count = (size + chunkSize - 1) / chunkSize;
+    std::vector<u32> index;
+    std::vector<u8> buffer(util::lz4Bound(chunkSize));
+    
+    // Write the header
+    stream.write((const char *)zipMagic, sizeof(zipMagic));
+    stream.put((char)header->major);
+    stream.put((char)header->minor);
+    stream.put((char)header->subminor);
+    write32(stream, (u32)size);
+    write32(stream, (u32)chunkSize);
+    write32(stream, (u32)count);
+    isize written = sizeof(zipMagic) + 3 + 12;
+    
+    // Compress and write all chunks
+    for (isize i = 0, offset = 0; i < count; i++, offset += chunkSize) {
+        
+        isize len = std::min(chunkSize, size - offset);
+        isize compressed = util::lz4Compress(data + offset, len, buffer.data());
+        
+        index.push_back((u32)written);
+        
+        if (compressed < len) {
+            
+            write32(stream, (u32)compressed);
+            stream.write((const char *)buffer.data(), compressed);
+            written += 4 + compressed;
+            
+        } else {
+            
+            write32(stream, (u32)len | storedFlag);
+            stream.write((const char *)(data + offset), len);
+            written += 4 + len;
+        }
+    }
+    
+    // Write the chunk index
+    for (auto offset : index) write32(stream, offset);
+    write32(stream, (u32)written);
+    written += 4 * (count + 1);
+    
+    if (!stream) throw VAError(ERROR_FILE_CANT_WRITE);
+    return written;
+}
+
+isize
+Snapshot::writeCompressedToFile(const string &path)
+{
+    std::ofstream stream(path, std::ios::binary);
+    
+    if (!stream.is_open()) {
+        throw VAError(ERROR_FILE_CANT_WRITE, path);
+    }
+    
+    return writeCompressedToStream(stream);
+}
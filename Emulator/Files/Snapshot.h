@@ -46,6 +46,25 @@ struct SnapshotHeader {
     Thumbnail screenshot;
 };
 
+/* Snapshots can be stored in raw or in compressed form. A compressed snapshot
+ * is organized as follows:
+ *
+ *     Header:  Magic bytes ('V','A','S','N','P','Z')
+ *              Version number (V major.minor.subminor)
+ *              Size of the raw snapshot (u32)
+ *              Chunk size (u32)
+ *              Number of chunks (u32)
+ *     Chunks:  Size of the chunk data (u32) followed by the chunk data
+ *     Index:   Start offset of each chunk (u32)
+ *              Start offset of the index (u32)
+ *
+ * The raw snapshot is split into chunks of equal size (the last one may be
+ * smaller) which are compressed independently. Chunks that don't shrink are
+ * stored uncompressed which is indicated by bit 31 of the size field. All
+ * numbers are stored in little endian format. The index is not needed for
+ * reading the snapshot sequentially. It allows tools to access single chunks
+ * without decompressing the preceding ones.
+ */
 class Snapshot : public AmigaFile {
  
     //
@@ -56,6 +75,9 @@ public:
     
     static bool isCompatiblePath(const string &path);
     static bool isCompatibleStream(std::istream &stream);
+    
+    // Checks whether a stream contains a compressed snapshot
+    static bool isCompressedStream(std::istream &stream);
 
             
     //
@@ -77,6 +99,7 @@ public:
     //
     
     FileType type() const override { return FILETYPE_SNAPSHOT; }
+    isize readFromStream(std::istream &stream) override throws;
     
     
     //
@@ -96,4 +119,39 @@ public:
     
     // Takes a screenshot
     void takeScreenshot(Amiga &amiga);
+    
+    
+    //
+    // Compressing
+    //
+    
+public:
+    
+    // Size of a single chunk in a compressed snapshot
+    static constexpr isize chunkSize = 0x10000;
+    
+    /* Upper bound for the size of an uncompressed snapshot. It is composed of
+     * the largest possible size of all memory types (Rom, Wom, Extension Rom,
+     * Chip Ram, Slow Ram, Fast Ram), the track data of four inserted HD disks
+     * (168 tracks of 24636 bytes each), and the state of all other components.
+     * The latter is about 25 KB and bounded generously.
+     */
+    static constexpr isize maxMemorySize =
+    KB(512) + KB(256) + KB(512) + MB(2) + KB(512) + MB(8);
+    static constexpr isize maxDiskSize = 168 * 24636;
+    static constexpr isize maxStateSize = KB(256);
+    static constexpr isize maxSize =
+    isizeof(SnapshotHeader) + maxMemorySize + 4 * maxDiskSize + maxStateSize;
+    
+    /* Writes the snapshot in compressed form. The chunks are compressed one
+     * after another and written to the stream right away. The functions
+     * return the number of written bytes.
+     */
+    isize writeCompressedToStream(std::ostream &stream) throws;
+    isize writeCompressedToFile(const string &path) throws;
+    
+private:
+    
+    // Reads a compressed snapshot chunk by chunk
+    isize readCompressedFromStream(std::istream &stream) throws;
 };
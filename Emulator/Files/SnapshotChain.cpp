@@ -0,0 +1,162 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "SnapshotChain.h"
+#include "Amiga.h"
+
+#include <cstring>
+
+void
+SnapshotChain::clear()
+{
+    entries.clear();
+    current = -1;
+}
+
+void
+SnapshotChain::setCapacity(isize value)
+{
+    capacity = std::max(value, (isize)1);
+    while (count() > capacity) dropBase();
+    if (current >= count()) current = count() - 1;
+}
+
+isize
+SnapshotChain::memoryUsage() const
+{
+    isize result = 0;
+
+    for (auto &entry : entries) {
+
+        result += (isize)entry.state.size();
+        result += (isize)entry.pages.size() * isizeof(u32);
+        result += (isize)entry.data.size();
+    }
+    return result;
+}
+
+void
+SnapshotChain::record()
+{
+    auto &mem = amiga.mem;
+
+    // Discard all entries following the restored one
+    if (current + 1 < count()) entries.resize(current + 1);
+
+    // Start from scratch if the memory layout has changed
+    if (!entries.empty() && layout != mem.getPageLayout()) {
+        entries.clear();
+    }
+
+    Entry entry;
+    bool base = entries.empty();
+    if (base) layout = mem.getPageLayout();
+
+    entry.frame = amiga.agnus.frame.nr;
+    saveState(entry.state);
+
+    // Record all modified memory pages (or all pages if this is the base)
+    for (isize i = 0; i < mem.pageCount(); i++) {
+
+        if (!base && !mem.isDirty(i)) continue;
+
+        isize bytes;
+        u8 *addr = mem.pageAddr(i, bytes);
+
+        entry.pages.push_back((u32)i);
+        entry.data.resize(entry.data.size() + Memory::dirtyPageSize);
+        memcpy(entry.data.data() + entry.data.size() - Memory::dirtyPageSize, addr, bytes);
+    }
+    mem.clearDirtyPages();
+
+    trace(SNP_DEBUG, "Recorded %zu pages in frame %lld\n", entry.pages.size(), entry.frame);
+
+    entries.push_back(std::move(entry));
+    if (count() > capacity) dropBase();
+    current = count() - 1;
+}
+
+void
+SnapshotChain::restore(isize nr)
+{
+    if (nr < 0 || nr >= count()) throw VAError(ERROR_SNP_NOT_RECORDED);
+
+    auto &mem = amiga.mem;
+
+    // Restore all components except the memory contents
+    mem.serializeContents = false;
+    amiga.load(entries[nr].state.data());
+    mem.serializeContents = true;
+
+    /* Restore the memory contents. Walking backwards, each page is taken from
+     * the most recent entry that contains it. The walk ends at the base at
+     * the latest, because the base contains all pages.
+     */
+    isize remaining = mem.pageCount();
+    std::vector<bool> done(remaining);
+
+    for (isize i = nr; i >= 0 && remaining; i--) {
+
+        auto &entry = entries[i];
+
+        for (usize j = 0; j < entry.pages.size(); j++) {
+
+            u32 page = entry.pages[j];
+            if (done[page]) continue;
+
+            isize bytes;
+            u8 *addr = mem.pageAddr(page, bytes);
+            memcpy(addr, entry.data.data() + j * Memory::dirtyPageSize, bytes);
+
+            done[page] = true;
+            remaining--;
+        }
+    }
+    assert(remaining == 0);
+
+    mem.clearDirtyPages();
+    current = nr;
+
+    trace(SNP_DEBUG, "Restored frame %lld\n", entries[nr].frame);
+}
+
+void
+SnapshotChain::saveState(std::vector<u8> &buffer)
+{
+    amiga.mem.serializeContents = false;
+    buffer.resize(amiga.size());
+    amiga.save(buffer.data());
+    amiga.mem.serializeContents = true;
+}
+
+void
+SnapshotChain::dropBase()
+{
+    assert(count() >= 2);
+
+    auto &base = entries[0];
+    auto &next = entries[1];
+
+    // The base contains all pages in ascending order
+    assert(base.data.size() == base.pages.size() * Memory::dirtyPageSize);
+
+    // Copy the pages of the first delta into the base
+    for (usize i = 0; i < next.pages.size(); i++) {
+
+        memcpy(base.data.data() + next.pages[i] * Memory::dirtyPageSize,
+               next.data.data() + i * Memory::dirtyPageSize,
+               Memory::dirtyPageSize);
+    }
+    base.frame = next.frame;
+    base.state = std::move(next.state);
+
+    entries.erase(entries.begin() + 1);
+    if (current > 0) current--;
+}
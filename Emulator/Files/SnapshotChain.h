@@ -0,0 +1,129 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "AmigaObject.h"
+#include <deque>
+#include <vector>
+
+class Amiga;
+
+/* A sequence of emulator states which is recorded incrementally. The first
+ * entry (the base) contains the contents of all memory pages. All other
+ * entries (the deltas) only contain the memory pages which have been modified
+ * since the previous entry has been recorded. The state of all other
+ * components is small compared to the memory contents and recorded completely
+ * in each entry. Any entry can be restored.
+ *
+ * The chain is intended to be used for taking snapshots on a regular basis,
+ * e.g., once per frame. Once the capacity is exceeded, the base is merged with
+ * the first delta which keeps the memory footprint bounded.
+ */
+class SnapshotChain : public AmigaObject {
+
+    struct Entry {
+
+        // Frame in which the entry has been recorded
+        i64 frame;
+
+        // Serialized emulator state (without memory contents)
+        std::vector<u8> state;
+
+        // Numbers of the recorded memory pages (in ascending order)
+        std::vector<u32> pages;
+
+        // Contents of the recorded memory pages (dirtyPageSize bytes each)
+        std::vector<u8> data;
+    };
+
+    // Reference to the connected Amiga
+    Amiga &amiga;
+
+    // The recorded states
+    std::deque<Entry> entries;
+
+    // Number of memory pages of each memory type (see Memory::getPageLayout)
+    std::vector<isize> layout;
+
+    // Maximum number of entries
+    isize capacity = 300;
+
+    // The entry matching the current emulator state (or -1 if unknown)
+    isize current = -1;
+
+
+    //
+    // Initializing
+    //
+
+public:
+
+    SnapshotChain(Amiga &ref) : amiga(ref) { }
+
+    const char *getDescription() const override { return "SnapshotChain"; }
+
+    // Removes all entries
+    void clear();
+
+
+    //
+    // Configuring
+    //
+
+public:
+
+    isize getCapacity() const { return capacity; }
+    void setCapacity(isize value);
+
+
+    //
+    // Analyzing
+    //
+
+public:
+
+    // Returns the number of recorded entries
+    isize count() const { return (isize)entries.size(); }
+
+    // Returns the frame in which a certain entry has been recorded
+    i64 frame(isize nr) const { return entries[nr].frame; }
+
+    // Returns the number of memory pages stored in a certain entry
+    isize pageCount(isize nr) const { return (isize)entries[nr].pages.size(); }
+
+    // Returns the number of bytes occupied by all entries
+    isize memoryUsage() const;
+
+
+    //
+    // Recording and restoring
+    //
+
+public:
+
+    /* Records the current emulator state. If an older entry has been restored
+     * before, all entries following this entry are discarded. If the memory
+     * layout has changed since the base has been recorded, i.e., if the size
+     * of any memory type differs, the chain is cleared and a new base is
+     * recorded.
+     */
+    void record();
+
+    // Restores the emulator state stored in a certain entry
+    void restore(isize nr) throws;
+
+private:
+
+    // Serializes all components except the memory contents
+    void saveState(std::vector<u8> &buffer);
+
+    // Merges the base with the first delta
+    void dropBase();
+};
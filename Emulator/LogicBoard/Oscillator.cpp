@@ -9,8 +9,9 @@
 
 #include "config.h"
 #include "Oscillator.h"
-#include "Agnus.h"
+#include "Amiga.h"
 #include "Chrono.h"
+#include "IO.h"
 
 const double Oscillator::masterClockFrequency = 28.37516;
 const double Oscillator::cpuClockFrequency = masterClockFrequency / 4.0;
@@ -18,7 +19,10 @@ const double Oscillator::dmaClockFrequency = masterClockFrequency / 8.0;
 
 Oscillator::Oscillator(Amiga& ref) : AmigaComponent(ref)
 {
-
+    config.warpDisk = false;
+    config.warpScript = false;
+    config.warpBoot = false;
+    config.warpDelay = 50;
 }
     
 const char *
@@ -44,6 +48,92 @@ Oscillator::_reset(bool hard)
 
     if (hard) {
         
+        bootPhase = true;
+    }
+}
+
+i64
+Oscillator::getConfigItem(Option option) const
+{
+    switch (option) {
+            
+        case OPT_WARP_DISK:    return config.warpDisk;
+        case OPT_WARP_SCRIPT:  return config.warpScript;
+        case OPT_WARP_BOOT:    return config.warpBoot;
+        case OPT_WARP_DELAY:   return config.warpDelay;
+            
+        default:
+            assert(false);
+            return 0;
+    }
+}
+
+bool
+Oscillator::setConfigItem(Option option, i64 value)
+{
+    switch (option) {
+            
+        case OPT_WARP_DISK:
+            
+            if (config.warpDisk == (bool)value) return false;
+            config.warpDisk = value;
+            return true;
+            
+        case OPT_WARP_SCRIPT:
+            
+            if (config.warpScript == (bool)value) return false;
+            config.warpScript = value;
+            return true;
+            
+        case OPT_WARP_BOOT:
+            
+            if (config.warpBoot == (bool)value) return false;
+            config.warpBoot = value;
+            return true;
+            
+        case OPT_WARP_DELAY:
+            
+            if (value < 0) throw VAError(ERROR_OPT_INVALID_ARG, "0, 1, 2, ...");
+            if (config.warpDelay == value) return false;
+            config.warpDelay = value;
+            return true;
+            
+        default:
+            return false;
+    }
+}
+
+void
+Oscillator::_dump(dump::Category category, std::ostream& os) const
+{
+    using namespace util;
+    
+    if (category & dump::Config) {
+        
+        os << tab("Warp on disk access");
+        os << bol(config.warpDisk) << std::endl;
+        os << tab("Warp on script wait");
+        os << bol(config.warpScript) << std::endl;
+        os << tab("Warp during boot");
+        os << bol(config.warpBoot) << std::endl;
+        os << tab("Warp delay");
+        os << dec(config.warpDelay) << " frames" << std::endl;
+    }
+    
+    if (category & dump::State) {
+        
+        os << tab("Warp mode");
+        os << bol(warpMode) << std::endl;
+        os << tab("Automatic warp");
+        os << bol(autoWarp) << std::endl;
+        os << tab("Manual override");
+        os << bol(manualOverride) << std::endl;
+        os << tab("Warp countdown");
+        os << dec(warpCountdown) << " frames" << std::endl;
+        os << tab("Boot phase");
+        os << bol(bootPhase) << std::endl;
+        os << tab("CPU load");
+        os << dec((isize)(cpuLoad * 100)) << "%" << std::endl;
     }
 }
 
@@ -108,3 +198,52 @@ Oscillator::synchronize()
         nonstopClock.restart();
     }
 }
+
+void
+Oscillator::updateWarpMode()
+{
+    if (warpConditionMet()) {
+        
+        warpCountdown = config.warpDelay;
+        
+        if (!warpMode && !autoWarp && !manualOverride) {
+            
+            autoWarp = true;
+            amiga.signalWarpOn();
+        }
+        
+    } else if (manualOverride) {
+        
+        // The condition has vanished. Hand control back to the policy
+        manualOverride = false;
+        
+    } else if (autoWarp) {
+        
+        if (warpCountdown > 0) {
+            
+            warpCountdown--;
+            
+        } else {
+            
+            autoWarp = false;
+            amiga.signalWarpOff();
+        }
+    }
+}
+
+bool
+Oscillator::warpConditionMet() const
+{
+    if (config.warpBoot && bootPhase) {
+        return true;
+    }
+    if (config.warpScript && retroShell.isWaiting()) {
+        return true;
+    }
+    if (config.warpDisk) {
+        
+        if (diskController.getState() != DRIVE_DMA_OFF) return true;
+        for (isize i = 0; i < 4; i++) if (df[i]->getMotor()) return true;
+    }
+    return false;
+}
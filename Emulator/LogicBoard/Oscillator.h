@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include "OscillatorTypes.h"
 #include "AmigaComponent.h"
 #include "Chrono.h"
 
@@ -31,6 +32,9 @@ public:
 
 private:
     
+    // Current configuration
+    OscillatorConfig config;
+    
     /* The heart of this class is method sychronize() which puts the thread to
      * sleep for a certain interval. In order to calculate the delay, the
      * function needs to know the values of the Amiga clock and the Kernel
@@ -53,6 +57,21 @@ private:
     // Clocks for measuring the CPU load
     util::Clock nonstopClock;
     util::Clock loadClock;
+    
+    /* Warp policy state. Warp mode is switched on as soon as one of the
+     * enabled warp conditions is met and switched off after the conditions
+     * have vanished for 'warpDelay' frames. The delay prevents the emulator
+     * from toggling warp mode rapidly which would cause the audio stream to
+     * stutter. Warp mode is only switched off automatically if it has been
+     * switched on automatically. If the user changes warp mode manually, the
+     * policy is suspended until the triggering conditions have vanished.
+     */
+    bool autoWarp = false;
+    bool manualOverride = false;
+    isize warpCountdown = 0;
+    
+    // Indicates that no user input has been received since the last hard reset
+    bool bootPhase = true;
 
     
     //
@@ -71,6 +90,27 @@ private:
     void _reset(bool hard) override;
     
     
+    //
+    // Configuring
+    //
+    
+public:
+    
+    const OscillatorConfig &getConfig() const { return config; }
+    
+    i64 getConfigItem(Option option) const;
+    bool setConfigItem(Option option, i64 value) override;
+    
+    
+    //
+    // Analyzing
+    //
+    
+private:
+    
+    void _dump(dump::Category category, std::ostream& os) const override;
+    
+    
     //
     // Serializing
     //
@@ -113,4 +153,27 @@ public:
     // Getter for the reference time
     util::Time getTimeBase() { return timeBase; }
     
+    
+    //
+    // Managing warp mode
+    //
+    
+public:
+    
+    // Evaluates the warp policies (called once per frame)
+    void updateWarpMode();
+    
+    // Informs the oscillator about user input (ends the boot phase)
+    void userInput() { bootPhase = false; }
+    
+    // Informs the oscillator that warp mode has been changed manually
+    void manualWarp() { autoWarp = false; manualOverride = true; }
+    
+    // Indicates if warp mode has been switched on by the warp policy
+    bool inAutoWarp() const { return autoWarp; }
+    
+private:
+    
+    // Checks whether one of the enabled warp conditions is met
+    bool warpConditionMet() const;
 };
@@ -0,0 +1,32 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+
+//
+// Structures
+//
+
+typedef struct
+{
+    // Enables warp mode while a disk is accessed
+    bool warpDisk;
+
+    // Enables warp mode while a RetroShell script is waiting
+    bool warpScript;
+
+    // Enables warp mode after a hard reset until the first user input
+    bool warpBoot;
+
+    // Number of frames warp mode is kept after all warp conditions vanished
+    isize warpDelay;
+}
+OscillatorConfig;
@@ -9,6 +9,7 @@
 
 #include "config.h"
 #include "ZorroManager.h"
+#include "HdController.h"
 #include "Memory.h"
 
 ZorroManager::ZorroManager(Amiga& ref) : AmigaComponent(ref)
@@ -21,6 +22,34 @@ ZorroManager::_initialize()
     
 }
 
+u8
+ZorroManager::peekACF(u32 addr) const
+{
+    if (mem.fastRamSize() && !fastRamConf) return peekFastRamDevice(addr);
+    if (hdController.isAttached() && !hdController.isConfigured()) {
+        return hdController.peekACF(addr);
+    }
+    return 0xF;
+}
+
+u8
+ZorroManager::spypeekACF(u32 addr) const
+{
+    return peekACF(addr);
+}
+
+void
+ZorroManager::pokeACF(u32 addr, u8 value)
+{
+    if (mem.fastRamSize() && !fastRamConf) {
+        pokeFastRamDevice(addr, value);
+        return;
+    }
+    if (hdController.isAttached() && !hdController.isConfigured()) {
+        hdController.pokeACF(addr, value);
+    }
+}
+
 u8
 ZorroManager::peekFastRamDevice(u32 addr) const
 {
@@ -72,6 +72,21 @@ public:
     isize _save(u8 *buffer) override { SAVE_SNAPSHOT_ITEMS }
 
         
+    //
+    // Accessing the autoconfig space
+    //
+    
+public:
+    
+    /* Forwards an autoconfig access to the first unconfigured board. Boards
+     * are chained in a fixed order: Fast Ram first, hard drive controller
+     * second.
+     */
+    u8 peekACF(u32 addr) const;
+    u8 spypeekACF(u32 addr) const;
+    void pokeACF(u32 addr, u8 value);
+
+    
     //
     // Emulating Fast Ram
     //
@@ -40,6 +40,9 @@ Memory::dealloc()
     if (chip) { delete[] chip; chip = nullptr; }
     if (slow) { delete[] slow; slow = nullptr; }
     if (fast) { delete[] fast; fast = nullptr; }
+    
+    // Make sure that the CPU won't access any deleted memory directly
+    updateCpuPageTables();
 }
 
 void
@@ -245,13 +248,16 @@ Memory::_size()
     << config.slowSize
     << config.fastSize;
     
-    counter.count += config.romSize;
-    counter.count += config.womSize;
-    counter.count += config.extSize;
-    counter.count += config.chipSize;
-    counter.count += config.slowSize;
-    counter.count += config.fastSize;
-
+    if (serializeContents) {
+        
+        counter.count += config.romSize;
+        counter.count += config.womSize;
+        counter.count += config.extSize;
+        counter.count += config.chipSize;
+        counter.count += config.slowSize;
+        counter.count += config.fastSize;
+    }
+    
     return counter.count;
 }
 
@@ -259,7 +265,8 @@ isize
 Memory::didLoadFromBuffer(const u8 *buffer)
 {
     util::SerReader reader(buffer);
-
+    MemoryConfig old = config;
+    
     // Load memory size information
     reader
     << config.romSize
@@ -277,6 +284,16 @@ Memory::didLoadFromBuffer(const u8 *buffer)
     if (config.slowSize > KB(512)) { config.slowSize = 0; assert(false); }
     if (config.fastSize > MB(8)) { config.fastSize = 0; assert(false); }
 
+    // If no contents are stored, keep the current memory if the layout matches
+    if (!serializeContents &&
+        config.romSize == old.romSize && config.womSize == old.womSize &&
+        config.extSize == old.extSize && config.chipSize == old.chipSize &&
+        config.slowSize == old.slowSize && config.fastSize == old.fastSize) {
+        
+        updateCpuPageTables();
+        return (isize)(reader.ptr - buffer);
+    }
+    
     // Free previously allocated memory
     dealloc();
 
@@ -289,13 +306,20 @@ Memory::didLoadFromBuffer(const u8 *buffer)
     if (config.fastSize) fast = new (std::nothrow) u8[config.fastSize];
 
     // Load memory contents from buffer
-    reader.copy(rom, config.romSize);
-    reader.copy(wom, config.womSize);
-    reader.copy(ext, config.extSize);
-    reader.copy(chip, config.chipSize);
-    reader.copy(slow, config.slowSize);
-    reader.copy(fast, config.fastSize);
-
+    if (serializeContents) {
+        
+        reader.copy(rom, config.romSize);
+        reader.copy(wom, config.womSize);
+        reader.copy(ext, config.extSize);
+        reader.copy(chip, config.chipSize);
+        reader.copy(slow, config.slowSize);
+        reader.copy(fast, config.fastSize);
+    }
+    
+    // Redirect the host pointer tables to the new memory
+    updateCpuPageTables();
+    markAllPagesDirty();
+    
     return (isize)(reader.ptr - buffer);
 }
 
@@ -313,12 +337,15 @@ Memory::didSaveToBuffer(u8 *buffer) const
     << config.fastSize;
     
     // Save memory contents
-    writer.copy(rom, config.romSize);
-    writer.copy(wom, config.womSize);
-    writer.copy(ext, config.extSize);
-    writer.copy(chip, config.chipSize);
-    writer.copy(slow, config.slowSize);
-    writer.copy(fast, config.fastSize);
+    if (serializeContents) {
+        
+        writer.copy(rom, config.romSize);
+        writer.copy(wom, config.womSize);
+        writer.copy(ext, config.extSize);
+        writer.copy(chip, config.chipSize);
+        writer.copy(slow, config.slowSize);
+        writer.copy(fast, config.fastSize);
+    }
     
     return (isize)(writer.ptr - buffer);
 }
@@ -505,6 +532,8 @@ Memory::fillRamWithInitPattern()
         default:
             assert(false);
     }
+    
+    markAllPagesDirty();
 }
 
 u32
@@ -601,6 +630,7 @@ Memory::loadRom(RomFile *file)
     // Load Rom
     assert(config.romSize == file->size);
     file->flash(rom);
+    markAllPagesDirty();
 
     // Add a Wom if a Boot Rom is installed instead of a Kickstart Rom
     hasBootRom() ? (void)allocWom(KB(256)) : deleteWom();
@@ -636,6 +666,7 @@ Memory::loadExt(ExtendedRomFile *file)
     // Load Rom
     assert(config.extSize == file->size);
     file->flash(ext);
+    markAllPagesDirty();
 }
 
 void
@@ -783,6 +814,11 @@ Memory::updateCpuMemSrcTable()
         assert(cpuMemSrc[i] == MEM_NONE);
     }
     
+    // Zorro II boards
+    if (hdController.isConfigured()) {
+        cpuMemSrc[hdController.getBaseAddr() >> 16] = MEM_ZOR;
+    }
+    
     // Unmapped or Extended Rom
     if (ext && config.extStart == 0xF0) {
         for (isize i = 0xF0; i <= 0xF7; i++) {
@@ -807,9 +843,185 @@ Memory::updateCpuMemSrcTable()
             cpuMemSrc[i] = cpuMemSrc[0xF8 + i];
     }
 
+    updateCpuPageTables();
+    
     messageQueue.put(MSG_MEM_LAYOUT);
 }
 
+void
+Memory::updateCpuPageTables()
+{
+    updateDirtyPageTable();
+    
+    for (isize i = 0x00; i <= 0xFF; i++) {
+        
+        u32 addr = (u32)(i << 16);
+        
+        cpuReadPage[i] = nullptr;
+        cpuWritePage[i] = nullptr;
+        cpuReadCounter[i] = nullptr;
+        cpuWriteCounter[i] = nullptr;
+        cpuWriteDirty[i] = nullptr;
+
+        switch (cpuMemSrc[i]) {
+                
+            case MEM_FAST:
+                
+                if (!fast || addr - FAST_RAM_STRT >= (u32)config.fastSize) break;
+                cpuReadPage[i] = fast + (addr - FAST_RAM_STRT);
+                cpuWritePage[i] = cpuReadPage[i];
+                cpuReadCounter[i] = &stats.fastReads.raw;
+                cpuWriteCounter[i] = &stats.fastWrites.raw;
+                cpuWriteDirty[i] = fastDirty + ((addr - FAST_RAM_STRT) >> dirtyPageShift);
+                break;
+
+            case MEM_ROM:
+            case MEM_ROM_MIRROR:
+                
+                // Writing into Rom space has side effects (locks the Wom)
+                if (!rom || romMask < 0xFFFF) break;
+                cpuReadPage[i] = rom + (addr & romMask);
+                cpuReadCounter[i] = &stats.kickReads.raw;
+                break;
+                
+            case MEM_WOM:
+                
+                if (!wom || womMask < 0xFFFF) break;
+                cpuReadPage[i] = wom + (addr & womMask);
+                cpuReadCounter[i] = &stats.kickReads.raw;
+                if (!womIsLocked) {
+                    cpuWritePage[i] = cpuReadPage[i];
+                    cpuWriteCounter[i] = &stats.kickWrites.raw;
+                    cpuWriteDirty[i] = womDirty + ((addr & womMask) >> dirtyPageShift);
+                }
+                break;
+                
+            case MEM_EXT:
+                
+                if (!ext || extMask < 0xFFFF) break;
+                cpuReadPage[i] = ext + (addr & extMask);
+                cpuReadCounter[i] = &stats.kickReads.raw;
+                break;
+                
+            default:
+                break;
+        }
+    }
+}
+
+void
+Memory::updateDirtyPageTable()
+{
+    u8 *base[6] = { rom, wom, ext, chip, slow, fast };
+    i32 size[6] = {
+        config.romSize, config.womSize, config.extSize,
+        config.chipSize, config.slowSize, config.fastSize };
+    u8 **dirty[6] = {
+        &romDirty, &womDirty, &extDirty, &chipDirty, &slowDirty, &fastDirty };
+    
+    // Compute the number of pages of each memory type
+    std::vector<isize> count(6);
+    isize total = 0;
+    for (isize i = 0; i < 6; i++) {
+        
+        count[i] = base[i] ? (size[i] + dirtyPageSize - 1) >> dirtyPageShift : 0;
+        total += count[i];
+    }
+    
+    // Start from scratch if the memory layout has changed
+    if (count != pageLayout) {
+        
+        pageLayout = count;
+        dirtyPages.assign(total, 1);
+    }
+    
+    // Let each memory type point to its first dirty flag
+    for (isize i = 0, offset = 0; i < 6; offset += count[i++]) {
+        *dirty[i] = dirtyPages.data() + offset;
+    }
+}
+
+void
+Memory::markAllPagesDirty()
+{
+    std::fill(dirtyPages.begin(), dirtyPages.end(), 1);
+}
+
+void
+Memory::clearDirtyPages()
+{
+    std::fill(dirtyPages.begin(), dirtyPages.end(), 0);
+}
+
+u8 *
+Memory::pageAddr(isize page, isize &bytes)
+{
+    u8 *base[6] = { rom, wom, ext, chip, slow, fast };
+    i32 size[6] = {
+        config.romSize, config.womSize, config.extSize,
+        config.chipSize, config.slowSize, config.fastSize };
+    
+    for (isize i = 0; i < 6; i++) {
+        
+        if (!base[i]) continue;
+        
+        isize count = (size[i] + dirtyPageSize - 1) >> dirtyPageShift;
+        if (page < count) {
+            
+            isize offset = page << dirtyPageShift;
+            bytes = std::min(dirtyPageSize, size[i] - offset);
+            return base[i] + offset;
+        }
+        page -= count;
+    }
+    
+    assert(false);
+    bytes = 0;
+    return nullptr;
+}
+
+u8 *
+Memory::ramPtr(u32 addr, isize count, bool write)
+{
+    if (count <= 0 || addr > 0xFFFFFF || count > 0x1000000 - addr) return nullptr;
+    
+    u8 *base, *dirty;
+    u32 offset;
+    i32 size;
+    
+    switch (cpuMemSrc[addr >> 16]) {
+            
+        case MEM_CHIP:
+            
+            base = chip; dirty = chipDirty; offset = addr; size = config.chipSize;
+            break;
+            
+        case MEM_SLOW:
+            
+            base = slow; dirty = slowDirty; offset = addr - 0xC00000; size = config.slowSize;
+            break;
+            
+        case MEM_FAST:
+            
+            base = fast; dirty = fastDirty; offset = addr - FAST_RAM_STRT; size = config.fastSize;
+            break;
+            
+        default:
+            return nullptr;
+    }
+    
+    if (!base || offset + count > (u32)size) return nullptr;
+
+    if (write) {
+        
+        isize first = offset >> dirtyPageShift;
+        isize last = (offset + count - 1) >> dirtyPageShift;
+        for (isize i = first; i <= last; i++) dirty[i] = 1;
+    }
+    
+    return base + offset;
+}
+
 void
 Memory::updateAgnusMemSrcTable()
 {
@@ -1043,7 +1255,7 @@ Memory::peek8 <ACCESSOR_CPU, MEM_AUTOCONF> (u32 addr)
         return dataBus;
     }
     
-    dataBus = zorro.peekFastRamDevice(addr) << 4;
+    dataBus = zorro.peekACF(addr) << 4;
     trace(FAS_DEBUG, "peek8<AUTOCONF>(%x) = %x\n", addr, dataBus);
     return dataBus;
 }
@@ -1055,8 +1267,8 @@ Memory::peek16 <ACCESSOR_CPU, MEM_AUTOCONF> (u32 addr)
     
     // agnus.executeUntilBusIsFree();
     
-    u8 hi = zorro.peekFastRamDevice(addr) << 4;
-    u8 lo = zorro.peekFastRamDevice(addr + 1) << 4;
+    u8 hi = zorro.peekACF(addr) << 4;
+    u8 lo = zorro.peekACF(addr + 1) << 4;
     
     dataBus = HI_LO(hi,lo);
     trace(FAS_DEBUG, "peek16<AUTOCONF>(%x) = %x\n", addr, dataBus);
@@ -1066,12 +1278,32 @@ Memory::peek16 <ACCESSOR_CPU, MEM_AUTOCONF> (u32 addr)
 template<> u16
 Memory::spypeek16 <ACCESSOR_CPU, MEM_AUTOCONF> (u32 addr) const
 {
-    u8 hi = zorro.spypeekFastRamDevice(addr) << 4;
-    u8 lo = zorro.spypeekFastRamDevice(addr + 1) << 4;
+    u8 hi = zorro.spypeekACF(addr) << 4;
+    u8 lo = zorro.spypeekACF(addr + 1) << 4;
     
     return HI_LO(hi,lo);
 }
 
+template<> u8
+Memory::peek8 <ACCESSOR_CPU, MEM_ZOR> (u32 addr)
+{
+    dataBus = hdController.peek8(addr);
+    return dataBus;
+}
+
+template<> u16
+Memory::peek16 <ACCESSOR_CPU, MEM_ZOR> (u32 addr)
+{
+    dataBus = hdController.peek16(addr);
+    return dataBus;
+}
+
+template<> u16
+Memory::spypeek16 <ACCESSOR_CPU, MEM_ZOR> (u32 addr) const
+{
+    return hdController.peek16(addr);
+}
+
 template<> u8
 Memory::peek8 <ACCESSOR_CPU, MEM_ROM> (u32 addr)
 {
@@ -1163,6 +1395,7 @@ Memory::peek8 <ACCESSOR_CPU> (u32 addr)
         case MEM_CUSTOM:        result = peek8 <ACCESSOR_CPU, MEM_CUSTOM>   (addr); break;
         case MEM_CUSTOM_MIRROR: result = peek8 <ACCESSOR_CPU, MEM_CUSTOM>   (addr); break;
         case MEM_AUTOCONF:      result = peek8 <ACCESSOR_CPU, MEM_AUTOCONF> (addr); break;
+        case MEM_ZOR:           result = peek8 <ACCESSOR_CPU, MEM_ZOR>      (addr); break;
         case MEM_ROM:           result = peek8 <ACCESSOR_CPU, MEM_ROM>      (addr); break;
         case MEM_ROM_MIRROR:    result = peek8 <ACCESSOR_CPU, MEM_ROM>      (addr); break;
         case MEM_WOM:           result = peek8 <ACCESSOR_CPU, MEM_WOM>      (addr); break;
@@ -1195,6 +1428,7 @@ Memory::peek16 <ACCESSOR_CPU> (u32 addr)
         case MEM_CUSTOM:        result = peek16 <ACCESSOR_CPU, MEM_CUSTOM>   (addr); break;
         case MEM_CUSTOM_MIRROR: result = peek16 <ACCESSOR_CPU, MEM_CUSTOM>   (addr); break;
         case MEM_AUTOCONF:      result = peek16 <ACCESSOR_CPU, MEM_AUTOCONF> (addr); break;
+        case MEM_ZOR:           result = peek16 <ACCESSOR_CPU, MEM_ZOR>      (addr); break;
         case MEM_ROM:           result = peek16 <ACCESSOR_CPU, MEM_ROM>      (addr); break;
         case MEM_ROM_MIRROR:    result = peek16 <ACCESSOR_CPU, MEM_ROM>      (addr); break;
         case MEM_WOM:           result = peek16 <ACCESSOR_CPU, MEM_WOM>      (addr); break;
@@ -1227,6 +1461,7 @@ Memory::spypeek16 <ACCESSOR_CPU> (u32 addr) const
         case MEM_CUSTOM:        return spypeek16 <ACCESSOR_CPU, MEM_CUSTOM>   (addr);
         case MEM_CUSTOM_MIRROR: return spypeek16 <ACCESSOR_CPU, MEM_CUSTOM>   (addr);
         case MEM_AUTOCONF:      return spypeek16 <ACCESSOR_CPU, MEM_AUTOCONF> (addr);
+        case MEM_ZOR:           return spypeek16 <ACCESSOR_CPU, MEM_ZOR>      (addr);
         case MEM_ROM:           return spypeek16 <ACCESSOR_CPU, MEM_ROM>      (addr);
         case MEM_ROM_MIRROR:    return spypeek16 <ACCESSOR_CPU, MEM_ROM>      (addr);
         case MEM_WOM:           return spypeek16 <ACCESSOR_CPU, MEM_WOM>      (addr);
@@ -1489,7 +1724,7 @@ Memory::poke8 <ACCESSOR_CPU, MEM_AUTOCONF> (u32 addr, u8 value)
     // agnus.executeUntilBusIsFree();
     
     dataBus = value;
-    zorro.pokeFastRamDevice(addr, value);
+    zorro.pokeACF(addr, value);
 }
 
 template <> void
@@ -1500,8 +1735,22 @@ Memory::poke16 <ACCESSOR_CPU, MEM_AUTOCONF> (u32 addr, u16 value)
     // agnus.executeUntilBusIsFree();
 
     dataBus = value;
-    zorro.pokeFastRamDevice(addr, HI_BYTE(value));
-    zorro.pokeFastRamDevice(addr + 1, LO_BYTE(value));
+    zorro.pokeACF(addr, HI_BYTE(value));
+    zorro.pokeACF(addr + 1, LO_BYTE(value));
+}
+
+template <> void
+Memory::poke8 <ACCESSOR_CPU, MEM_ZOR> (u32 addr, u8 value)
+{
+    dataBus = value;
+    hdController.poke8(addr, value);
+}
+
+template <> void
+Memory::poke16 <ACCESSOR_CPU, MEM_ZOR> (u32 addr, u16 value)
+{
+    dataBus = value;
+    hdController.poke16(addr, value);
 }
 
 template <> void
@@ -1581,6 +1830,7 @@ Memory::poke8 <ACCESSOR_CPU> (u32 addr, u8 value)
         case MEM_CUSTOM:        poke8 <ACCESSOR_CPU, MEM_CUSTOM>   (addr, value); return;
         case MEM_CUSTOM_MIRROR: poke8 <ACCESSOR_CPU, MEM_CUSTOM>   (addr, value); return;
         case MEM_AUTOCONF:      poke8 <ACCESSOR_CPU, MEM_AUTOCONF> (addr, value); return;
+        case MEM_ZOR:           poke8 <ACCESSOR_CPU, MEM_ZOR>      (addr, value); return;
         case MEM_ROM:           poke8 <ACCESSOR_CPU, MEM_ROM>      (addr, value); return;
         case MEM_ROM_MIRROR:    poke8 <ACCESSOR_CPU, MEM_ROM>      (addr, value); return;
         case MEM_WOM:           poke8 <ACCESSOR_CPU, MEM_WOM>      (addr, value); return;
@@ -1626,6 +1876,7 @@ Memory::poke16 <ACCESSOR_CPU> (u32 addr, u16 value)
         case MEM_CUSTOM:        poke16 <ACCESSOR_CPU, MEM_CUSTOM>   (addr, value); return;
         case MEM_CUSTOM_MIRROR: poke16 <ACCESSOR_CPU, MEM_CUSTOM>   (addr, value); return;
         case MEM_AUTOCONF:      poke16 <ACCESSOR_CPU, MEM_AUTOCONF> (addr, value); return;
+        case MEM_ZOR:           poke16 <ACCESSOR_CPU, MEM_ZOR>      (addr, value); return;
         case MEM_ROM:           poke16 <ACCESSOR_CPU, MEM_ROM>      (addr, value); return;
         case MEM_ROM_MIRROR:    poke16 <ACCESSOR_CPU, MEM_ROM>      (addr, value); return;
         case MEM_WOM:           poke16 <ACCESSOR_CPU, MEM_WOM>      (addr, value); return;
@@ -71,24 +71,27 @@ assert((x) >= 0xE80000 && (x) <= 0xE8FFFF);
 //
 
 // Writes a value into Chip RAM in big endian format
-#define WRITE_CHIP_8(x,y)  W8BE_ALIGNED (chip + ((x) & chipMask), (y))
-#define WRITE_CHIP_16(x,y) W16BE_ALIGNED(chip + ((x) & chipMask), (y))
+#define WRITE_CHIP_8(x,y)  { MARK_DIRTY(chip, (x) & chipMask); W8BE_ALIGNED (chip + ((x) & chipMask), (y)) }
+#define WRITE_CHIP_16(x,y) { MARK_DIRTY(chip, (x) & chipMask); W16BE_ALIGNED(chip + ((x) & chipMask), (y)) }
 
 // Writes a value into Fast RAM in big endian format
-#define WRITE_FAST_8(x,y)  W8BE_ALIGNED (fast + ((x) - FAST_RAM_STRT), (y))
-#define WRITE_FAST_16(x,y) W16BE_ALIGNED(fast + ((x) - FAST_RAM_STRT), (y))
+#define WRITE_FAST_8(x,y)  { MARK_DIRTY(fast, (x) - FAST_RAM_STRT); W8BE_ALIGNED (fast + ((x) - FAST_RAM_STRT), (y)) }
+#define WRITE_FAST_16(x,y) { MARK_DIRTY(fast, (x) - FAST_RAM_STRT); W16BE_ALIGNED(fast + ((x) - FAST_RAM_STRT), (y)) }
 
 // Writes a value into Slow RAM in big endian format
-#define WRITE_SLOW_8(x,y)  W8BE_ALIGNED (slow + ((x) & slowMask), (y))
-#define WRITE_SLOW_16(x,y) W16BE_ALIGNED(slow + ((x) & slowMask), (y))
+#define WRITE_SLOW_8(x,y)  { MARK_DIRTY(slow, (x) & slowMask); W8BE_ALIGNED (slow + ((x) & slowMask), (y)) }
+#define WRITE_SLOW_16(x,y) { MARK_DIRTY(slow, (x) & slowMask); W16BE_ALIGNED(slow + ((x) & slowMask), (y)) }
 
 // Writes a value into Kickstart WOM in big endian format
-#define WRITE_WOM_8(x,y)  W8BE_ALIGNED (wom + ((x) & womMask), (y))
-#define WRITE_WOM_16(x,y) W16BE_ALIGNED(wom + ((x) & womMask), (y))
+#define WRITE_WOM_8(x,y)  { MARK_DIRTY(wom, (x) & womMask); W8BE_ALIGNED (wom + ((x) & womMask), (y)) }
+#define WRITE_WOM_16(x,y) { MARK_DIRTY(wom, (x) & womMask); W16BE_ALIGNED(wom + ((x) & womMask), (y)) }
 
 // Writes a value into Extended ROM in big endian format
-#define WRITE_EXT_8(x,y)  W8BE_ALIGNED (ext + ((x) & extMask), (y))
-#define WRITE_EXT_16(x,y) W16BE_ALIGNED(ext + ((x) & extMask), (y))
+#define WRITE_EXT_8(x,y)  { MARK_DIRTY(ext, (x) & extMask); W8BE_ALIGNED (ext + ((x) & extMask), (y)) }
+#define WRITE_EXT_16(x,y) { MARK_DIRTY(ext, (x) & extMask); W16BE_ALIGNED(ext + ((x) & extMask), (y)) }
+
+// Marks the page containing a certain memory offset as modified
+#define MARK_DIRTY(type, offset) type##Dirty[(offset) >> dirtyPageShift] = 1
 
 
 class Memory : public AmigaComponent {
@@ -157,6 +160,33 @@ public:
     u32 chipMask = 0;
     u32 slowMask = 0;
     u32 fastMask = 0;
+    
+    /* Dirty page tracking. To support delta snapshots, all memory types are
+     * divided into pages of 4 KB. The pages are numbered consecutively in the
+     * order in which the memory types are serialized (rom, wom, ext, chip,
+     * slow, fast). Whenever a page is written to, its dirty flag is set. The
+     * flags are evaluated and cleared by the SnapshotChain.
+     */
+    static constexpr isize dirtyPageShift = 12;
+    static constexpr isize dirtyPageSize = 1 << dirtyPageShift;
+    std::vector<u8> dirtyPages;
+    
+    // Number of pages of each memory type (in the order given above)
+    std::vector<isize> pageLayout;
+    
+    // Pointers to the first dirty flag of each memory type
+    u8 *romDirty = nullptr;
+    u8 *womDirty = nullptr;
+    u8 *extDirty = nullptr;
+    u8 *chipDirty = nullptr;
+    u8 *slowDirty = nullptr;
+    u8 *fastDirty = nullptr;
+    
+    /* Indicates whether the contents of Rom and Ram are serialized. The flag
+     * is cleared temporarily by the SnapshotChain which records the contents
+     * of all modified memory pages on its own.
+     */
+    bool serializeContents = true;
 
     /* Indicates if the Kickstart Wom is writable. If an Amiga 1000 Boot Rom is
      * installed, a Kickstart WOM (Write Once Memory) is added automatically.
@@ -173,6 +203,24 @@ public:
     MemorySource cpuMemSrc[256];
     MemorySource agnusMemSrc[256];
 
+    /* Host pointer tables for CPU accesses. For all banks mapping in Fast Ram,
+     * Rom, Wom, or Extended Rom, these tables store a pointer to the host
+     * memory backing the bank. These memory types neither have side effects
+     * nor require bus arbitration which is why the CPU can access them
+     * directly (see CPU.cpp). All other entries are nullptr which makes the
+     * CPU fall back to the standard dispatch via cpuMemSrc.
+     * See also: updateCpuPageTables()
+     */
+    u8 *cpuReadPage[256] = { };
+    u8 *cpuWritePage[256] = { };
+    
+    // Statistical counters to be incremented on a direct access
+    long *cpuReadCounter[256] = { };
+    long *cpuWriteCounter[256] = { };
+    
+    // Dirty flags to be set on a direct write access (first flag of the bank)
+    u8 *cpuWriteDirty[256] = { };
+
     // The last value on the data bus
     u16 dataBus;
 
@@ -361,9 +409,9 @@ public:
     bool hasExt() { return ext != nullptr; }
 
     // Erases an installed Rom
-    void eraseRom() { memset(rom, 0, config.romSize); }
-    void eraseWom() { memset(wom, 0, config.womSize); }
-    void eraseExt() { memset(ext, 0, config.extSize); }
+    void eraseRom() { memset(rom, 0, config.romSize); markAllPagesDirty(); }
+    void eraseWom() { memset(wom, 0, config.womSize); markAllPagesDirty(); }
+    void eraseExt() { memset(ext, 0, config.extSize); markAllPagesDirty(); }
     
     // Installs a Boot Rom or Kickstart Rom
     void loadRom(class RomFile *rom) throws;
@@ -398,6 +446,41 @@ private:
 
     void updateCpuMemSrcTable();
     void updateAgnusMemSrcTable();
+    
+    // Updates the host pointer tables according to cpuMemSrc
+    void updateCpuPageTables();
+
+    
+    //
+    // Tracking modifications
+    //
+    
+public:
+    
+    // Returns the total number of memory pages
+    isize pageCount() const { return (isize)dirtyPages.size(); }
+    
+    // Returns the number of pages of each memory type
+    const std::vector<isize> &getPageLayout() const { return pageLayout; }
+    
+    // Checks if a page has been modified since the flags have been cleared
+    bool isDirty(isize page) const { return dirtyPages[page]; }
+    
+    // Sets or clears all dirty flags
+    void markAllPagesDirty();
+    void clearDirtyPages();
+    
+    /* Returns a pointer to the first byte of a memory page. The size of the
+     * page is written into variable bytes. It is smaller than dirtyPageSize
+     * if the size of the corresponding memory type is not a multiple of the
+     * page size.
+     */
+    u8 *pageAddr(isize page, isize &bytes);
+    
+private:
+    
+    // Adjusts the dirty page table to the current memory layout
+    void updateDirtyPageTable();
 
     
     //
@@ -419,6 +502,15 @@ public:
     template <Accessor acc> void poke16(u32 addr, u16 value);
     
 
+    /* Provides direct access to Ram for devices transferring data without
+     * going through the bus (e.g., the hard drive controller). The function
+     * returns a host pointer to the specified block or nullptr if the block
+     * is not entirely backed by Chip Ram, Slow Ram, or Fast Ram. If the block
+     * is going to be written, the affected pages are marked dirty.
+     */
+    u8 *ramPtr(u32 addr, isize count, bool write);
+    
+
     //
     // Accessing the CIA space
     //
@@ -79,3 +79,30 @@ AudioFilter::apply(float sample)
     
     return (float)y0;
 }
+
+void
+AudioFilter::apply(float *buffer, isize count)
+{
+    if (type == FILTER_NONE) return;
+    
+    // Apply butterworth filter
+    assert(type == FILTER_BUTTERWORTH);
+    
+    // Keep the pipeline in local variables while processing the block
+    double x1 = this->x1, x2 = this->x2, y1 = this->y1, y2 = this->y2;
+    
+    for (isize i = 0; i < count; i++) {
+        
+        // Run pipeline
+        double x0 = (double)buffer[i];
+        double y0 = (b0 * x0) + (b1 * x1) + (b2 * x2) + (a1 * y1) + (a2 * y2);
+        
+        // Shift pipeline
+        x2 = x1; x1 = x0;
+        y2 = y1; y1 = y0;
+        
+        buffer[i] = (float)y0;
+    }
+    
+    this->x1 = x1; this->x2 = x2; this->y1 = y1; this->y2 = y2;
+}
@@ -94,4 +94,7 @@ public:
 
     // Inserts a sample into the filter pipeline
     float apply(float sample);
+    
+    // Filters a block of samples in place
+    void apply(float *buffer, isize count);
 };
@@ -13,6 +13,8 @@
 #include "IO.h"
 #include "MsgQueue.h"
 #include "Oscillator.h"
+#include "Profiler.h"
+#include <algorithm>
 #include <cmath>
 
 Muxer::Muxer(Amiga& ref) : AmigaComponent(ref)
@@ -322,6 +324,8 @@ Muxer::rampDown()
 void
 Muxer::synthesize(Cycle clock, Cycle target, long count)
 {
+    PROFILE(PROBE_MUXER);
+    
     assert(target > clock);
     assert(count > 0);
 
@@ -340,6 +344,8 @@ Muxer::synthesize(Cycle clock, Cycle target, long count)
 void
 Muxer::synthesize(Cycle clock, Cycle target)
 {
+    PROFILE(PROBE_MUXER);
+    
     assert(target > clock);
     assert(cyclesPerSample > 0);
     
@@ -357,11 +363,96 @@ Muxer::synthesize(Cycle clock, Cycle target)
     }
 }
 
+void
+Muxer::synthesizeScalar(Cycle clock, Cycle target, long count)
+{
+    assert(target > clock);
+    assert(count > 0);
+
+    // Determine the number of elapsed cycles per audio sample
+    double cyclesPerSample = (double)(target - clock) / (double)count;
+                
+    switch (config.samplingMethod) {
+            
+        case SMP_NONE:    synthesizeScalar<SMP_NONE>   (clock, count, cyclesPerSample); break;
+        case SMP_NEAREST: synthesizeScalar<SMP_NEAREST>(clock, count, cyclesPerSample); break;
+        case SMP_LINEAR:  synthesizeScalar<SMP_LINEAR> (clock, count, cyclesPerSample); break;
+        default:          assert(false);
+    }
+}
+
 template <SamplingMethod method> void
 Muxer::synthesize(Cycle clock, long count, double cyclesPerSample)
 {
     assert(count > 0);
 
+    double cycle = clock;
+    bool filter = ciaa.powerLED() || config.filterAlwaysOn;
+
+    // Compute the contribution of each channel to the left and right output
+    float wl[4], wr[4];
+    for (isize c = 0; c < 4; c++) {
+        
+        wl[c] = vol[c] * (1 - pan[c]);
+        wr[c] = vol[c] * pan[c];
+    }
+    
+    for (long done = 0; done < count;) {
+        
+        isize n = std::min((isize)(count - done), blockSize);
+        
+        // Determine the sampling points
+        for (isize i = 0; i < n; i++) {
+            
+            tagBuffer[i] = (Cycle)cycle;
+            cycle += cyclesPerSample;
+        }
+        
+        // Interpolate all channels
+        for (isize c = 0; c < 4; c++) {
+            sampler[c]->interpolate<method>(tagBuffer, chBuffer[c], n);
+        }
+        
+        // Mix channels
+        for (isize i = 0; i < n; i++) {
+            
+            lBuffer[i] =
+            chBuffer[0][i] * wl[0] + chBuffer[1][i] * wl[1] +
+            chBuffer[2][i] * wl[2] + chBuffer[3][i] * wl[3];
+            
+            rBuffer[i] =
+            chBuffer[0][i] * wr[0] + chBuffer[1][i] * wr[1] +
+            chBuffer[2][i] * wr[2] + chBuffer[3][i] * wr[3];
+        }
+        
+        // Apply audio filter
+        if (filter) { filterL.apply(lBuffer, n); filterR.apply(rBuffer, n); }
+        
+        // Apply master volume
+        for (isize i = 0; i < n; i++) {
+            
+            lBuffer[i] *= volL;
+            rBuffer[i] *= volR;
+        }
+        
+        // Write samples into ringbuffer
+        stream.lock();
+        
+        if (stream.count() + n >= stream.cap()) handleBufferOverflow();
+        for (isize i = 0; i < n; i++) stream.add(lBuffer[i], rBuffer[i]);
+        
+        stream.unlock();
+        
+        stats.producedSamples += n;
+        done += n;
+    }
+}
+
+template <SamplingMethod method> void
+Muxer::synthesizeScalar(Cycle clock, long count, double cyclesPerSample)
+{
+    assert(count > 0);
+
     stream.lock();
     
     // Check for a buffer overflow
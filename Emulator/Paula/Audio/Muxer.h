@@ -70,6 +70,17 @@ class Muxer : public AmigaComponent {
     // Panning factors
     float pan[4];
     
+    /* Intermediate buffers used by synthesize(). Audio samples are generated
+     * in blocks. For each block, the sampling points are computed first and
+     * the four Samplers are interpolated channel by channel. Afterwards, the
+     * channels are mixed, filtered, and written into the audio stream.
+     */
+    static constexpr isize blockSize = 256;
+    Cycle tagBuffer[blockSize];
+    float chBuffer[4][blockSize];
+    float lBuffer[blockSize];
+    float rBuffer[blockSize];
+    
     
     //
     // Sub components
@@ -209,10 +220,18 @@ public:
     void synthesize(Cycle clock, Cycle target, long count);
     void synthesize(Cycle clock, Cycle target);
 
+    /* Reference implementation of synthesize() which processes a single
+     * sample at a time. It is used by the micro benchmarks to verify the
+     * block-based implementation.
+     */
+    void synthesizeScalar(Cycle clock, Cycle target, long count);
+
 private:
 
     template <SamplingMethod method>
     void synthesize(Cycle clock, long count, double cyclesPerSample);
+    template <SamplingMethod method>
+    void synthesizeScalar(Cycle clock, long count, double cyclesPerSample);
     
     // Handles a buffer underflow or overflow condition
     void handleBufferUnderflow();
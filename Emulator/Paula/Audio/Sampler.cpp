@@ -24,39 +24,15 @@ Sampler::clone(Sampler &other)
     *this = other;
 }
 
-template <SamplingMethod method> i16
-Sampler::interpolate(Cycle clock)
+// Interpolates between two adjacent samples
+template <SamplingMethod method> static inline i16
+interpolateBetween(const TaggedSample &e1, const TaggedSample &e2, Cycle clock)
 {
-    assert(!isEmpty());
-
-    isize r1 = r;
-    isize r2 = next(r1);
-
-    // Remove all outdated entries
-    while (r2 != w && elements[r2].tag <= clock) {
-        (void)read();
-        r1 = r2;
-        r2 = next(r1);
-    }
-
-    // If the buffer contains a single element only, return that element
-    if (r2 == w) {
-        return elements[r1].sample;
-    }
-
-    // Interpolate between position r1 and r2
-    Cycle c1 = elements[r1].tag;
-    Cycle c2 = elements[r2].tag;
-    i16 s1 = elements[r1].sample;
-    i16 s2 = elements[r2].sample;
+    Cycle c1 = e1.tag;
+    Cycle c2 = e2.tag;
+    i16 s1 = e1.sample;
+    i16 s2 = e2.sample;
     
-    /*
-    if (!(clock >= c1 && clock < c2)) {
-        warn("WARNING: clock: %lld count: %zu ", clock, count());
-        warn("r: %d w: %d\n", r, w);
-        warn("r1: %d r2: %d c1: %lld c2: %lld\n", r1, r2, c1, c2);
-    }
-    */
     assert(clock >= c1 && clock < c2);
 
     switch (method) {
@@ -86,6 +62,62 @@ Sampler::interpolate(Cycle clock)
     }
 }
 
+template <SamplingMethod method> i16
+Sampler::interpolate(Cycle clock)
+{
+    assert(!isEmpty());
+
+    isize r1 = r;
+    isize r2 = next(r1);
+
+    // Remove all outdated entries
+    while (r2 != w && elements[r2].tag <= clock) {
+        (void)read();
+        r1 = r2;
+        r2 = next(r1);
+    }
+
+    // If the buffer contains a single element only, return that element
+    if (r2 == w) {
+        return elements[r1].sample;
+    }
+
+    // Interpolate between position r1 and r2
+    return interpolateBetween<method>(elements[r1], elements[r2], clock);
+}
+
+template <SamplingMethod method> void
+Sampler::interpolate(const Cycle *clocks, float *samples, isize count)
+{
+    assert(!isEmpty());
+
+    isize r1 = r;
+    isize r2 = next(r1);
+
+    for (isize i = 0; i < count; i++) {
+        
+        assert(i == 0 || clocks[i] >= clocks[i - 1]);
+        
+        // Skip all outdated entries
+        while (r2 != w && elements[r2].tag <= clocks[i]) {
+            r1 = r2;
+            r2 = next(r1);
+        }
+        
+        if (r2 == w) {
+            samples[i] = elements[r1].sample;
+        } else {
+            samples[i] = interpolateBetween<method>(elements[r1], elements[r2], clocks[i]);
+        }
+    }
+    
+    // Remove all outdated entries
+    r = r1;
+}
+
 template i16 Sampler::interpolate<SMP_NONE>(Cycle clock);
 template i16 Sampler::interpolate<SMP_NEAREST>(Cycle clock);
 template i16 Sampler::interpolate<SMP_LINEAR>(Cycle clock);
+template void Sampler::interpolate<SMP_NONE>(const Cycle *, float *, isize);
+template void Sampler::interpolate<SMP_NEAREST>(const Cycle *, float *, isize);
+template void Sampler::interpolate<SMP_LINEAR>(const Cycle *, float *, isize);
@@ -48,4 +48,11 @@ struct Sampler : util::RingBuffer <TaggedSample, VPOS_CNT * HPOS_CNT> {
      * r1 and r1 + 1 based on the requested method.
      */
     template <SamplingMethod method> i16 interpolate(Cycle clock);
+    
+    /* Interpolates a block of sound samples. This function has the same effect
+     * as calling the function above for each element in clocks. The target
+     * cycles must be given in ascending order.
+     */
+    template <SamplingMethod method>
+    void interpolate(const Cycle *clocks, float *samples, isize count);
 };
@@ -15,6 +15,7 @@
 #include "IO.h"
 #include "MsgQueue.h"
 #include "Paula.h"
+#include "Profiler.h"
 #include <algorithm>
 
 DiskController::DiskController(Amiga& ref) : AmigaComponent(ref)
@@ -483,6 +484,8 @@ DiskController::executeFifo()
 void
 DiskController::performDMA()
 {
+    PROFILE(PROBE_DISK);
+    
     Drive *drive = getSelectedDrive();
     
     // Only proceed if there are remaining bytes to process
@@ -649,10 +652,15 @@ DiskController::performTurboDMA(Drive *drive)
 void
 DiskController::performTurboRead(Drive *drive)
 {
-    for (isize i = 0; i < (dsklen & 0x3FFF); i++) {
+    isize count = dsklen & 0x3FFF;
+    
+    // Read all words from disk at once
+    u8 buffer[2 * 0x4000];
+    drive->readBytesAndRotate(buffer, 2 * count);
+    
+    for (isize i = 0; i < count; i++) {
         
-        // Read word from disk
-        u16 word = drive->readWordAndRotate();
+        u16 word = HI_LO(buffer[2 * i], buffer[2 * i + 1]);
         
         // Write word into memory
         if (DSK_CHECKSUM) {
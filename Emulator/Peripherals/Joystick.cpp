@@ -12,6 +12,7 @@
 #include "Agnus.h"
 #include "ControlPort.h"
 #include "IO.h"
+#include "Oscillator.h"
 
 Joystick::Joystick(Amiga& ref, ControlPort& pref) : AmigaComponent(ref), port(pref)
 {
@@ -189,7 +190,10 @@ Joystick::trigger(GamePadAction event)
     assert_enum(GamePadAction, event);
 
     debug(PRT_DEBUG, "trigger(%s)\n", GamePadActionEnum::key(event));
-     
+    
+    // Leave the boot phase (ends warping if requested by the warp policy)
+    oscillator.userInput();
+    
     switch (event) {
             
         case PULL_UP:    axisY = -1; break;
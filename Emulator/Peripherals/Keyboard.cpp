@@ -13,6 +13,7 @@
 #include "CIA.h"
 #include "IO.h"
 #include "MsgQueue.h"
+#include "Oscillator.h"
 
 Keyboard::Keyboard(Amiga& ref) : AmigaComponent(ref)
 {
@@ -115,6 +116,9 @@ Keyboard::pressKey(long keycode)
 {
     assert(keycode < 0x80);
 
+    // Leave the boot phase (ends warping if requested by the warp policy)
+    oscillator.userInput();
+    
     if (!keyDown[keycode] && !queue.isFull()) {
 
         trace(KBD_DEBUG, "Pressing Amiga key %02lX\n", keycode);
@@ -281,6 +281,9 @@ Mouse::trigger(GamePadAction event)
 
     debug(PRT_DEBUG, "trigger(%s)\n", GamePadActionEnum::key(event));
 
+    // Leave the boot phase (ends warping if requested by the warp policy)
+    oscillator.userInput();
+
     switch (event) {
 
         case PRESS_LEFT: setLeftButton(true); break;
@@ -23,14 +23,14 @@ enum class Token
     
     // Components
     agnus, amiga, audio, blitter, cia, controlport, copper, cpu, dc, denise,
-    dfn, dmadebugger, keyboard, memory, monitor, mouse, paula, screenshot,
-    serial, rtc,
+    dfn, dmadebugger, hdn, keyboard, memory, monitor, mouse, paula, profiler,
+    sampler, screenshot, serial, rtc,
 
     // Commands
-    about, audiate, autosync, clear, config, connect, debug, disable,
-    disconnect, dsksync, easteregg, eject, enable, close, hide, init, insert,
-    inspect, list, load, lock, off, on, open, pause, power, reset, run, save,
-    set, show, source, wait,
+    about, attach, audiate, autosync, clear, config, connect, debug, detach,
+    disable, disconnect, dsksync, easteregg, eject, enable, close, hide, init, insert,
+    inspect, list, load, lock, off, on, open, pause, power, record, region, reset,
+    run, save, seglist, set, show, source, start, stop, verify, wait,
     
     // Categories
     checksums, devices, events, registers, state,
@@ -38,11 +38,13 @@ enum class Token
     // Keys
     accuracy, bankmap, bitplanes, brightness, channel, chip, clxsprspr,
     clxsprplf, clxplfplf, color, contrast, cutout, defaultbb, defaultfs, delay,
-    device, disk, esync, extrom, extstart, fast, filename, filter, joystick,
-    keyset, mechanics, mode, model, opacity, palette, pan, path, poll, pullup,
-    raminitpattern, refresh, revision, rom, sampling, saturation, searchpath,
-    shakedetector, slow, slowramdelay, slowrammirror, speed, sprites, step,
-    tod, todbug, unmappingtype, velocity, volume, wom
+    depth, device, disk, esync, extrom, extstart, fast, filename, filter, frames,
+    joystick, keyset, limit, mechanics, mode, model, opacity, palette, pan, path,
+    pc, period, poll, pullup,
+    raminitpattern, refresh, revision, rom, sampling, saturation, scheduler,
+    searchpath, shakedetector, slow, slowramdelay, slowrammirror, speed,
+    sprites, step, sync, tod, todbug, unmappingtype, velocity, volume, warpboot,
+    warpdelay, warpdisk, warpscript, wom
 };
 
 struct TooFewArgumentsError : public util::ParseError {
@@ -41,6 +41,26 @@ Interpreter::registerInstructions()
              "command", "Pauses the execution of a command script",
              &RetroShell::exec <Token::wait>, 2);
 
+    root.add({"wait", "frames"},
+             "command", "Pauses the script for a number of frames",
+             &RetroShell::exec <Token::wait, Token::frames>, 1);
+
+    root.add({"wait", "pc"},
+             "command", "Runs the emulator until the CPU reaches an address",
+             &RetroShell::exec <Token::wait, Token::pc>, 1);
+
+    root.add({"wait", "memory"},
+             "command", "Runs the emulator until a memory cell holds a value",
+             &RetroShell::exec <Token::wait, Token::memory>, 2);
+
+    root.add({"wait", "sync"},
+             "command", "Processes wait commands at maximum speed",
+             &RetroShell::exec <Token::wait, Token::sync>, 1);
+
+    root.add({"wait", "limit"},
+             "command", "Sets the frame limit for conditional wait commands",
+             &RetroShell::exec <Token::wait, Token::limit>, 1);
+
     
     //
     // Amiga
@@ -53,6 +73,29 @@ Interpreter::registerInstructions()
              "command", "Initializes the Amiga with a predefined scheme",
              &RetroShell::exec <Token::amiga, Token::init>, 1);
 
+    root.add({"amiga", "config"},
+             "command", "Displays the current configuration",
+             &RetroShell::exec <Token::amiga, Token::config>);
+
+    root.add({"amiga", "set"},
+             "command", "Configures the component");
+        
+    root.add({"amiga", "set", "warpdisk"},
+             "key", "Enables warp mode while a disk is accessed",
+             &RetroShell::exec <Token::amiga, Token::set, Token::warpdisk>, 1);
+
+    root.add({"amiga", "set", "warpscript"},
+             "key", "Enables warp mode while a script is waiting",
+             &RetroShell::exec <Token::amiga, Token::set, Token::warpscript>, 1);
+
+    root.add({"amiga", "set", "warpboot"},
+             "key", "Enables warp mode until the first user input",
+             &RetroShell::exec <Token::amiga, Token::set, Token::warpboot>, 1);
+
+    root.add({"amiga", "set", "warpdelay"},
+             "key", "Sets the number of frames warp mode is kept",
+             &RetroShell::exec <Token::amiga, Token::set, Token::warpdelay>, 1);
+
     root.add({"amiga", "power"},
              "command", "Switches the Amiga on or off");
     
@@ -258,6 +301,10 @@ Interpreter::registerInstructions()
              "key", "Enables or disables ECS Slow Ram mirroring",
              &RetroShell::exec <Token::agnus, Token::set, Token::slowrammirror>, 1);
 
+    root.add({"agnus", "set", "scheduler"},
+             "key", "Selects the event scheduler",
+             &RetroShell::exec <Token::agnus, Token::set, Token::scheduler>, 1);
+
     root.add({"agnus", "inspect"},
              "command", "Displays the internal state");
 
@@ -846,6 +893,89 @@ Interpreter::registerInstructions()
              "command", "Displays the internal state",
              &RetroShell::exec <Token::dfn, Token::inspect>);
     
+    
+    //
+    // Hd0
+    //
+    
+    root.add({"hd0"},
+             "component", "Hard drive 0");
+
+    root.add({"hd0", "attach"},
+             "command", "Attaches a hard drive image",
+             &RetroShell::exec <Token::hdn, Token::attach>, 1);
+
+    root.add({"hd0", "detach"},
+             "command", "Detaches the hard drive image",
+             &RetroShell::exec <Token::hdn, Token::detach>);
+
+    root.add({"hd0", "inspect"},
+             "command", "Displays the internal state",
+             &RetroShell::exec <Token::hdn, Token::inspect>);
+    
+    
+    //
+    // Profiler
+    //
+    
+    root.add({"profiler"},
+             "component", "Host time profiler");
+
+    root.add({"profiler", "inspect"},
+             "command", "Displays the host time spent in each subsystem",
+             &RetroShell::exec <Token::profiler, Token::inspect>);
+
+    root.add({"profiler", "clear"},
+             "command", "Resets all counters",
+             &RetroShell::exec <Token::profiler, Token::clear>);
+
+    
+    //
+    // Sampler
+    //
+    
+    root.add({"sampler"},
+             "component", "Sampling profiler for the emulated software");
+
+    root.add({"sampler", "start"},
+             "command", "Starts taking samples",
+             &RetroShell::exec <Token::sampler, Token::start>);
+
+    root.add({"sampler", "stop"},
+             "command", "Stops taking samples",
+             &RetroShell::exec <Token::sampler, Token::stop>);
+
+    root.add({"sampler", "clear"},
+             "command", "Discards all samples",
+             &RetroShell::exec <Token::sampler, Token::clear>);
+
+    root.add({"sampler", "set"},
+             "command", "Configures the sampler");
+
+    root.add({"sampler", "set", "period"},
+             "key", "Sets the sampling period in DMA cycles",
+             &RetroShell::exec <Token::sampler, Token::set, Token::period>, 1);
+
+    root.add({"sampler", "set", "depth"},
+             "key", "Sets the number of recorded callers (0 = PC only)",
+             &RetroShell::exec <Token::sampler, Token::set, Token::depth>, 1);
+
+    root.add({"sampler", "region"},
+             "command", "Names an address range (name, start, end)",
+             &RetroShell::exec <Token::sampler, Token::region>, 3);
+
+    root.add({"sampler", "seglist"},
+             "command", "Names all hunks of a segment list (name, BPTR)",
+             &RetroShell::exec <Token::sampler, Token::seglist>, 2);
+
+    root.add({"sampler", "inspect"},
+             "command", "Displays a flat profile",
+             &RetroShell::exec <Token::sampler, Token::inspect>);
+
+    root.add({"sampler", "save"},
+             "command", "Saves all call stacks in folded format",
+             &RetroShell::exec <Token::sampler, Token::save>, 1);
+
     //
     // Screenshots (regression testing)
     //
@@ -868,4 +998,20 @@ Interpreter::registerInstructions()
     root.add({"screenshot", "save"},
              "key", "Saves a screenshot and exits the emulator",
              &RetroShell::exec <Token::screenshot, Token::save>, 1);
+
+    root.add({"screenshot", "record"},
+             "command", "Saves the texture cutout as a reference image",
+             &RetroShell::exec <Token::screenshot, Token::record>, 1);
+
+    root.add({"screenshot", "verify"},
+             "command", "Compares the texture cutout with a reference image or hash",
+             &RetroShell::exec <Token::screenshot, Token::verify>, 2);
+
+    root.add({"screenshot", "inspect"},
+             "command", "Displays all recorded test results",
+             &RetroShell::exec <Token::screenshot, Token::inspect>);
+
+    root.add({"screenshot", "clear"},
+             "command", "Deletes all recorded test results",
+             &RetroShell::exec <Token::screenshot, Token::clear>);
 }
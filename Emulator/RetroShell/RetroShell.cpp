@@ -506,6 +506,32 @@ RetroShell::exec(std::istream &stream)
 }
 */
 
+void
+RetroShell::runUntil(const std::function<bool()> &condition)
+{
+    if (!amiga.isPoweredOn()) {
+        
+        *this << "The Amiga is powered off" << '\n';
+        throw util::Exception("Powered off");
+    }
+    
+    // Take over emulation from the emulator thread
+    bool wasRunning = amiga.isRunning();
+    if (wasRunning) amiga.pause();
+    
+    // Warp mode is restored by the emulation function
+    bool reached = condition();
+
+    // Hand emulation back to the emulator thread
+    if (wasRunning) amiga.run();
+
+    if (!reached) {
+        
+        *this << "Condition not met" << '\n';
+        throw util::Exception("Condition not met");
+    }
+}
+
 void
 RetroShell::dump(HardwareComponent &component, dump::Category category)
 {
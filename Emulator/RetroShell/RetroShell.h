@@ -14,6 +14,7 @@
 
 #include <sstream>
 #include <fstream>
+#include <functional>
 
 class RetroShell : public AmigaComponent {
 
@@ -51,6 +52,16 @@ class RetroShell : public AmigaComponent {
     
     // Wake up cycle for interrupted scripts
     Cycle wakeUp = INT64_MAX;
+    
+    /* Indicates if wait commands are processed synchronously. In this mode,
+     * a wait command emulates the Amiga inside the calling thread at maximum
+     * speed and the script continues right away, without waiting for the
+     * emulator to send a wake up message.
+     */
+    bool synchronous = false;
+    
+    // Maximum number of frames a conditional wait command may take
+    isize waitLimit = 50 * 60;
 
     
     //
@@ -173,6 +184,14 @@ public:
 
     // Continues a previously interrupted script
     void continueScript() throws;
+    
+    // Checks whether a script is waiting for the wake up cycle
+    bool isWaiting() const { return wakeUp != INT64_MAX; }
+
+private:
+    
+    // Lets the Amiga emulate inside the calling thread until a condition holds
+    void runUntil(const std::function<bool()> &condition) throws;
 
     // Prints a textual description of an error in the console
     void describe(const std::exception &exception);
@@ -56,11 +56,68 @@ RetroShell::exec <Token::wait> (Arguments &argv, long param)
     auto seconds = util::parseNum(argv.front());
     
     Cycle limit = agnus.clock + SEC(seconds);
+    
+    if (synchronous) {
+        
+        runUntil([&]() { return amiga.executeUntilCycle(limit); });
+        return;
+    }
+    
     amiga.retroShell.wakeUp = limit;
     
     throw ScriptInterruption("");
 }
 
+template <> void
+RetroShell::exec <Token::wait, Token::frames> (Arguments &argv, long param)
+{
+    auto frames = util::parseNum(argv.front());
+    
+    if (synchronous) {
+        
+        runUntil([&]() { return amiga.executeFrames(frames) == frames; });
+        return;
+    }
+    
+    amiga.retroShell.wakeUp = agnus.clock + frames * DMA_CYCLES(HPOS_CNT * VPOS_CNT);
+    
+    throw ScriptInterruption("");
+}
+
+template <> void
+RetroShell::exec <Token::wait, Token::pc> (Arguments &argv, long param)
+{
+    auto addr = (u32)util::parseNum(argv.front());
+    
+    runUntil([&]() { return amiga.executeUntilPC(addr, waitLimit); });
+}
+
+template <> void
+RetroShell::exec <Token::wait, Token::memory> (Arguments &argv, long param)
+{
+    std::vector<string> vec(argv.begin(), argv.end());
+    
+    auto addr = (u32)util::parseNum(vec[0]);
+    auto value = (u8)util::parseNum(vec[1]);
+    
+    runUntil([&]() { return amiga.executeUntilValue(addr, value, waitLimit); });
+}
+
+template <> void
+RetroShell::exec <Token::wait, Token::sync> (Arguments &argv, long param)
+{
+    synchronous = util::parseBool(argv.front());
+}
+
+template <> void
+RetroShell::exec <Token::wait, Token::limit> (Arguments &argv, long param)
+{
+    auto frames = util::parseNum(argv.front());
+    if (frames < 1) throw VAError(ERROR_OPT_INVALID_ARG, "1, 2, 3, ...");
+    
+    waitLimit = frames;
+}
+
 
 //
 // Amiga
@@ -97,6 +154,36 @@ RetroShell::exec <Token::amiga, Token::debug, Token::off> (Arguments &argv, long
     amiga.debugOff();
 }
 
+template <> void
+RetroShell::exec <Token::amiga, Token::config> (Arguments &argv, long param)
+{
+    dump(amiga.oscillator, dump::Config);
+}
+
+template <> void
+RetroShell::exec <Token::amiga, Token::set, Token::warpdisk> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_WARP_DISK, util::parseBool(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::amiga, Token::set, Token::warpscript> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_WARP_SCRIPT, util::parseBool(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::amiga, Token::set, Token::warpboot> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_WARP_BOOT, util::parseBool(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::amiga, Token::set, Token::warpdelay> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_WARP_DELAY, util::parseNum(argv.front()));
+}
+
 template <> void
 RetroShell::exec <Token::amiga, Token::run> (Arguments &argv, long param)
 {
@@ -327,6 +414,12 @@ RetroShell::exec <Token::agnus, Token::set, Token::slowrammirror> (Arguments &ar
     amiga.configure(OPT_SLOW_RAM_MIRROR, util::parseBool(argv.front()));
 }
 
+template <> void
+RetroShell::exec <Token::agnus, Token::set, Token::scheduler> (Arguments &argv, long param)
+{
+    amiga.configure(OPT_EVENT_SCHEDULER, util::parseEnum <EventSchedulerEnum> (argv.front()));
+}
+
 template <> void
 RetroShell::exec <Token::agnus, Token::inspect, Token::state> (Arguments &argv, long param)
 {
@@ -989,6 +1082,112 @@ RetroShell::exec <Token::dfn, Token::inspect> (Arguments& argv, long param)
 }
 
 
+//
+// Hd0
+//
+
+template <> void
+RetroShell::exec <Token::hdn, Token::attach> (Arguments& argv, long param)
+{
+    amiga.hdController.attach(argv.front());
+}
+
+template <> void
+RetroShell::exec <Token::hdn, Token::detach> (Arguments& argv, long param)
+{
+    amiga.hdController.detach();
+}
+
+template <> void
+RetroShell::exec <Token::hdn, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.hdController, dump::State);
+}
+
+
+//
+// Profiler
+//
+
+template <> void
+RetroShell::exec <Token::profiler, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.profiler, dump::State);
+}
+
+template <> void
+RetroShell::exec <Token::profiler, Token::clear> (Arguments& argv, long param)
+{
+    amiga.profiler.clear();
+}
+
+
+//
+// Sampler
+//
+
+template <> void
+RetroShell::exec <Token::sampler, Token::start> (Arguments& argv, long param)
+{
+    amiga.guestProfiler.start();
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::stop> (Arguments& argv, long param)
+{
+    amiga.guestProfiler.stop();
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::clear> (Arguments& argv, long param)
+{
+    amiga.guestProfiler.clear();
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::set, Token::period> (Arguments& argv, long param)
+{
+    amiga.guestProfiler.setPeriod(util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::set, Token::depth> (Arguments& argv, long param)
+{
+    amiga.guestProfiler.setDepth(util::parseNum(argv.front()));
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::region> (Arguments& argv, long param)
+{
+    std::vector<string> vec(argv.begin(), argv.end());
+    
+    u32 start = (u32)util::parseNum(vec[1]);
+    u32 end = (u32)util::parseNum(vec[2]);
+
+    amiga.guestProfiler.addRegion(vec[0], start, end);
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::seglist> (Arguments& argv, long param)
+{
+    std::vector<string> vec(argv.begin(), argv.end());
+    
+    amiga.guestProfiler.addSegList(vec[0], (u32)util::parseNum(vec[1]));
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::inspect> (Arguments& argv, long param)
+{
+    dump(amiga.guestProfiler, dump::State);
+}
+
+template <> void
+RetroShell::exec <Token::sampler, Token::save> (Arguments& argv, long param)
+{
+    amiga.guestProfiler.exportFolded(argv.front());
+}
+
+
 //
 // Screenshots (regression testing)
 //
@@ -1009,6 +1208,10 @@ RetroShell::exec <Token::screenshot, Token::set, Token::cutout> (Arguments &argv
     isize x2 = util::parseNum(vec[2]);
     isize y2 = util::parseNum(vec[3]);
 
+    if (x1 < 0 || y1 < 0 || x2 > HPIXELS || y2 > VPIXELS || x1 >= x2 || y1 >= y2) {
+        throw VAError(ERROR_OPT_INVALID_ARG);
+    }
+
     amiga.regressionTester.x1 = x1;
     amiga.regressionTester.y1 = y1;
     amiga.regressionTester.x2 = x2;
@@ -1020,3 +1223,33 @@ RetroShell::exec <Token::screenshot, Token::save> (Arguments &argv, long param)
 {
     amiga.regressionTester.dumpTexture(amiga, argv.front());
 }
+
+template <> void
+RetroShell::exec <Token::screenshot, Token::record> (Arguments &argv, long param)
+{
+    amiga.regressionTester.saveReference(amiga, argv.front());
+}
+
+template <> void
+RetroShell::exec <Token::screenshot, Token::verify> (Arguments &argv, long param)
+{
+    std::vector<string> vec(argv.begin(), argv.end());
+    bool passed = amiga.regressionTester.verify(amiga, vec[0], vec[1]);
+
+    *this << vec[0] << (passed ? ": PASS" : ": FAIL") << '\n';
+}
+
+template <> void
+RetroShell::exec <Token::screenshot, Token::inspect> (Arguments &argv, long param)
+{
+    std::stringstream ss; string line;
+
+    amiga.regressionTester.report(ss);
+    while(std::getline(ss, line)) *this << line << '\n';
+}
+
+template <> void
+RetroShell::exec <Token::screenshot, Token::clear> (Arguments &argv, long param)
+{
+    amiga.regressionTester.results.clear();
+}
@@ -0,0 +1,253 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "AviWriter.h"
+
+#include <algorithm>
+
+namespace util {
+
+static u32 fourcc(const char *id)
+{
+    return (u32)id[0] | (u32)id[1] << 8 | (u32)id[2] << 16 | (u32)id[3] << 24;
+}
+
+bool
+AviWriter::open(const string &path, isize width, isize height,
+                isize frameRate, isize sampleRate)
+{
+    close();
+
+    os.open(path, std::ios::binary | std::ios::trunc);
+    if (!os.is_open()) return false;
+
+    this->width = width;
+    this->height = height;
+    this->frameRate = frameRate;
+    this->sampleRate = sampleRate;
+    index.clear();
+    videoFrames = 0;
+    audioSamples = 0;
+    maxChunk = 0;
+
+    u32 frameSize = (u32)(((width * 3 + 3) & ~3) * height);
+
+    putId("RIFF"); put32(0); putId("AVI ");
+
+    // Header list
+    putId("LIST"); put32(294); putId("hdrl");
+
+    // Main header
+    putId("avih"); put32(56);
+    avihPos = os.tellp();
+    put32((u32)(1000000 / frameRate));              // dwMicroSecPerFrame
+    put32((u32)(frameSize * frameRate + 4 * sampleRate));
+    put32(0);                                       // dwPaddingGranularity
+    put32(0x110);                                   // HASINDEX | ISINTERLEAVED
+    put32(0);                                       // dwTotalFrames
+    put32(0);                                       // dwInitialFrames
+    put32(2);                                       // dwStreams
+    put32(0);                                       // dwSuggestedBufferSize
+    put32((u32)width);                              // dwWidth
+    put32((u32)height);                             // dwHeight
+    for (isize i = 0; i < 4; i++) put32(0);         // dwReserved
+
+    // Video stream
+    putId("LIST"); put32(116); putId("strl");
+    putId("strh"); put32(56);
+    vidsPos = os.tellp();
+    putId("vids"); putId("DIB ");
+    put32(0);                                       // dwFlags
+    put16(0); put16(0);                             // wPriority, wLanguage
+    put32(0);                                       // dwInitialFrames
+    put32(1);                                       // dwScale
+    put32((u32)frameRate);                          // dwRate
+    put32(0);                                       // dwStart
+    put32(0);                                       // dwLength
+    put32(frameSize);                               // dwSuggestedBufferSize
+    put32(0xFFFFFFFF);                              // dwQuality
+    put32(0);                                       // dwSampleSize
+    put16(0); put16(0); put16((u16)width); put16((u16)height);
+
+    putId("strf"); put32(40);
+    put32(40);                                      // biSize
+    put32((u32)width);                              // biWidth
+    put32((u32)height);                             // biHeight (bottom-up)
+    put16(1);                                       // biPlanes
+    put16(24);                                      // biBitCount
+    put32(0);                                       // biCompression (BI_RGB)
+    put32(frameSize);                               // biSizeImage
+    for (isize i = 0; i < 4; i++) put32(0);         // Resolution, colors
+
+    // Audio stream
+    putId("LIST"); put32(94); putId("strl");
+    putId("strh"); put32(56);
+    audsPos = os.tellp();
+    putId("auds"); put32(0);
+    put32(0);                                       // dwFlags
+    put16(0); put16(0);                             // wPriority, wLanguage
+    put32(0);                                       // dwInitialFrames
+    put32(4);                                       // dwScale (block align)
+    put32((u32)(4 * sampleRate));                   // dwRate
+    put32(0);                                       // dwStart
+    put32(0);                                       // dwLength
+    put32((u32)(4 * sampleRate / frameRate));       // dwSuggestedBufferSize
+    put32(0xFFFFFFFF);                              // dwQuality
+    put32(4);                                       // dwSampleSize
+    put16(0); put16(0); put16(0); put16(0);
+
+    putId("strf"); put32(18);
+    put16(1);                                       // wFormatTag (PCM)
+    put16(2);                                       // nChannels
+    put32((u32)sampleRate);                         // nSamplesPerSec
+    put32((u32)(4 * sampleRate));                   // nAvgBytesPerSec
+    put16(4);                                       // nBlockAlign
+    put16(16);                                      // wBitsPerSample
+    put16(0);                                       // cbSize
+
+    // Data list
+    putId("LIST"); put32(0);
+    moviPos = os.tellp();
+    putId("movi");
+
+    return os.good();
+}
+
+bool
+AviWriter::writeVideo(const u32 *data, isize pitch)
+{
+    if (!data) return writeChunk(fourcc("00db"), 0, nullptr, 0);
+
+    isize rowSize = (width * 3 + 3) & ~3;
+    line.resize(rowSize * height);
+
+    // Convert RGBA to BGR and flip the image vertically
+    for (isize y = 0; y < height; y++) {
+
+        const u32 *src = data + (height - 1 - y) * pitch;
+        u8 *dst = line.data() + y * rowSize;
+
+        for (isize x = 0; x < width; x++) {
+
+            u32 rgba = src[x];
+            *dst++ = (u8)(rgba >> 16);
+            *dst++ = (u8)(rgba >> 8);
+            *dst++ = (u8)(rgba);
+        }
+    }
+
+    return writeChunk(fourcc("00db"), 0x10, line.data(), (isize)line.size());
+}
+
+bool
+AviWriter::writeAudio(const float *samples, isize count)
+{
+    std::vector<u8> pcm(4 * count);
+
+    for (isize i = 0; i < 2 * count; i++) {
+
+        float s = std::clamp(samples[i], -1.0f, 1.0f);
+        u16 value = (u16)(i16)(s * 32767.0f);
+        pcm[2 * i] = (u8)value;
+        pcm[2 * i + 1] = (u8)(value >> 8);
+    }
+
+    if (!writeChunk(fourcc("01wb"), 0, pcm.data(), (isize)pcm.size())) {
+        return false;
+    }
+    audioSamples += count;
+    return true;
+}
+
+bool
+AviWriter::writeChunk(u32 id, u32 flags, const u8 *data, isize size)
+{
+    if (!os.is_open()) return false;
+
+    std::streamoff pos = os.tellp();
+
+    // Make sure the file stays within 4 GB, including the index
+    u64 end = (u64)pos + 8 + size + 16 * (index.size() + 1) + 8;
+    if (end > 0xFFFFFFFF) return false;
+
+    index.push_back(IndexEntry { id, flags, (u32)(pos - moviPos), (u32)size });
+
+    put32(id);
+    put32((u32)size);
+    if (size) os.write((const char *)data, size);
+    if (size & 1) os.put(0);
+
+    if (id == fourcc("00db")) videoFrames++;
+    maxChunk = std::max(maxChunk, size);
+
+    return os.good();
+}
+
+void
+AviWriter::close()
+{
+    if (!os.is_open()) return;
+
+    // Finish the data list
+    std::streamoff moviEnd = os.tellp();
+    patch32(moviPos - 4, (u32)(moviEnd - moviPos));
+
+    // Write the index
+    putId("idx1");
+    put32((u32)(16 * index.size()));
+    for (auto &entry : index) {
+
+        put32(entry.id);
+        put32(entry.flags);
+        put32(entry.offset);
+        put32(entry.size);
+    }
+
+    // Patch the headers
+    std::streamoff end = os.tellp();
+    patch32(4, (u32)(end - 8));
+    patch32(avihPos + 16, (u32)videoFrames);
+    patch32(avihPos + 28, (u32)maxChunk);
+    patch32(vidsPos + 32, (u32)videoFrames);
+    patch32(audsPos + 32, (u32)audioSamples);
+
+    os.close();
+}
+
+void
+AviWriter::put16(u16 value)
+{
+    os.put((char)(value & 0xFF));
+    os.put((char)(value >> 8));
+}
+
+void
+AviWriter::put32(u32 value)
+{
+    put16((u16)(value & 0xFFFF));
+    put16((u16)(value >> 16));
+}
+
+void
+AviWriter::putId(const char *id)
+{
+    os.write(id, 4);
+}
+
+void
+AviWriter::patch32(std::streamoff pos, u32 value)
+{
+    std::streamoff current = os.tellp();
+    os.seekp(pos);
+    put32(value);
+    os.seekp(current);
+}
+
+}
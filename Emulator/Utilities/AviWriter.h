@@ -0,0 +1,93 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+
+#include <fstream>
+#include <vector>
+
+namespace util {
+
+/* Writes an uncompressed AVI file with a video stream (24 bit RGB) and an
+ * audio stream (16 bit stereo PCM). The file is written sequentially. The
+ * stream headers are patched and the index is appended when the file is
+ * closed. Because AVI uses 32 bit chunk sizes, a file cannot grow beyond
+ * 4 GB. Once this limit would be exceeded, all further data is refused.
+ */
+class AviWriter {
+
+    struct IndexEntry { u32 id; u32 flags; u32 offset; u32 size; };
+
+    // The output stream
+    std::ofstream os;
+
+    // Stream parameters
+    isize width = 0;
+    isize height = 0;
+    isize frameRate = 0;
+    isize sampleRate = 0;
+
+    // File positions of the patched header fields and the 'movi' list
+    std::streamoff avihPos = 0;
+    std::streamoff vidsPos = 0;
+    std::streamoff audsPos = 0;
+    std::streamoff moviPos = 0;
+
+    // Chunk index (written into the 'idx1' chunk)
+    std::vector<IndexEntry> index;
+
+    // Conversion buffer for a single frame
+    std::vector<u8> line;
+
+    // Statistics
+    isize videoFrames = 0;
+    isize audioSamples = 0;
+    isize maxChunk = 0;
+
+public:
+
+    ~AviWriter() { close(); }
+
+    // Creates the file and writes the headers
+    bool open(const string &path, isize width, isize height,
+              isize frameRate, isize sampleRate);
+
+    // Checks whether a file is open
+    bool isOpen() const { return os.is_open(); }
+
+    /* Appends a video frame. The pixel data is expected in the emulator's
+     * texture format (RGBA). If no data is provided, an empty chunk is
+     * written which instructs the player to repeat the previous frame.
+     */
+    bool writeVideo(const u32 *data, isize pitch);
+
+    // Appends interleaved stereo samples in the range [-1;1]
+    bool writeAudio(const float *samples, isize count);
+
+    // Writes the index, patches the headers, and closes the file
+    void close();
+
+    // Returns the number of written frames
+    isize frames() const { return videoFrames; }
+
+private:
+
+    // Appends a chunk to the 'movi' list
+    bool writeChunk(u32 id, u32 flags, const u8 *data, isize size);
+
+    // Helper functions for writing little endian values
+    void put16(u16 value);
+    void put32(u32 value);
+    void putId(const char *id);
+    void patch32(std::streamoff pos, u32 value);
+};
+
+}
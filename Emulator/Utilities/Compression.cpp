@@ -0,0 +1,201 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "Compression.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace util {
+
+// Minimum length of a match
+static constexpr isize minMatch = 4;
+
+// Number of trailing bytes that are always encoded as literals
+static constexpr isize lastLiterals = 5;
+
+// Minimum distance between the start of the last match and the buffer end
+static constexpr isize matchLimit = 12;
+
+// Maximum distance between a match and its reference
+static constexpr isize maxOffset = 0xFFFF;
+
+// Size of the hash table in bits
+static constexpr isize hashBits = 12;
+
+static inline u32
+read32(const u8 *p)
+{
+    u32 result;
+    memcpy(&result, p, sizeof(result));
+    return result;
+}
+
+static inline u32
+hash(u32 value)
+{
+    return (value * 2654435761U) >> (32 - hashBits);
+}
+
+// Writes the extension bytes of a literal or match length
+static inline u8 *
+writeLength(u8 *dst, isize len)
+{
+    for (; len >= 255; len -= 255) *dst++ = 255;
+    *dst++ = (u8)len;
+    return dst;
+}
+
+// Reads the extension bytes of a literal or match length
+static inline bool
+readLength(const u8 *&src, const u8 *end, isize &len)
+{
+    u8 byte;
+    
+    do {
+        if (src >= end) return false;
+        byte = *src++;
+        len += byte;
+    } while (byte == 255);
+    
+    return true;
+}
+
+// Writes a sequence (a run of literals, optionally followed by a match)
+static inline u8 *
+writeSequence(u8 *dst, const u8 *lit, isize litLen, isize offset, isize matchLen)
+{
+    u8 *token = dst++;
+    
+    *token = (u8)(std::min(litLen, (isize)15) << 4);
+    if (litLen >= 15) dst = writeLength(dst, litLen - 15);
+    memcpy(dst, lit, litLen);
+    dst += litLen;
+    
+    if (matchLen) {
+        
+        *dst++ = (u8)(offset & 0xFF);
+        *dst++ = (u8)(offset >> 8);
+        
+        matchLen -= minMatch;
+        *token |= (u8)std::min(matchLen, (isize)15);
+        if (matchLen >= 15) dst = writeLength(dst, matchLen - 15);
+    }
+    
+    return dst;
+}
+
+isize
+lz4Bound(isize len)
+{
+    return len + len / 255 + 16;
+}
+
+isize
+lz4Compress(const u8 *src, isize len, u8 *dst)
+{
+    // Positions of recently seen 4-byte sequences (-1 = empty)
+    std::vector<isize> table(1 << hashBits, -1);
+    
+    const u8 *ip = src;
+    const u8 *anchor = src;
+    const u8 *end = src + len;
+    u8 *op = dst;
+    
+    if (len > matchLimit) {
+        
+        const u8 *limit = end - matchLimit;
+        const u8 *matchEnd = end - lastLiterals;
+        isize misses = 0;
+        
+        while (ip < limit) {
+            
+            u32 value = read32(ip);
+            u32 h = hash(value);
+            isize ref = table[h];
+            table[h] = ip - src;
+            
+            if (ref < 0 || (ip - src) - ref > maxOffset || read32(src + ref) != value) {
+                
+                // Skip faster through incompressible data
+                ip += 1 + (misses++ >> 6);
+                continue;
+            }
+            
+            // Extend the match
+            const u8 *match = src + ref;
+            isize matchLen = minMatch;
+            while (ip + matchLen < matchEnd && ip[matchLen] == match[matchLen]) {
+                matchLen++;
+            }
+            
+            op = writeSequence(op, anchor, ip - anchor, ip - match, matchLen);
+            ip += matchLen;
+            anchor = ip;
+            misses = 0;
+        }
+    }
+    
+    // Write the remaining bytes as literals
+    op = writeSequence(op, anchor, end - anchor, 0, 0);
+    
+    return op - dst;
+}
+
+isize
+lz4Decompress(const u8 *src, isize len, u8 *dst, isize capacity)
+{
+    const u8 *ip = src;
+    const u8 *iend = src + len;
+    u8 *op = dst;
+    u8 *oend = dst + capacity;
+    
+    while (ip < iend) {
+        
+        u8 token = *ip++;
+        
+        // Copy literals
+        isize litLen = token >> 4;
+        if (litLen == 15 && !readLength(ip, iend, litLen)) return -1;
+        if (litLen > iend - ip || litLen > oend - op) return -1;
+        
+        memcpy(op, ip, litLen);
+        ip += litLen;
+        op += litLen;
+        
+        // The last sequence consists of literals only
+        if (ip == iend) break;
+        
+        // Copy the match
+        if (iend - ip < 2) return -1;
+        isize offset = ip[0] | ip[1] << 8;
+        ip += 2;
+        if (offset == 0 || offset > op - dst) return -1;
+        
+        isize matchLen = token & 0xF;
+        if (matchLen == 15 && !readLength(ip, iend, matchLen)) return -1;
+        matchLen += minMatch;
+        if (matchLen > oend - op) return -1;
+        
+        const u8 *match = op - offset;
+        
+        if (offset == 1) {
+            memset(op, *match, matchLen);
+        } else if (offset >= matchLen) {
+            memcpy(op, match, matchLen);
+        } else {
+            for (isize i = 0; i < matchLen; i++) op[i] = match[i];
+        }
+        op += matchLen;
+    }
+    
+    return op - dst;
+}
+
+}
@@ -0,0 +1,34 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+
+namespace util {
+
+/* A lightweight LZ77 compressor producing data in the LZ4 block format. It
+ * favors speed over compression ratio and is intended for data with long runs
+ * of identical bytes such as emulator snapshots. Matches are searched within a
+ * distance of 64 KB.
+ */
+
+// Returns the maximum size of the compressed representation of 'len' bytes
+isize lz4Bound(isize len);
+
+// Compresses a buffer and returns the number of bytes written into 'dst'
+isize lz4Compress(const u8 *src, isize len, u8 *dst);
+
+/* Decompresses a buffer and returns the number of bytes written into 'dst'.
+ * The function never reads or writes outside the provided buffers and
+ * returns -1 if the compressed data is malformed.
+ */
+isize lz4Decompress(const u8 *src, isize len, u8 *dst, isize capacity);
+
+}
@@ -58,4 +58,26 @@ ReentrantMutex::unlock()
     return pthread_mutex_unlock(&mutex);
 }
 
+Condition::Condition()
+{
+    pthread_cond_init(&cond, nullptr);
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy(&cond);
+}
+
+int
+Condition::wait(Mutex &mutex)
+{
+    return pthread_cond_wait(&cond, &mutex.mutex);
+}
+
+int
+Condition::signal()
+{
+    return pthread_cond_broadcast(&cond);
+}
+
 }
@@ -15,6 +15,8 @@ namespace util {
 
 class Mutex
 {
+    friend class Condition;
+    
     pthread_mutex_t mutex;
 
 public:
@@ -39,6 +41,22 @@ public:
     int unlock();
 };
 
+class Condition
+{
+    pthread_cond_t cond;
+
+public:
+    
+    Condition();
+    ~Condition();
+    
+    // Waits for a signal (the mutex must be locked by the caller)
+    int wait(Mutex &mutex);
+    
+    // Wakes up all waiting threads
+    int signal();
+};
+
 class AutoMutex
 {
     ReentrantMutex &mutex;
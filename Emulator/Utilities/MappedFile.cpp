@@ -0,0 +1,61 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace util {
+
+bool
+MappedFile::map(const string &path, bool shared)
+{
+    unmap();
+    
+    int fd = open(path.c_str(), shared ? O_RDWR : O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+    
+    /* Private mappings are always writable, because the operating system
+     * copies modified pages instead of writing them back to the file.
+     */
+    int flags = shared ? MAP_SHARED : MAP_PRIVATE;
+    void *addr = mmap(nullptr, (size_t)st.st_size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    close(fd);
+    
+    if (addr == MAP_FAILED) return false;
+    
+    this->data = (u8 *)addr;
+    this->size = (isize)st.st_size;
+    this->shared = shared;
+    return true;
+}
+
+void
+MappedFile::unmap()
+{
+    if (data) munmap(data, (size_t)size);
+    
+    data = nullptr;
+    size = 0;
+    shared = false;
+}
+
+void
+MappedFile::sync()
+{
+    if (data && shared) msync(data, (size_t)size, MS_SYNC);
+}
+
+}
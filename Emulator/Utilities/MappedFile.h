@@ -0,0 +1,58 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Types.h"
+
+namespace util {
+
+/* Maps a file into the address space of the process. In private mode, the
+ * mapping is copy-on-write. Modifications are visible to the process only and
+ * never reach the file. In shared mode, modifications are written back to the
+ * file by the operating system. In both modes, the file contents is paged in
+ * on first access which makes mapping large files nearly instant.
+ */
+class MappedFile {
+    
+public:
+    
+    // The mapped file contents
+    u8 *data = nullptr;
+    
+    // The size of the mapping in bytes
+    isize size = 0;
+    
+private:
+    
+    // Indicates whether modifications are written back to the file
+    bool shared = false;
+    
+public:
+    
+    MappedFile() { };
+    MappedFile(const MappedFile &) = delete;
+    MappedFile& operator=(const MappedFile &) = delete;
+    ~MappedFile() { unmap(); }
+    
+    // Maps a file (returns false if the file cannot be opened or mapped)
+    bool map(const string &path, bool shared = false);
+    
+    // Releases the mapping
+    void unmap();
+    
+    // Checks whether a file is mapped
+    bool isMapped() const { return data != nullptr; }
+    bool isShared() const { return shared; }
+    
+    // Writes back all modifications (shared mappings only)
+    void sync();
+};
+
+}
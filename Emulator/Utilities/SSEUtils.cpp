@@ -10,49 +10,178 @@
 #include "config.h"
 #include "SSEUtils.h"
 
+#if defined(__i386__) || defined(__x86_64__)
+#define TRANSPOSE_X86
+#include <x86intrin.h>
+#endif
+
+#if defined(__aarch64__)
+#define TRANSPOSE_NEON
+#include <arm_neon.h>
+#endif
+
 namespace util {
 
-#if (defined(__i386__) || defined(__x86_64__)) && defined(__MACH__)
+void transposeScalar(const u16 *source, u8 *target)
+{
+    u32 mask = 0x8000;
+    for (isize i = 0; i < 16; i++, mask >>= 1) {
+        
+        target[i] =
+        (!!(source[0] & mask) << 0) |
+        (!!(source[1] & mask) << 1) |
+        (!!(source[2] & mask) << 2) |
+        (!!(source[3] & mask) << 3) |
+        (!!(source[4] & mask) << 4) |
+        (!!(source[5] & mask) << 5) |
+        (!!(source[6] & mask) << 6) |
+        (!!(source[7] & mask) << 7);
+    }
+}
+
+#ifdef TRANSPOSE_X86
 
-#include <x86intrin.h>
+/* Extracts the column values from a matrix with rearranged rows. The rows
+ * are expected in the order
+ *
+ *     0.hi 1.hi 2.hi 3.hi  ...  7.hi 0.lo 1.lo 2.lo 3.lo  ...  7.lo
+ *
+ * and the column values are returned in the order
+ *
+ *     col0 col8 col1 col9 col2 col10 col3 col11  ...  col7 col15
+ */
+static inline __m128i extractColumns(__m128i shuffled)
+{
+    union { u16 column[8]; __m128i sse; } result;
+    for (isize i = 0; i < 8; i++) {
+        result.column[i] = (u16)_mm_movemask_epi8(shuffled);
+        shuffled = _mm_slli_epi64(shuffled, 1);
+    }
+    return result.sse;
+}
 
-void transposeSSE(u16 *source, u8* target)
+void transposeSSE2(const u16 *source, u8 *target)
 {
+    __m128i rows = _mm_load_si128((const __m128i *)source);
+    __m128i lo = _mm_set1_epi16(0x00FF);
+    
     // We receive the matrix rows in little endian format
     // 0.lo 0.hi 1.lo 1.hi 2.lo 2.hi 3.lo 3.hi  ........  7.lo 7.hi
     //
     // Rearrange the byte order to
     // 0.hi 1.hi 2.hi 3.hi ...  7.hi 0.lo 1.lo 2.lo 3.lo  ...  7.lo
     
-    const u8 mask1[16] = { 1,3,5,7,9,11,13,15,0,2,4,6,8,10,12,14 };
-    __m128i shuffled = _mm_shuffle_epi8(*(__m128i *)source, *(__m128i *)mask1);
+    __m128i shuffled = _mm_packus_epi16(_mm_srli_epi16(rows, 8),
+                                        _mm_and_si128(rows, lo));
     
-    // Cut off column values in the order
-    // col0 col8 col1 col9 col2 col10 col3 col11 ... col7 col15
-    
-    union { u16 column[8]; __m128i sse; } result;
-    for (isize i = 0; i < 8; i++) {
-        result.column[i] = (u16)_mm_movemask_epi8(shuffled);
-        shuffled = _mm_slli_epi64(shuffled, 1);
-    }
+    // Cut off column values
+    __m128i columns = extractColumns(shuffled);
     
     // Shuffle back to
     // col0 col1 col2 col3 col4 col5 col6 col7 ...  col14 col15
     
-    const u8 mask2[16] = { 0,2,4,6,8,10,12,14,1,3,5,7,9,11,13,15 };
-    shuffled = _mm_shuffle_epi8(result.sse, *(__m128i *)mask2);
+    shuffled = _mm_packus_epi16(_mm_and_si128(columns, lo),
+                                _mm_srli_epi16(columns, 8));
+    
+    _mm_store_si128((__m128i *)target, shuffled);
+}
+
+__attribute__((target("ssse3")))
+void transposeSSSE3(const u16 *source, u8 *target)
+{
+    __m128i rows = _mm_load_si128((const __m128i *)source);
+
+    // Rearrange the byte order (see transposeSSE2)
+    const __m128i mask1 = _mm_setr_epi8(1,3,5,7,9,11,13,15,0,2,4,6,8,10,12,14);
+    __m128i shuffled = _mm_shuffle_epi8(rows, mask1);
+    
+    // Cut off column values
+    __m128i columns = extractColumns(shuffled);
+    
+    // Shuffle back
+    const __m128i mask2 = _mm_setr_epi8(0,2,4,6,8,10,12,14,1,3,5,7,9,11,13,15);
+    shuffled = _mm_shuffle_epi8(columns, mask2);
     
-    // Read the result back from the SSE registers
     _mm_store_si128((__m128i *)target, shuffled);
 }
 
 #else
 
-void transposeSSE(u16 *source, u8* target)
+void transposeSSE2(const u16 *source, u8 *target)
 {
-    assert(false);
+    transposeScalar(source, target);
+}
+
+void transposeSSSE3(const u16 *source, u8 *target)
+{
+    transposeScalar(source, target);
 }
 
 #endif
 
+#ifdef TRANSPOSE_NEON
+
+void transposeNEON(const u16 *source, u8 *target)
+{
+    static const u16 weights[8] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+    
+    uint16x8_t rows = vld1q_u16(source);
+    uint16x8_t w = vld1q_u16(weights);
+    
+    for (isize i = 0; i < 16; i++) {
+        
+        // Move bit 15 - i of each row into bit 0 and weight it by the row
+        uint16x8_t bits = vshlq_u16(rows, vdupq_n_s16((i16)(i - 15)));
+        bits = vmulq_u16(vandq_u16(bits, vdupq_n_u16(1)), w);
+        
+        target[i] = (u8)vaddvq_u16(bits);
+    }
+}
+
+#else
+
+void transposeNEON(const u16 *source, u8 *target)
+{
+    transposeScalar(source, target);
+}
+
+#endif
+
+bool transposeIsSupported(TransposeFunc func)
+{
+    if (func == transposeScalar) return true;
+    
+    #ifdef TRANSPOSE_X86
+    if (func == transposeSSE2) return __builtin_cpu_supports("sse2");
+    if (func == transposeSSSE3) return __builtin_cpu_supports("ssse3");
+    #endif
+    
+    #ifdef TRANSPOSE_NEON
+    if (func == transposeNEON) return true;
+    #endif
+    
+    return false;
+}
+
+TransposeFunc bestTranspose()
+{
+    // The SSE2 variant is as fast as the SSSE3 variant (see vAmigaHeadless
+    // -bench). Hence, the SSSE3 variant is only used if SSE2 is unavailable.
+    if (transposeIsSupported(transposeSSE2)) return transposeSSE2;
+    if (transposeIsSupported(transposeSSSE3)) return transposeSSSE3;
+    if (transposeIsSupported(transposeNEON)) return transposeNEON;
+    
+    return transposeScalar;
+}
+
+const char *transposeName(TransposeFunc func)
+{
+    if (func == transposeScalar) return "Scalar";
+    if (func == transposeSSE2) return "SSE2";
+    if (func == transposeSSSE3) return "SSSE3";
+    if (func == transposeNEON) return "NEON";
+    
+    return "???";
+}
+
 }
@@ -13,7 +13,7 @@
 
 namespace util {
 
-/* Transposes a 8 x 16 bit matrix using SSE3 extensions.
+/* Transposes a 8 x 16 bit matrix.
  *
  *     Input:   A pointer to a u16[8] array.
  *              Each array element stores a row of the matrix.
@@ -32,7 +32,33 @@ namespace util {
  *                                        | Column values
  *                                        v
  *              Output: 31, 7, 11, 3, 13, 5, 9, 17, 30, 6, 10, 2, 12, 4, 8, 16
+ *
+ * Multiple implementations are provided. The SIMD variants require both
+ * arrays to be 16 byte aligned. A variant that is not supported by the host
+ * architecture falls back to the scalar implementation.
  */
-void transposeSSE(u16 *source, u8* target);
+void transposeScalar(const u16 *source, u8 *target);
+void transposeSSE2(const u16 *source, u8 *target);
+void transposeSSSE3(const u16 *source, u8 *target);
+void transposeNEON(const u16 *source, u8 *target);
+
+// Function signature shared by all implementations
+typedef void (*TransposeFunc)(const u16 *, u8 *);
+
+// Returns the fastest implementation supported by the host CPU
+TransposeFunc bestTranspose();
+
+// Returns the name of an implementation
+const char *transposeName(TransposeFunc func);
+
+// Checks if an implementation is supported by the host CPU
+bool transposeIsSupported(TransposeFunc func);
+
+// Transposes with the fastest implementation supported by the host CPU
+inline void transpose(const u16 *source, u8 *target)
+{
+    static const TransposeFunc func = bestTranspose();
+    func(source, target);
+}
 
 }
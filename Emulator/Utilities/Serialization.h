@@ -10,7 +10,9 @@
 #pragma once
 
 #include "Macros.h"
+#include <algorithm>
 #include <cstring>
+#include <type_traits>
 
 namespace util {
 
@@ -83,6 +85,37 @@ inline void writeDouble(u8 *& buf, double value)
 }
 
 
+//
+// Bulk I/O
+//
+
+/* Arrays of arithmetic types are serialized in bulk. Instead of converting
+ * each element to big endian format, the array is copied as a whole in the
+ * byte order of the host machine. A preceding marker byte records this byte
+ * order. If the marker doesn't match when the array is read back, the bytes
+ * of each element are swapped after copying.
+ */
+template <class T> constexpr bool isBulkType = std::is_arithmetic<T>::value;
+
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+static constexpr u8 nativeByteOrder = 'B';
+#else
+static constexpr u8 nativeByteOrder = 'L';
+#endif
+
+template <class T> void swapBytes(T *elements, isize count)
+{
+    if constexpr (sizeof(T) > 1) {
+        
+        for (isize i = 0; i < count; i++) {
+
+            u8 *p = (u8 *)(elements + i);
+            std::reverse(p, p + sizeof(T));
+        }
+    }
+}
+
+
 //
 // Counter (determines the state size)
 //
@@ -125,8 +158,12 @@ public:
     template <class T, isize N>
     SerCounter& operator<<(T (&v)[N])
     {
-        for(isize i = 0; i < N; ++i) {
-            *this << v[i];
+        if constexpr (isBulkType<T>) {
+            count += 1 + isizeof(v);
+        } else {
+            for(isize i = 0; i < N; ++i) {
+                *this << v[i];
+            }
         }
         return *this;
     }
@@ -193,8 +230,14 @@ public:
     template <class T, isize N>
     SerReader& operator<<(T (&v)[N])
     {
-        for(isize i = 0; i < N; ++i) {
-            *this << v[i];
+        if constexpr (isBulkType<T>) {
+            u8 byteOrder = read8(ptr);
+            copy(v, isizeof(v));
+            if (byteOrder != nativeByteOrder) swapBytes(v, N);
+        } else {
+            for(isize i = 0; i < N; ++i) {
+                *this << v[i];
+            }
         }
         return *this;
     }
@@ -267,8 +310,13 @@ public:
     template <class T, isize N>
     SerWriter& operator<<(T (&v)[N])
     {
-        for(isize i = 0; i < N; ++i) {
-            *this << v[i];
+        if constexpr (isBulkType<T>) {
+            write8(ptr, nativeByteOrder);
+            copy(v, isizeof(v));
+        } else {
+            for(isize i = 0; i < N; ++i) {
+                *this << v[i];
+            }
         }
         return *this;
     }
@@ -335,8 +383,12 @@ public:
     template <class T, isize N>
     SerResetter& operator<<(T (&v)[N])
     {
-        for(isize i = 0; i < N; ++i) {
-            *this << v[i];
+        if constexpr (isBulkType<T>) {
+            memset((void *)v, 0, sizeof(v));
+        } else {
+            for(isize i = 0; i < N; ++i) {
+                *this << v[i];
+            }
         }
         return *this;
     }
@@ -107,10 +107,21 @@ Canvas::update(u64 frames, sf::Time dt)
         
     } else if (app.amiga.isRunning()) {
             
-        ScreenBuffer buffer = app.amiga.denise.pixelEngine.getStableBuffer();
+        auto &pixelEngine = app.amiga.denise.pixelEngine;
+        ScreenBuffer buffer = pixelEngine.lockStableBuffer();
                 
         // Only proceed if the emulator delivers a new texture
-        if (prevBuffer.data == buffer.data) return;
+        if (prevBuffer.nr == buffer.nr) {
+            pixelEngine.unlockStableBuffer(buffer);
+            return;
+        }
+        
+        /* If the new texture is the direct successor of the previous one and
+         * goes into the same GPU texture, the GPU texture still contains the
+         * previous frame. In this case, only the dirty lines are uploaded.
+         */
+        bool partial =
+        buffer.nr == prevBuffer.nr + 1 && buffer.longFrame == prevBuffer.longFrame;
         prevBuffer = buffer;
 
         // Determine if the new texture is a long frame or a short frame
@@ -118,13 +129,31 @@ Canvas::update(u64 frames, sf::Time dt)
         currLOF = buffer.longFrame;
         
         // Update the GPU texture
-        if (currLOF) {
-            // printf("Updating long frame texture\n")
-            longFrameTexture.update((u8 *)(buffer.data + 4 * HBLANK_MIN));
+        auto &texture = currLOF ? longFrameTexture : shortFrameTexture;
+        if (partial) {
+            updateDirtyLines(texture, buffer);
         } else {
-            // printf("Updating short frame texture\n")
-            shortFrameTexture.update((u8 *)(buffer.data + 4 * HBLANK_MIN));
+            texture.update((u8 *)(buffer.data + 4 * HBLANK_MIN));
         }
+        pixelEngine.unlockStableBuffer(buffer);
+    }
+}
+
+void
+Canvas::updateDirtyLines(sf::Texture &texture, const ScreenBuffer &buffer)
+{
+    u32 *data = buffer.data + 4 * HBLANK_MIN;
+    
+    // Upload each block of consecutive dirty lines in a single call
+    for (int y = 0; y < TEX_FRAME_H; y++) {
+        
+        if (!buffer.dirty[y]) continue;
+        
+        int first = y;
+        while (y < TEX_FRAME_H && buffer.dirty[y]) y++;
+        
+        texture.update((u8 *)(data + first * HPIXELS),
+                       TEX_FRAME_W, y - first, 0, first);
     }
 }
 
@@ -39,7 +39,7 @@ private:
     
     // The current screen buffer
     ScreenBuffer screenBuffer = { nullptr, false };
-    ScreenBuffer prevBuffer = { nullptr, false };
+    ScreenBuffer prevBuffer = { nullptr, false, -1 };
 
     // Indicates whether the recently drawn frames were long or short frames
     bool currLOF = true;
@@ -93,6 +93,11 @@ public:
     void update(u64 frames, sf::Time dt) override;
     void render() override;
 
+private:
+    
+    // Uploads all lines that have changed since the previous frame
+    void updateDirtyLines(sf::Texture &texture, const ScreenBuffer &buffer);
+
     
     //
     // Responding to events
@@ -0,0 +1,282 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga Bare Metal
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "BatchRunner.h"
+#include "Amiga.h"
+#include "Checksum.h"
+#include "Chrono.h"
+#include "IO.h"
+#include "Snapshot.h"
+
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <thread>
+
+// Message listener of a headless Amiga (messages are ignored)
+static void ignoreMessage(const void *listener, long type, long data) { }
+
+double
+BatchRunner::run()
+{
+    isize numWorkers = workers;
+    if (numWorkers <= 0) numWorkers = std::thread::hardware_concurrency();
+    if (numWorkers <= 0) numWorkers = 1;
+    if (numWorkers > (isize)jobs.size()) numWorkers = (isize)jobs.size();
+
+    nextJob = 0;
+    auto start = util::Time::now();
+    
+    // Read the Roms once instead of reading them in each job
+    readFile(romPath, rom);
+    if (!extPath.empty()) readFile(extPath, ext);
+    
+    std::vector<std::thread> pool;
+    for (isize i = 0; i < numWorkers; i++) {
+        pool.push_back(std::thread(&BatchRunner::worker, this));
+    }
+    for (auto &t : pool) t.join();
+    
+    return (util::Time::now() - start).asSeconds();
+}
+
+void
+BatchRunner::worker()
+{
+    isize nr;
+    
+    while ((nr = nextJob++) < (isize)jobs.size()) {
+        process(jobs[nr], nr);
+    }
+}
+
+void
+BatchRunner::process(BatchJob &job, isize nr)
+{
+    auto start = util::Time::now();
+    
+    try {
+        
+        // The Amiga object is too large to be placed on the stack
+        auto amiga = std::make_unique<Amiga>();
+        
+        // Configure the machine
+        amiga->configure(CONFIG_A500_ECS_1MB);
+        amiga->configure(OPT_EVENT_SCHEDULER, scheduler);
+        if (rom.empty()) {
+            amiga->mem.loadRom(romPath);
+        } else {
+            amiga->mem.loadRom(rom.data(), (isize)rom.size());
+        }
+        if (!extPath.empty()) {
+            if (ext.empty()) {
+                amiga->mem.loadExt(extPath);
+            } else {
+                amiga->mem.loadExt(ext.data(), (isize)ext.size());
+            }
+            amiga->configure(OPT_EXT_START, 0xE0);
+        }
+        
+        // Insert the disk, attach the hard drive, or load the snapshot
+        std::unique_ptr<Snapshot> snapshot;
+        if (!job.disk.empty()) {
+            
+            auto type = AmigaFile::type(job.disk);
+            if (type == FILETYPE_SNAPSHOT) {
+                snapshot.reset(AmigaFile::make <Snapshot> (job.disk));
+            } else if (type == FILETYPE_HDF) {
+                amiga->hdController.attach(job.disk);
+            } else {
+                amiga->paula.diskController.insertDisk(job.disk, 0);
+            }
+        }
+        
+        // Drain the message queue
+        amiga->msgQueue.setListener(this, &ignoreMessage);
+        
+        // Emulate
+        amiga->powerOn();
+        if (snapshot) amiga->loadFromSnapshotUnsafe(snapshot.get());
+        amiga->profiler.clear();
+        job.frames = amiga->executeFrames(job.duration ? job.duration : frames);
+        
+        // Record the host time spent in each subsystem
+        if (profile) {
+            
+            std::stringstream ss;
+            amiga->profiler.dump(dump::State, ss);
+            job.profile = ss.str();
+        }
+        
+        // Evaluate the final frame (the hash is the one used in manifests)
+        auto &tester = amiga->regressionTester;
+        auto buffer = amiga->denise.pixelEngine.getStableBuffer();
+        job.checksum = tester.computeHash(*amiga);
+        
+        if (!job.reference.empty()) {
+            
+            if (record) {
+                
+                // Hash references are printed in the report only
+                if (!isHash(job.reference)) tester.saveReference(*amiga, job.reference);
+                job.passed = true;
+                
+            } else {
+                
+                job.passed = tester.verify(*amiga, job.name, job.reference);
+                job.mismatches = tester.results.back().mismatches;
+            }
+        }
+        
+        if (!outputDir.empty()) {
+            
+            std::stringstream ss;
+            ss << outputDir << "/job" << std::setw(4) << std::setfill('0');
+            ss << nr;
+            dumpFrame(buffer.data, ss.str() + ".ppm");
+            
+            if (saveSnapshots) {
+                
+                std::unique_ptr<Snapshot> result(Snapshot::makeWithAmiga(amiga.get()));
+                result->writeCompressedToFile(ss.str() + ".vasnap");
+            }
+        }
+        
+        amiga->powerOff();
+        job.success = true;
+        
+    } catch (util::Exception &e) {
+        
+        job.error = e.what();
+    }
+    
+    job.seconds = (util::Time::now() - start).asSeconds();
+}
+
+void
+BatchRunner::addManifest(const string &path)
+{
+    std::ifstream stream(path);
+    if (!stream.is_open()) throw VAError(ERROR_FILE_NOT_FOUND, path);
+    
+    auto dir = util::extractPath(path);
+    auto resolve = [&](const string &file) {
+        return util::isAbsolutePath(file) ? file : dir + file;
+    };
+    
+    string line;
+    while (std::getline(stream, line)) {
+        
+        std::stringstream ss(line);
+        BatchJob job;
+        string disk, reference;
+        
+        if (!(ss >> job.name) || job.name[0] == '#') continue;
+        if (!(ss >> disk >> job.duration >> reference)) {
+            throw VAError(ERROR_FILE_TYPE_MISMATCH, line);
+        }
+        
+        if (disk != "-") job.disk = resolve(disk);
+        
+        // Hash values are kept as they are
+        job.reference = isHash(reference) ? reference : resolve(reference);
+        
+        jobs.push_back(job);
+    }
+}
+
+bool
+BatchRunner::isHash(const string &reference)
+{
+    return reference.find_first_not_of("0123456789abcdefABCDEF") == string::npos;
+}
+
+void
+BatchRunner::readFile(const string &path, std::vector<u8> &buffer) const
+{
+    std::ifstream stream(path, std::ios::binary);
+    buffer.clear();
+    
+    if (stream.is_open()) {
+        buffer.assign(std::istreambuf_iterator<char>(stream),
+                      std::istreambuf_iterator<char>());
+    }
+}
+
+void
+BatchRunner::dumpFrame(const u32 *data, const string &path) const
+{
+    std::ofstream os(path, std::ios::binary);
+    if (!os.is_open()) return;
+    
+    os << "P6\n" << HPIXELS << " " << VPIXELS << "\n255\n";
+    
+    for (isize i = 0; i < PIXELS; i++) {
+        
+        u32 rgba = data[i];
+        os.put((char)(rgba & 0xFF));
+        os.put((char)((rgba >> 8) & 0xFF));
+        os.put((char)((rgba >> 16) & 0xFF));
+    }
+}
+
+void
+BatchRunner::report(std::ostream& os, double seconds) const
+{
+    isize total = 0;
+    isize failed = 0;
+    isize tests = 0;
+    isize regressions = 0;
+    
+    for (usize i = 0; i < jobs.size(); i++) {
+        
+        auto &job = jobs[i];
+        auto name = !job.name.empty() ? job.name :
+        job.disk.empty() ? "(no disk)" : util::extractName(job.disk);
+
+        os << std::setw(4) << i << ": " << std::left << std::setw(24) << name;
+        os << std::right;
+
+        if (job.success) {
+            
+            os << std::setw(6) << job.frames << " frames ";
+            os << std::fixed << std::setprecision(2) << std::setw(8);
+            os << job.seconds << " sec  ";
+            os << std::hex << std::setw(16) << std::setfill('0') << job.checksum;
+            os << std::dec << std::setfill(' ');
+            if (!job.reference.empty()) {
+                
+                os << (record ? "  RECORDED" : job.passed ? "  PASS" : "  FAIL");
+                if (job.mismatches > 0) os << " (" << job.mismatches << " pixels differ)";
+                if (!job.passed) regressions++;
+                tests++;
+            }
+            os << std::endl;
+            if (profile) os << std::endl << job.profile << std::endl;
+            total += job.frames;
+            
+        } else {
+            
+            os << "FAILED: " << job.error << std::endl;
+            failed++;
+        }
+    }
+    
+    os << std::endl;
+    os << "Jobs:       " << jobs.size() << " (" << failed << " failed)" << std::endl;
+    if (tests) {
+        os << "Tests:      " << tests << " (" << regressions << " failed)" << std::endl;
+    }
+    os << "Frames:     " << total << std::endl;
+    os << "Time:       " << std::fixed << std::setprecision(2) << seconds;
+    os << " sec" << std::endl;
+    os << "Throughput: " << std::fixed << std::setprecision(1);
+    os << (seconds > 0 ? total / seconds : 0) << " frames/sec" << std::endl;
+}
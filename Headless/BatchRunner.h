@@ -0,0 +1,149 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga Bare Metal
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include "Exception.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+using std::string;
+
+/* A single emulation job. Each job boots a fresh Amiga, inserts the specified
+ * disk (if any) into df0, runs the requested number of frames and records
+ * the outcome. If a snapshot is specified instead of a disk, the emulation
+ * continues from the state stored in the snapshot. If a reference is given,
+ * the final frame is compared with it by the regression tester.
+ */
+struct BatchJob {
+    
+    // The disk to insert into df0 or the snapshot to load (empty = no disk)
+    string disk;
+    
+    // Name of the job (empty = derived from the disk name)
+    string name;
+    
+    // Number of frames to emulate (0 = use the runner's setting)
+    isize duration = 0;
+    
+    // Reference image or hash of the final frame (empty = no comparison)
+    string reference;
+    
+    // Outcome
+    bool success = false;
+    string error;
+    isize frames = 0;
+    double seconds = 0.0;
+    
+    // Hash of the texture cutout of the final frame (see RegressionTester)
+    u64 checksum = 0;
+    
+    // Regression test outcome (only recorded if a reference is given)
+    bool passed = false;
+    isize mismatches = 0;
+    
+    // Profiler report (only recorded if profiling is requested)
+    string profile;
+};
+
+/* Runs a batch of emulation jobs in parallel. The runner maintains a pool of
+ * worker threads. Each worker repeatedly picks the next pending job, creates
+ * an Amiga instance, and emulates it inside its own thread by calling
+ * Amiga::executeFrames(). No emulator thread is spawned and no GUI is
+ * involved, which makes the runner suitable for regression testing, fuzzing,
+ * and throughput measurements.
+ */
+class BatchRunner {
+    
+public:
+    
+    // Rom and extension Rom (the extension Rom is optional)
+    string romPath;
+    string extPath;
+    
+    // Number of frames to emulate per job
+    isize frames = 500;
+    
+    // Number of worker threads (0 = number of hardware threads)
+    isize workers = 0;
+    
+    // Event scheduler used by all instances
+    i64 scheduler = 0;
+    
+    // If not empty, the final frame of each job is written to this directory
+    string outputDir;
+    
+    // If set, the final state of each job is saved as a compressed snapshot
+    bool saveSnapshots = false;
+    
+    // If set, the profiler report of each job is printed
+    bool profile = false;
+    
+    // If set, reference images are written instead of being compared
+    bool record = false;
+    
+    // The jobs to process
+    std::vector<BatchJob> jobs;
+    
+private:
+    
+    // Index of the next job to be picked up by a worker
+    std::atomic<isize> nextJob { 0 };
+    
+    // Rom images shared by all jobs (read once before the jobs are started)
+    std::vector<u8> rom;
+    std::vector<u8> ext;
+    
+    
+    //
+    // Running
+    //
+    
+public:
+    
+    // Adds a job to the batch
+    void addJob(const string &disk) { jobs.push_back(BatchJob { disk }); }
+    
+    /* Adds all jobs listed in a manifest file. Each line describes a single
+     * regression test in the format
+     *
+     *     <name> <disk> <frames> <reference>
+     *
+     * where <disk> is '-' if no disk is inserted and <reference> is either a
+     * reference image or a hash value in hexadecimal notation. Relative paths
+     * are resolved against the directory of the manifest. Empty lines and
+     * lines starting with '#' are ignored.
+     */
+    void addManifest(const string &path) throws;
+    
+    // Processes all jobs and returns the elapsed wall-clock time in seconds
+    double run();
+
+    // Prints the per-job results and aggregate statistics
+    void report(std::ostream& os, double seconds) const;
+    
+private:
+    
+    // The worker thread main function
+    void worker();
+    
+    // Processes a single job
+    void process(BatchJob &job, isize nr);
+    
+    // Checks whether a manifest reference is a hash value
+    static bool isHash(const string &reference);
+    
+    // Reads a file into memory (the buffer remains empty on failure)
+    void readFile(const string &path, std::vector<u8> &buffer) const;
+    
+    // Writes a frame buffer to a PPM file
+    void dumpFrame(const u32 *data, const string &path) const;
+};
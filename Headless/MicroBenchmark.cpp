@@ -0,0 +1,1116 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga Bare Metal
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "MicroBenchmark.h"
+#include "Amiga.h"
+#include "ADFFile.h"
+#include "Chrono.h"
+#include "FSDevice.h"
+#include "HDFFile.h"
+#include "Snapshot.h"
+#include "Serialization.h"
+#include "SSEUtils.h"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+isize
+MicroBenchmark::run()
+{
+    failures = 0;
+    
+    benchTranspose();
+    benchColorize();
+    benchSynthesize();
+    benchSnapshot();
+    benchSerialize();
+    benchCompression();
+    benchMFM();
+    benchFileSystem();
+    benchHdController();
+    benchFrameHandoff();
+    benchDirtyLines();
+    benchRecorder();
+    benchWarpPolicy();
+    benchGuards();
+    
+    return failures;
+}
+
+void
+MicroBenchmark::report(const char *kernel, const char *variant,
+                       double items, const char *unit, double seconds,
+                       bool verified, double itemsPerFrame)
+{
+    os << std::left << std::setw(12) << kernel << std::setw(10) << variant;
+    os << std::right << std::fixed << std::setprecision(3) << std::setw(10);
+    os << (seconds > 0 ? items / (seconds * 1e9) : 0) << " " << unit << "/ns  ";
+    if (itemsPerFrame > 0 && items > 0) {
+        os << std::setw(8) << 1000.0 * seconds * itemsPerFrame / items;
+        os << " ms/frame  ";
+    }
+    os << (verified ? "OK" : "MISMATCH") << std::endl;
+    
+    if (!verified) failures++;
+}
+
+void
+MicroBenchmark::benchTranspose()
+{
+    const isize count = 4096;
+    const isize rounds = 256;
+    
+    // Create some random bitplane data (the upper two rows are always zero)
+    std::mt19937 rng(42);
+    std::vector<u16> input(8 * count);
+    for (isize i = 0; i < count; i++) {
+        for (isize j = 0; j < 8; j++) input[8 * i + j] = j < 6 ? (u16)rng() : 0;
+    }
+    
+    // Compute the reference result
+    std::vector<u8> expected(16 * count);
+    for (isize i = 0; i < count; i++) {
+        util::transposeScalar(&input[8 * i], &expected[16 * i]);
+    }
+    
+    util::TransposeFunc variants[] = {
+        
+        util::transposeScalar,
+        util::transposeSSE2,
+        util::transposeSSSE3,
+        util::transposeNEON
+    };
+    
+    for (auto func : variants) {
+        
+        if (!util::transposeIsSupported(func)) continue;
+        
+        u16 __attribute__ ((aligned (64))) source[8];
+        u8 __attribute__ ((aligned (64))) target[16];
+        
+        // Verify
+        bool verified = true;
+        for (isize i = 0; i < count; i++) {
+            
+            memcpy(source, &input[8 * i], sizeof(source));
+            func(source, target);
+            verified &= memcmp(target, &expected[16 * i], 16) == 0;
+        }
+        
+        // Measure
+        u64 sum = 0;
+        auto start = util::Time::now();
+        for (isize r = 0; r < rounds; r++) {
+            for (isize i = 0; i < count; i++) {
+                
+                memcpy(source, &input[8 * i], sizeof(source));
+                func(source, target);
+                sum += target[i & 15];
+            }
+        }
+        auto elapsed = (util::Time::now() - start).asSeconds();
+        
+        // Keep the compiler from optimizing the loop away
+        if (sum == 0) os << "";
+        
+        report("transpose", util::transposeName(func),
+               (double)(16 * count * rounds), "pixels", elapsed, verified);
+    }
+}
+
+void
+MicroBenchmark::benchColorize()
+{
+    const isize rounds = 2000;
+    
+    // The pixel engine is tightly coupled with Denise. Hence, we need an Amiga
+    auto amiga = std::make_unique<Amiga>();
+    auto &denise = amiga->denise;
+    auto &pe = denise.pixelEngine;
+    
+    // Setup random color registers and a random line buffer
+    std::mt19937 rng(42);
+    for (isize i = 0; i < 32; i++) pe.setColor(i, (u16)rng());
+    for (isize i = 0; i < HPIXELS; i++) denise.mBuffer[i] = (u8)rng() & 0x3F;
+    
+    std::vector<u32> expected(HPIXELS), line(HPIXELS);
+    
+    typedef void (PixelEngine::*Colorizer)(u32 *, Pixel, Pixel);
+    struct { const char *name; Colorizer func; bool supported; } variants[] = {
+        
+        { "Scalar", &PixelEngine::colorizeScalar, true },
+        { "Gather", &PixelEngine::colorizeGather, PixelEngine::hasGather() }
+    };
+    
+    (pe.*variants[0].func)(expected.data(), 0, HPIXELS);
+
+    for (auto &v : variants) {
+        
+        if (!v.supported) continue;
+        
+        // Verify
+        std::fill(line.begin(), line.end(), 0);
+        (pe.*v.func)(line.data(), 0, HPIXELS);
+        bool verified = line == expected;
+        
+        // Measure
+        auto start = util::Time::now();
+        for (isize r = 0; r < rounds; r++) (pe.*v.func)(line.data(), 0, HPIXELS);
+        auto elapsed = (util::Time::now() - start).asSeconds();
+        
+        report("colorize", v.name, (double)(HPIXELS * rounds), "pixels",
+               elapsed, verified, PIXELS);
+    }
+}
+
+void
+MicroBenchmark::benchSynthesize()
+{
+    const isize rounds = 200;
+    const Cycle frame = DMA_CYCLES(VPOS_CNT * HPOS_CNT);
+    const long samplesPerFrame = 882;
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &muxer = amiga->paula.muxer;
+    
+    amiga->configure(OPT_SAMPLING_METHOD, SMP_LINEAR);
+    amiga->configure(OPT_FILTER_ALWAYS_ON, true);
+    muxer.clear();
+    
+    // Creates a frame worth of random sound samples for all four channels
+    auto feed = [&]() {
+        
+        std::mt19937 rng(42);
+        for (isize c = 0; c < 4; c++) {
+            
+            muxer.sampler[c]->clear();
+            for (Cycle tag = 0; tag < frame; tag += 400 + 100 * c) {
+                muxer.sampler[c]->write(TaggedSample { tag, (i16)(rng() & 0x3FFF) });
+            }
+        }
+    };
+    
+    typedef void (Muxer::*Synthesizer)(Cycle, Cycle, long);
+    struct { const char *name; Synthesizer func; } variants[] = {
+        
+        { "Scalar", &Muxer::synthesizeScalar },
+        { "Blocked", &Muxer::synthesize }
+    };
+    
+    std::vector<SampleType> expected, samples;
+    
+    for (auto &v : variants) {
+        
+        // Measure
+        double elapsed = 0;
+        for (isize r = 0; r < rounds; r++) {
+            
+            feed();
+            muxer.filterL.clear();
+            muxer.filterR.clear();
+            muxer.stream.clear();
+            
+            auto start = util::Time::now();
+            (muxer.*v.func)(0, frame, samplesPerFrame);
+            elapsed += (util::Time::now() - start).asSeconds();
+        }
+        
+        // Verify (the reference computes in double precision, allow rounding)
+        samples.clear();
+        while (!muxer.stream.isEmpty()) samples.push_back(muxer.stream.read());
+        if (expected.empty()) expected = samples;
+        
+        bool verified = samples.size() == expected.size();
+        for (usize i = 0; verified && i < samples.size(); i++) {
+            
+            verified &= std::abs(samples[i].l - expected[i].l) <= 1;
+            verified &= std::abs(samples[i].r - expected[i].r) <= 1;
+        }
+        
+        report("synthesize", v.name, (double)(samplesPerFrame * rounds),
+               "samples", elapsed, verified, samplesPerFrame);
+    }
+}
+
+void
+MicroBenchmark::benchSnapshot()
+{
+    const isize frames = 50;
+    const isize writesPerFrame = 4096;
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &mem = amiga->mem;
+    
+    amiga->configure(OPT_CHIP_RAM, 512);
+    amiga->configure(OPT_SLOW_RAM, 512);
+    amiga->configure(OPT_FAST_RAM, 8192);
+    
+    /* Modifies random locations in Chip Ram and Fast Ram. Similar to a real
+     * program, the writes are confined to a working set which is small
+     * compared to the size of the Ram.
+     */
+    std::mt19937 rng(42);
+    auto modify = [&]() {
+        
+        u32 chipBase = (u32)rng() & mem.chipMask & ~0xFFFF;
+        u32 fastBase = (u32)rng() & mem.fastMask & ~0x1FFFF;
+        
+        for (isize i = 0; i < writesPerFrame; i++) {
+            
+            u32 chipAddr = chipBase + ((u32)rng() & 0xFFFE);
+            u32 fastAddr = FAST_RAM_STRT + fastBase + ((u32)rng() & 0x1FFFE);
+            mem.poke16 <ACCESSOR_AGNUS, MEM_CHIP> (chipAddr, (u16)rng());
+            mem.poke16 <ACCESSOR_CPU, MEM_FAST> (fastAddr, (u16)rng());
+        }
+    };
+    
+    std::vector<std::unique_ptr<Snapshot>> full;
+    double fullTime = 0, deltaTime = 0;
+    isize fullBytes = 0;
+    
+    amiga->snapshotChain.clear();
+    amiga->snapshotChain.setCapacity(frames);
+    
+    for (isize f = 0; f < frames; f++) {
+        
+        modify();
+        
+        auto start = util::Time::now();
+        full.push_back(std::unique_ptr<Snapshot>(Snapshot::makeWithAmiga(amiga.get())));
+        fullTime += (util::Time::now() - start).asSeconds();
+        fullBytes += full.back()->size;
+        
+        start = util::Time::now();
+        amiga->snapshotChain.record();
+        deltaTime += (util::Time::now() - start).asSeconds();
+    }
+    
+    // Verify that restoring an entry has the same effect as a full snapshot
+    bool verified = true;
+    std::vector<u8> expected(amiga->size()), state(amiga->size());
+    
+    for (isize f : { (isize)0, frames / 2, frames - 1 }) {
+        
+        amiga->loadFromSnapshotUnsafe(full[f].get());
+        amiga->save(expected.data());
+        amiga->snapshotChain.restore(f);
+        amiga->save(state.data());
+        verified &= expected == state;
+    }
+    
+    // Throughput is given in bytes of emulator state per nanosecond
+    double bytes = (double)amiga->size();
+    isize usage = amiga->snapshotChain.memoryUsage();
+    
+    /* Changing the memory layout must start a new chain, even if the total
+     * number of pages stays the same. Here, Slow Ram is traded for Chip Ram.
+     */
+    amiga->configure(OPT_CHIP_RAM, 1024);
+    amiga->configure(OPT_SLOW_RAM, 0);
+    modify();
+    expected.resize(amiga->size());
+    state.resize(amiga->size());
+    amiga->save(expected.data());
+    amiga->snapshotChain.record();
+    verified &= amiga->snapshotChain.count() == 1;
+    modify();
+    amiga->snapshotChain.restore(0);
+    amiga->save(state.data());
+    verified &= expected == state;
+    
+    report("snapshot", "Full", bytes * frames, "bytes", fullTime, true, bytes);
+    report("snapshot", "Delta", bytes * frames, "bytes", deltaTime, verified, bytes);
+    
+    os << std::left << std::setw(22) << "" << std::right;
+    os << "Storage: " << fullBytes / frames / 1024 << " KB/frame (full), ";
+    os << usage / frames / 1024 << " KB/frame (delta)";
+    os << std::endl;
+}
+
+void
+MicroBenchmark::benchSerialize()
+{
+    const isize rounds = 100;
+    
+    auto amiga = std::make_unique<Amiga>();
+    
+    std::vector<u8> state(amiga->size()), restored(amiga->size());
+    double saveTime = 0, loadTime = 0;
+    
+    for (isize r = 0; r < rounds; r++) {
+        
+        auto start = util::Time::now();
+        amiga->save(state.data());
+        saveTime += (util::Time::now() - start).asSeconds();
+        
+        start = util::Time::now();
+        amiga->load(state.data());
+        loadTime += (util::Time::now() - start).asSeconds();
+    }
+    
+    // Verify that loading and saving the state is lossless
+    amiga->save(restored.data());
+    bool verified = state == restored;
+    
+    // Verify that bulk arrays written with a foreign byte order are swapped
+    i32 source[64], target[64], swapped[64];
+    for (isize i = 0; i < 64; i++) source[i] = (i32)(i * 0x01020304);
+    
+    u8 buffer[1 + sizeof(source)];
+    util::SerWriter writer(buffer);
+    writer << source;
+    
+    memcpy(swapped, buffer + 1, sizeof(swapped));
+    util::swapBytes(swapped, 64);
+    memcpy(buffer + 1, swapped, sizeof(swapped));
+    buffer[0] = util::nativeByteOrder == 'L' ? 'B' : 'L';
+    
+    util::SerReader reader(buffer);
+    reader << target;
+    verified &= memcmp(source, target, sizeof(source)) == 0;
+    
+    // Throughput is given in bytes of emulator state per nanosecond
+    double bytes = (double)state.size();
+    report("serialize", "Save", bytes * rounds, "bytes", saveTime, verified, bytes);
+    report("serialize", "Load", bytes * rounds, "bytes", loadTime, verified, bytes);
+}
+
+void
+MicroBenchmark::benchCompression()
+{
+    const isize rounds = 10;
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &mem = amiga->mem;
+    
+    amiga->configure(OPT_CHIP_RAM, 512);
+    amiga->configure(OPT_SLOW_RAM, 512);
+    amiga->configure(OPT_FAST_RAM, 8192);
+    
+    // Fill parts of Chip Ram and Fast Ram with random data
+    std::mt19937 rng(42);
+    for (u32 i = 0; i < 0x20000; i += 2) {
+        
+        mem.poke16 <ACCESSOR_AGNUS, MEM_CHIP> (i, (u16)rng());
+        mem.poke16 <ACCESSOR_CPU, MEM_FAST> (FAST_RAM_STRT + i, (u16)rng());
+    }
+    
+    std::unique_ptr<Snapshot> snapshot(Snapshot::makeWithAmiga(amiga.get()));
+    std::unique_ptr<Snapshot> restored;
+    double writeTime = 0, readTime = 0;
+    isize compressed = 0;
+    
+    for (isize r = 0; r < rounds; r++) {
+        
+        std::stringstream stream;
+        
+        auto start = util::Time::now();
+        compressed = snapshot->writeCompressedToStream(stream);
+        writeTime += (util::Time::now() - start).asSeconds();
+        
+        start = util::Time::now();
+        restored.reset(AmigaFile::make <Snapshot> (stream));
+        readTime += (util::Time::now() - start).asSeconds();
+    }
+    
+    bool verified =
+    restored->size == snapshot->size &&
+    memcmp(restored->data, snapshot->data, snapshot->size) == 0;
+    
+    /* Snapshots exceeding the maximum size must be rejected before any memory
+     * is allocated. The first stream is well-formed but too large, the second
+     * one claims a size of almost 4 GB in the header.
+     */
+    std::stringstream tooLarge, forged;
+    Snapshot large(Snapshot::maxSize);
+    memset(large.getData(), 0, Snapshot::maxSize);
+    large.writeCompressedToStream(tooLarge);
+    snapshot->writeCompressedToStream(forged);
+    
+    string image = forged.str();
+    u32 rawSize = 0xFFFFFFF0;
+    u32 count = (u32)(((u64)rawSize + Snapshot::chunkSize - 1) / Snapshot::chunkSize);
+    for (isize i = 0; i < 4; i++) image[9 + i] = (char)(rawSize >> (8 * i));
+    for (isize i = 0; i < 4; i++) image[17 + i] = (char)(count >> (8 * i));
+    forged.str(image);
+    
+    for (auto stream : { &tooLarge, &forged }) {
+        
+        try {
+            delete AmigaFile::make <Snapshot> (*stream);
+            verified = false;
+        } catch (VAError &err) {
+            verified &= err.data == ERROR_SNP_CORRUPTED;
+        }
+    }
+    
+    /* Snapshots of the largest configuration must still be accepted. They
+     * contain all Ram types in their maximum size and four HD disks.
+     */
+    auto maxed = std::make_unique<Amiga>();
+    maxed->configure(OPT_CHIP_RAM, 2048);
+    maxed->configure(OPT_SLOW_RAM, 512);
+    maxed->configure(OPT_FAST_RAM, 8192);
+    for (isize i = 0; i < 4; i++) {
+        
+        maxed->configure(OPT_DRIVE_CONNECT, i, true);
+        maxed->configure(OPT_DRIVE_TYPE, i, DRIVE_HD_35);
+        verified &= maxed->df[i]->insertDisk(new Disk(INCH_35, DISK_HD));
+    }
+    
+    std::stringstream maxStream;
+    std::unique_ptr<Snapshot> maxSnapshot(Snapshot::makeWithAmiga(maxed.get()));
+    maxSnapshot->writeCompressedToStream(maxStream);
+    try {
+        std::unique_ptr<Snapshot> maxRestored(AmigaFile::make <Snapshot> (maxStream));
+        verified &= maxRestored->size == maxSnapshot->size;
+    } catch (VAError &err) {
+        verified = false;
+    }
+    
+    // Throughput is given in bytes of raw snapshot data per nanosecond
+    double bytes = (double)snapshot->size;
+    report("compress", "Write", bytes * rounds, "bytes", writeTime, true, bytes);
+    report("compress", "Read", bytes * rounds, "bytes", readTime, verified, bytes);
+    
+    os << std::left << std::setw(22) << "" << std::right;
+    os << "Storage: " << snapshot->size / 1024 << " KB (raw), ";
+    os << compressed / 1024 << " KB (compressed)";
+    os << std::endl;
+}
+
+void
+MicroBenchmark::benchMFM()
+{
+    const isize rounds = 10;
+    
+    // Create a double density disk filled with random data
+    std::unique_ptr<ADFFile> adf(ADFFile::makeWithType(INCH_35, DISK_DD));
+    std::mt19937 rng(42);
+    for (isize i = 0; i < adf->size; i++) adf->data[i] = (u8)rng();
+    
+    std::unique_ptr<Disk> disk;
+    std::unique_ptr<ADFFile> decoded;
+    double encodeTime = 0, decodeTime = 0;
+    
+    for (isize r = 0; r < rounds; r++) {
+        
+        auto start = util::Time::now();
+        disk.reset(Disk::makeWithFile(adf.get()));
+        encodeTime += (util::Time::now() - start).asSeconds();
+        
+        start = util::Time::now();
+        decoded.reset(ADFFile::makeWithDisk(disk.get()));
+        decodeTime += (util::Time::now() - start).asSeconds();
+    }
+    
+    // Verify that decoding reproduces the original disk
+    bool verified =
+    decoded->size == adf->size &&
+    memcmp(decoded->data, adf->data, adf->size) == 0;
+    
+    // Throughput is given in bytes of ADF data per nanosecond
+    double bytes = (double)adf->size;
+    report("mfm", "Encode", bytes * rounds, "bytes", encodeTime, true);
+    report("mfm", "Decode", bytes * rounds, "bytes", decodeTime, verified);
+    
+    os << std::left << std::setw(22) << "" << std::right;
+    os << "Disk: " << std::fixed << std::setprecision(2);
+    os << 1000.0 * encodeTime / rounds << " ms (encode), ";
+    os << 1000.0 * decodeTime / rounds << " ms (decode)";
+    os << std::endl;
+}
+
+void
+MicroBenchmark::benchFileSystem()
+{
+    const isize numFiles = 256;
+    const isize fileSize = 48 * 1024;
+    const string path = "/tmp/vAmigaBench.hdf";
+    
+    // Create a 16 MB FFS volume with the geometry assumed by HDFFile
+    FSDeviceDescriptor layout;
+    layout.numCyls     = 1024;
+    layout.numHeads    = 1;
+    layout.numSectors  = 32;
+    layout.numReserved = 2;
+    layout.bsize       = 512;
+    layout.numBlocks   = layout.numCyls * layout.numHeads * layout.numSectors;
+    
+    Block root = (Block)((layout.numReserved + layout.numBlocks - 1) / 2);
+    layout.partitions.push_back(FSPartitionDescriptor(FS_FFS, 0, layout.numCyls - 1, root));
+    for (isize i = 0; i < layout.numBlocks / (8 * layout.bsize - 32) + 1; i++) {
+        layout.partitions[0].bmBlocks.push_back(root + 1 + (Block)i);
+    }
+    
+    // Fill the volume with some files and write it to disk
+    std::unique_ptr<FSDevice> volume(FSDevice::makeWithFormat(layout));
+    std::mt19937 rng(42);
+    std::vector<u8> buffer(fileSize);
+    
+    for (isize i = 0; i < numFiles; i++) {
+        
+        for (auto &b : buffer) b = (u8)rng();
+        volume->makeFile("file" + std::to_string(i), buffer.data(), fileSize);
+    }
+    
+    std::vector<u8> image(layout.numBlocks * layout.bsize);
+    volume->exportVolume(image.data(), (isize)image.size());
+    
+    std::ofstream stream(path, std::ios::binary);
+    stream.write((const char *)image.data(), (std::streamsize)image.size());
+    stream.close();
+    
+    // Import the volume and list the root directory
+    std::vector<Block> eagerItems, lazyItems;
+    ErrorCode err;
+    
+    auto start = util::Time::now();
+    std::unique_ptr<HDFFile> hdf(AmigaFile::make <HDFFile> (path));
+    FSDeviceDescriptor descriptor = hdf->layout();
+    std::unique_ptr<FSDevice> eager(FSDevice::makeWithFormat(descriptor));
+    eager->importVolume(hdf->data, hdf->size);
+    eager->collect(eager->currentDirBlock()->nr, eagerItems, false);
+    auto eagerTime = (util::Time::now() - start).asSeconds();
+    
+    start = util::Time::now();
+    std::unique_ptr<FSDevice> lazy(FSDevice::makeWithHDF(path, &err));
+    if (lazy) lazy->collect(lazy->currentDirBlock()->nr, lazyItems, false);
+    auto lazyTime = (util::Time::now() - start).asSeconds();
+    
+    // Verify that both volumes are equal
+    bool verified = lazy != nullptr && eagerItems == lazyItems;
+    if (verified) {
+        
+        std::vector<u8> exported(image.size());
+        lazy->exportVolume(exported.data(), (isize)exported.size());
+        verified &= exported == image;
+    }
+    
+    // Throughput is given in imported blocks per nanosecond
+    double blocks = (double)layout.numBlocks;
+    report("fsdevice", "Eager", blocks, "blocks", eagerTime, true);
+    report("fsdevice", "Lazy", blocks, "blocks", lazyTime, verified);
+    
+    unlink(path.c_str());
+}
+
+void
+MicroBenchmark::benchHdController()
+{
+    const isize blocks = 2048;
+    const isize chunk = 64 * 1024;
+    const isize rounds = 1024;
+    const string path = "/tmp/vAmigaBench.hdf";
+    
+    // Create a 1 MB hard drive image filled with random data
+    std::vector<u8> image(blocks * 512);
+    std::mt19937 rng(42);
+    for (auto &b : image) b = (u8)rng();
+    
+    std::ofstream stream(path, std::ios::binary);
+    stream.write((const char *)image.data(), (std::streamsize)image.size());
+    stream.close();
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &mem = amiga->mem;
+    amiga->configure(OPT_CHIP_RAM, 512);
+    amiga->hdController.attach(path);
+    
+    // Place an IOStdReq and a data buffer in Chip Ram
+    const u32 io = 0x1000, data = 0x2000;
+    u8 *req = mem.ramPtr(io, 48, true);
+    u8 *buf = mem.ramPtr(data, chunk, true);
+    
+    /* Issues a request the same way the device driver does. It returns the
+     * contents of io_Error which is a signed byte.
+     */
+    auto request = [&](u16 cmd, u32 length, u32 offset, u32 high = 0) {
+        
+        W16BE(req + 28, cmd);
+        W32BE(req + 32, high);
+        W32BE(req + 36, length);
+        W32BE(req + 40, data);
+        W32BE(req + 44, offset);
+        
+        amiga->cpu.setA(1, io);
+        amiga->hdController.poke16(0, HdController::HDC_CMD_BEGINIO);
+        return (i8)req[31];
+    };
+    
+    bool verified = req != nullptr && buf != nullptr;
+    double elapsed = 0;
+    
+    if (verified) {
+        
+        // Read the image in chunks (CMD_READ)
+        auto start = util::Time::now();
+        for (isize i = 0; i < rounds; i++) {
+            
+            u32 offset = (u32)((i * 37) % (blocks - chunk / 512 + 1) * 512);
+            verified &= request(2, chunk, offset) == 0;
+            verified &= memcmp(buf, image.data() + offset, chunk) == 0;
+        }
+        elapsed = (util::Time::now() - start).asSeconds();
+        
+        /* Requests beyond the end of the image must be rejected. Requests
+         * issued by 64-bit commands (TD_READ64, NSCMD_TD_WRITE64) must not
+         * wrap around, no matter what the upper 32 bits contain.
+         */
+        const i8 badAddress = -5;
+        verified &= request(2, 512, (u32)image.size()) == badAddress;
+        verified &= request(2, 1024, (u32)image.size() - 512) == badAddress;
+        verified &= request(24, 0x200, 0xFFFFFE00, 0xFFFFFFFF) == badAddress;
+        verified &= request(0xC001, 0x200, 0xFFFFFE00, 0xFFFFFFFF) == badAddress;
+        verified &= request(24, 0x200, 0, 1) == badAddress;
+        verified &= request(24, 0x200, (u32)image.size() - 512, 0) == 0;
+    }
+    
+    amiga->hdController.detach();
+    
+    // Throughput is given in transferred bytes per nanosecond
+    double bytes = (double)rounds * chunk;
+    report("hdcontrol", "BeginIO", bytes, "bytes", elapsed, verified);
+    
+    unlink(path.c_str());
+}
+
+void
+MicroBenchmark::benchFrameHandoff()
+{
+    const isize frames = 500;
+    const isize consumerCnt = 2;
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &agnus = amiga->agnus;
+    auto &pe = amiga->denise.pixelEngine;
+    
+    /* Each consumer repeatedly locks the latest frame and checks that it has
+     * not been torn, i.e., all pixels have been written in the same frame,
+     * and that frame numbers never decrease.
+     */
+    std::atomic<bool> done = false;
+    std::vector<isize> consumed(consumerCnt), torn(consumerCnt);
+    std::vector<std::thread> consumers;
+    
+    for (isize c = 0; c < consumerCnt; c++) {
+        
+        consumers.emplace_back([&, c]() {
+            
+            // Skip the initial buffer which has not been drawn yet
+            i64 prev = 0;
+            while (!done) {
+                
+                ScreenBuffer buffer = pe.lockStableBuffer();
+                if (buffer.nr != prev) {
+                    
+                    u32 value = buffer.data[0];
+                    for (isize i = 1; i < PIXELS; i++) {
+                        if (buffer.data[i] != value) { torn[c]++; break; }
+                    }
+                    if (buffer.nr < prev) torn[c]++;
+                    prev = buffer.nr;
+                    consumed[c]++;
+                }
+                pe.unlockStableBuffer(buffer);
+            }
+        });
+    }
+    
+    // Act as the emulator thread and draw frames filled with a unique value
+    auto start = util::Time::now();
+    for (isize f = 1; f <= frames; f++) {
+        
+        for (isize v = 0; v < VPIXELS; v++) {
+            
+            agnus.pos.v = v;
+            u32 *p = pe.pixelAddr(0);
+            for (isize i = 0; i < HPIXELS; i++) p[i] = (u32)f;
+        }
+        pe.beginOfFrame();
+    }
+    auto elapsed = (util::Time::now() - start).asSeconds();
+    
+    done = true;
+    for (auto &t : consumers) t.join();
+    
+    bool verified = true;
+    for (isize c = 0; c < consumerCnt; c++) verified &= torn[c] == 0;
+    
+    // Throughput is given in drawn pixels per nanosecond
+    double pixels = (double)frames * PIXELS;
+    report("handoff", "Producer", pixels, "pixels", elapsed, verified, PIXELS);
+    
+    os << std::left << std::setw(22) << "" << std::right << "Consumed:";
+    for (isize c = 0; c < consumerCnt; c++) os << " " << consumed[c];
+    os << " of " << frames << " frames" << std::endl;
+}
+
+void
+MicroBenchmark::benchDirtyLines()
+{
+    const isize frames = 500;
+    const isize first = 100, last = 120;
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &agnus = amiga->agnus;
+    auto &pe = amiga->denise.pixelEngine;
+    
+    /* Draw frames with a static background and a band of lines that changes
+     * in every frame. Only the lines of the band must be marked dirty.
+     */
+    bool verified = true;
+    double elapsed = 0;
+    
+    for (isize f = 1; f <= frames; f++) {
+        
+        for (isize v = 0; v < VPIXELS; v++) {
+            
+            agnus.pos.v = v;
+            u32 *p = pe.pixelAddr(0);
+            u32 value = (v >= first && v < last) ? (u32)f : (u32)v;
+            for (isize i = 0; i < HPIXELS; i++) p[i] = value;
+            
+            auto start = util::Time::now();
+            pe.updateDirtyMap(v);
+            elapsed += (util::Time::now() - start).asSeconds();
+        }
+        pe.beginOfFrame();
+        
+        // The first frame is compared with an undrawn buffer
+        if (f == 1) continue;
+        
+        ScreenBuffer buffer = pe.lockStableBuffer();
+        for (isize v = 0; v < VPIXELS; v++) {
+            verified &= buffer.dirty[v] == (v >= first && v < last);
+        }
+        pe.unlockStableBuffer(buffer);
+    }
+    
+    // Throughput is given in compared pixels per nanosecond
+    double pixels = (double)frames * PIXELS;
+    report("dirtyLines", "Memcmp", pixels, "pixels", elapsed, verified, PIXELS);
+}
+
+void
+MicroBenchmark::benchRecorder()
+{
+    const isize frames = 200;
+    const string path = "/tmp/vAmigaBench.avi";
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &recorder = amiga->denise.screenRecorder;
+    auto &agnus = amiga->agnus;
+    auto &pe = amiga->denise.pixelEngine;
+    
+    // Record the full visible area
+    int x1 = 0, x2 = HPIXELS - 4 * HBLANK_MIN;
+    int y1 = VBLANK_CNT, y2 = VPIXELS - 2;
+    
+    recorder.setBackend(REC_BACKEND_AVI);
+    if (!recorder.startRecording(x1, y1, x2, y2, 0, 1, 1)) {
+        
+        report("recorder", "Handoff", 0, "pixels", 0, false);
+        return;
+    }
+    
+    /* Emulate the vsync handler calls. Each frame is filled with a unique
+     * value, so that no frame is passed as a repeat frame. Only the time spent
+     * in the vsync handler is measured. The first call switches the recorder
+     * from the prepare state into the record state.
+     */
+    double elapsed = 0;
+    for (isize f = 0; f <= frames; f++) {
+        
+        for (isize v = 0; v < VPIXELS; v++) {
+            
+            agnus.pos.v = v;
+            u32 *p = pe.pixelAddr(0);
+            for (isize i = 0; i < HPIXELS; i++) p[i] = (u32)f;
+            pe.updateDirtyMap(v);
+        }
+        pe.beginOfFrame();
+        
+        auto start = util::Time::now();
+        recorder.vsyncHandler((f + 1) * DMA_CYCLES(HPOS_CNT * VPOS_CNT));
+        elapsed += (util::Time::now() - start).asSeconds();
+    }
+    
+    recorder.stopRecording();
+    recorder.vsyncHandler((frames + 2) * DMA_CYCLES(HPOS_CNT * VPOS_CNT));
+    bool verified = recorder.exportAs(path);
+    
+    // Check the file size and the frame count stored in the main header
+    std::ifstream stream(path, std::ios::binary);
+    std::vector<u8> header(64);
+    stream.read((char *)header.data(), (std::streamsize)header.size());
+    stream.seekg(0, std::ios::end);
+    isize size = (isize)stream.tellg();
+    
+    auto r32 = [&](isize i) {
+        return (u32)(header[i] | header[i + 1] << 8 | header[i + 2] << 16 | header[i + 3] << 24);
+    };
+    verified &= memcmp(header.data(), "RIFF", 4) == 0;
+    verified &= r32(4) == (u32)(size - 8);
+    verified &= r32(48) == (u32)(frames - recorder.getDroppedFrames());
+    verified &= recorder.getRepeatedFrames() == 0;
+    
+    // Throughput is given in recorded pixels per nanosecond
+    double pixels = (double)frames * (x2 - x1) * (y2 - y1);
+    report("recorder", "Handoff", pixels, "pixels", elapsed, verified,
+           (x2 - x1) * (y2 - y1));
+    
+    os << std::left << std::setw(22) << "" << std::right;
+    os << "Dropped: " << recorder.getDroppedFrames() << " of " << frames;
+    os << " frames, repeated: " << recorder.getRepeatedFrames() << std::endl;
+    
+    unlink(path.c_str());
+}
+
+void
+MicroBenchmark::benchWarpPolicy()
+{
+    const isize frames = 100000;
+    
+    auto amiga = std::make_unique<Amiga>();
+    auto &osc = amiga->oscillator;
+    auto &dc = amiga->paula.diskController;
+    amiga->configure(OPT_WARP_DISK, true);
+    amiga->configure(OPT_WARP_DELAY, 0);
+    
+    // Starts or stops disk DMA by writing DSKLEN the way the OS does
+    auto startDMA = [&]() { dc.pokeDSKLEN(0x9000); dc.pokeDSKLEN(0x9000); };
+    auto stopDMA = [&]() { dc.pokeDSKLEN(0); };
+    
+    // Disk DMA triggers the warp policy
+    startDMA();
+    bool verified = dc.getState() != DRIVE_DMA_OFF;
+    osc.updateWarpMode();
+    verified &= osc.inAutoWarp();
+    
+    /* Switching warp off manually while DMA is still running must not be
+     * overruled by the policy in one of the following frames.
+     */
+    amiga->warpOff();
+    auto start = util::Time::now();
+    for (isize i = 0; i < frames; i++) {
+        
+        osc.updateWarpMode();
+        verified &= !osc.inAutoWarp();
+    }
+    double elapsed = (util::Time::now() - start).asSeconds();
+    
+    // Once the condition has vanished, the policy takes over again
+    stopDMA();
+    osc.updateWarpMode();
+    verified &= !osc.inAutoWarp();
+    startDMA();
+    osc.updateWarpMode();
+    verified &= osc.inAutoWarp();
+    stopDMA();
+    
+    report("warp", "Policy", (double)frames, "frames", elapsed, verified);
+}
+
+void
+MicroBenchmark::benchGuards()
+{
+    using namespace moira;
+    
+    // Guards are placed inside a small window spanning several pages
+    const u32 base = 0x3F00;
+    const u32 window = 0x400;
+    
+    // Location of the memory word compared by COND_MEM16 conditions
+    const u32 memArg = 0x1000;
+    
+    const isize lookups = 200000;
+    const isize rounds = 10;
+    
+    auto amiga = std::make_unique<Amiga>();
+    amiga->configure(OPT_CHIP_RAM, 512);
+    auto &cpu = amiga->cpu;
+    auto &mem = amiga->mem;
+    
+    std::mt19937 rng(42);
+    
+    // Reference implementation (linear search in insertion order)
+    std::vector<Guard> bps, wps;
+    
+    auto condHolds = [&](const Condition &cond) {
+        
+        u32 operand;
+        switch (cond.source) {
+                
+            case COND_DREG:  operand = cpu.getD(cond.arg & 7); break;
+            case COND_AREG:  operand = cpu.getA(cond.arg & 7); break;
+            case COND_MEM16: operand = mem.spypeek16<ACCESSOR_CPU>(cond.arg & ~1); break;
+            default:         return true;
+        }
+        switch (cond.op) {
+                
+            case COND_EQ:  return operand == cond.value;
+            case COND_NE:  return operand != cond.value;
+            case COND_LT:  return operand < cond.value;
+            default:       return (operand & cond.value) != 0;
+        }
+    };
+    auto linear = [&](std::vector<Guard> &guards, u32 addr, isize size) {
+        
+        for (auto &g : guards) {
+            
+            if (g.addr >= addr && g.addr < addr + size &&
+                g.enabled && condHolds(g.cond) && ++g.hits > g.skip) {
+                return true;
+            }
+        }
+        return false;
+    };
+    
+    // Arms a guard in the emulator and in the reference implementation
+    auto arm = [&](Guards &guards, std::vector<Guard> &ref, u32 addr) {
+        
+        if (guards.isSetAt(addr)) return;
+        
+        Guard g { addr, rng() % 8 != 0, 0, (long)(rng() % 4), Condition { } };
+        
+        // Attach a condition to every fourth guard
+        if (rng() % 4 == 0) {
+            
+            static const CondSource sources[] = { COND_DREG, COND_AREG, COND_MEM16 };
+            static const CondOp ops[] = { COND_EQ, COND_NE, COND_LT, COND_ANY };
+            g.cond.source = sources[rng() % 3];
+            g.cond.arg = g.cond.source == COND_MEM16 ? memArg + rng() % 8 : rng() % 8;
+            g.cond.op = ops[rng() % 4];
+            g.cond.value = rng() % 4;
+        }
+        
+        guards.addAt(addr, g.skip);
+        guards.setEnableAt(addr, g.enabled);
+        guards.setConditionAt(addr, g.cond);
+        ref.push_back(g);
+    };
+    
+    // Randomizes the operands the conditions refer to
+    auto shuffle = [&]() {
+        
+        for (int i = 0; i < 8; i++) {
+            
+            cpu.setD(i, rng() % 4);
+            cpu.setA(i, rng() % 4);
+            W16BE(mem.chip + memArg + 2 * (i % 4), rng() % 4);
+        }
+    };
+    
+    for (isize count : { 16, 128, 512 }) {
+        
+        auto &debugger = cpu.debugger;
+        debugger.breakpoints.removeAll();
+        debugger.watchpoints.removeAll();
+        bps.clear();
+        wps.clear();
+        
+        // Make sure that guards sit on both sides of all page boundaries
+        for (u32 page = base; page < base + window; page += 0x100) {
+            
+            for (u32 offset : { 0xFE, 0xFF, 0x100, 0x101 }) {
+                
+                arm(debugger.breakpoints, bps, page + offset);
+                arm(debugger.watchpoints, wps, page + offset);
+            }
+        }
+        while ((isize)bps.size() < count) {
+            arm(debugger.breakpoints, bps, base + rng() % window);
+        }
+        while ((isize)wps.size() < count) {
+            arm(debugger.watchpoints, wps, base + rng() % window);
+        }
+        
+        /* Generate random accesses. Some of them are word or long word
+         * accesses straddling a page boundary.
+         */
+        struct Access { u32 addr; Size size; bool watch; };
+        std::vector<Access> accesses(lookups);
+        for (auto &a : accesses) {
+            
+            static const Size sizes[] = { Byte, Word, Long };
+            a.watch = rng() % 2;
+            a.size = a.watch ? sizes[rng() % 3] : Byte;
+            a.addr = rng() % 4 == 0 ?
+            base + 0x100 * (rng() % 4) + 0xFD + rng() % 3 :
+            base - 4 + rng() % (window + 8);
+        }
+        
+        // Compare each lookup with the reference while the operands change
+        bool verified = true;
+        for (isize i = 0; i < lookups; i++) {
+            
+            if (i % 64 == 0) shuffle();
+            
+            auto &a = accesses[i];
+            bool result = a.watch ?
+            debugger.watchpointMatches(a.addr, a.size) :
+            debugger.breakpointMatches(a.addr);
+            bool expected = a.watch ?
+            linear(wps, a.addr, a.size) :
+            linear(bps, a.addr, a.size);
+            verified &= result == expected;
+        }
+        
+        // Measure both implementations with constant operands
+        shuffle();
+        isize indexHits = 0, linearHits = 0;
+        
+        auto start = util::Time::now();
+        for (isize r = 0; r < rounds; r++) {
+            for (auto &a : accesses) {
+                
+                indexHits += a.watch ?
+                debugger.watchpointMatches(a.addr, a.size) :
+                debugger.breakpointMatches(a.addr);
+            }
+        }
+        double indexTime = (util::Time::now() - start).asSeconds();
+        
+        start = util::Time::now();
+        for (isize r = 0; r < rounds; r++) {
+            for (auto &a : accesses) {
+                
+                linearHits += a.watch ?
+                linear(wps, a.addr, a.size) :
+                linear(bps, a.addr, a.size);
+            }
+        }
+        double linearTime = (util::Time::now() - start).asSeconds();
+        verified &= indexHits == linearHits;
+        
+        // Compare the hit counters of all guards
+        for (usize i = 0; i < bps.size(); i++) {
+            verified &= debugger.breakpoints.guardWithNr(i)->hits == bps[i].hits;
+        }
+        for (usize i = 0; i < wps.size(); i++) {
+            verified &= debugger.watchpoints.guardWithNr(i)->hits == wps[i].hits;
+        }
+        
+        char indexName[32], linearName[32];
+        snprintf(indexName, sizeof(indexName), "Index %zd", count);
+        snprintf(linearName, sizeof(linearName), "Linear %zd", count);
+        
+        double items = (double)(lookups * rounds);
+        report("guards", linearName, items, "lookups", linearTime, true);
+        report("guards", indexName, items, "lookups", indexTime, verified);
+    }
+}
@@ -0,0 +1,85 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga Bare Metal
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#pragma once
+
+#include "Aliases.h"
+#include <ostream>
+
+/* Micro benchmarks for performance critical emulator kernels. Each benchmark
+ * runs all available implementations of a kernel on the same input data,
+ * verifies that the results match the reference implementation bit by bit,
+ * and reports the throughput of each variant.
+ */
+class MicroBenchmark {
+    
+    // Output stream
+    std::ostream &os;
+    
+    // Number of failed verifications
+    isize failures = 0;
+    
+public:
+    
+    MicroBenchmark(std::ostream &stream) : os(stream) { }
+    
+    // Runs all benchmarks and returns the number of failed verifications
+    isize run();
+    
+private:
+    
+    // Planar-to-chunky conversion (Denise)
+    void benchTranspose();
+    
+    // Color index to RGBA conversion (PixelEngine)
+    void benchColorize();
+    
+    // Audio sample synthesis (Muxer)
+    void benchSynthesize();
+    
+    // Full snapshots versus delta snapshots (SnapshotChain)
+    void benchSnapshot();
+    
+    // Saving and restoring the emulator state (SerWriter, SerReader)
+    void benchSerialize();
+    
+    // Raw snapshots versus compressed snapshots (Snapshot)
+    void benchCompression();
+    
+    // MFM encoding and decoding of a full disk (Disk, ADFFile)
+    void benchMFM();
+    
+    // Eager versus lazy import of a hard disk volume (FSDevice)
+    void benchFileSystem();
+    
+    // Serving I/O requests from a mapped hard drive (HdController)
+    void benchHdController();
+    
+    // Handing over frames to concurrent consumers (PixelEngine)
+    void benchFrameHandoff();
+    
+    // Detecting lines that differ from the previous frame (PixelEngine)
+    void benchDirtyLines();
+    
+    // Recording a video with the built-in encoder (Recorder)
+    void benchRecorder();
+    
+    // Evaluating the warp policy once per frame (Oscillator)
+    void benchWarpPolicy();
+    
+    // Checking breakpoints and watchpoints (Moira Guards)
+    void benchGuards();
+    
+    /* Prints a single result line. If the number of items per frame is known,
+     * the time needed to process a full frame is printed, too.
+     */
+    void report(const char *kernel, const char *variant,
+                double items, const char *unit, double seconds, bool verified,
+                double itemsPerFrame = 0);
+};
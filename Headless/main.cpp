@@ -0,0 +1,118 @@
+// -----------------------------------------------------------------------------
+// This file is part of vAmiga Bare Metal
+//
+// Copyright (C) Dirk W. Hoffmann. www.dirkwhoffmann.de
+// Licensed under the GNU General Public License v3
+//
+// See https://www.gnu.org for license information
+// -----------------------------------------------------------------------------
+
+#include "config.h"
+#include "BatchRunner.h"
+#include "MicroBenchmark.h"
+#include "AgnusTypes.h"
+#include "Parser.h"
+
+#include <cstring>
+#include <iostream>
+
+static void usage(const char *name)
+{
+    std::cout << "Usage: " << name << " [options] [disk, hard drive, or snapshot files...]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "  -rom <file>       Kickstart Rom" << std::endl;
+    std::cout << "  -ext <file>       Extension Rom" << std::endl;
+    std::cout << "  -frames <n>       Frames to emulate per job" << std::endl;
+    std::cout << "  -jobs <n>         Number of worker threads" << std::endl;
+    std::cout << "  -instances <n>    Number of jobs if no disk is given" << std::endl;
+    std::cout << "  -out <dir>        Write the final frame of each job" << std::endl;
+    std::cout << "  -snapshots        Save the final state of each job (requires -out)" << std::endl;
+    std::cout << "  -scheduler <type> Event scheduler (SCAN, HEAP)" << std::endl;
+    std::cout << "  -profile          Print the host time spent in each subsystem" << std::endl;
+    std::cout << "  -manifest <file>  Run the regression tests listed in a manifest" << std::endl;
+    std::cout << "  -record           Write the reference images instead of comparing them" << std::endl;
+    std::cout << "  -bench            Run micro benchmarks and exit" << std::endl;
+}
+
+int main(int argc, const char *argv[]) {
+
+    BatchRunner runner;
+    isize instances = 1;
+    std::vector<string> manifests;
+    bool customRom = false, customExt = false;
+    
+    runner.romPath = "aros-amiga-m68k-rom.bin";
+    runner.extPath = "aros-amiga-m68k-ext.bin";
+    
+    for (int i = 1; i < argc; i++) {
+        
+        bool hasArg = i + 1 < argc;
+        
+        if (strcmp(argv[i], "-rom") == 0 && hasArg) {
+            runner.romPath = argv[++i];
+            customRom = true;
+        } else if (strcmp(argv[i], "-ext") == 0 && hasArg) {
+            runner.extPath = argv[++i];
+            customExt = true;
+        } else if (strcmp(argv[i], "-frames") == 0 && hasArg) {
+            runner.frames = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-jobs") == 0 && hasArg) {
+            runner.workers = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-instances") == 0 && hasArg) {
+            instances = atol(argv[++i]);
+        } else if (strcmp(argv[i], "-out") == 0 && hasArg) {
+            runner.outputDir = argv[++i];
+        } else if (strcmp(argv[i], "-snapshots") == 0) {
+            runner.saveSnapshots = true;
+        } else if (strcmp(argv[i], "-profile") == 0) {
+            runner.profile = true;
+        } else if (strcmp(argv[i], "-manifest") == 0 && hasArg) {
+            manifests.push_back(argv[++i]);
+        } else if (strcmp(argv[i], "-record") == 0) {
+            runner.record = true;
+        } else if (strcmp(argv[i], "-scheduler") == 0 && hasArg) {
+            try {
+                runner.scheduler = util::parseEnum <EventSchedulerEnum> (argv[++i]);
+            } catch (util::ParseError &e) {
+                std::cout << "Invalid scheduler: " << e.token;
+                std::cout << " (expected " << e.expected << ")" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "-bench") == 0) {
+            MicroBenchmark bench(std::cout);
+            return bench.run() ? 1 : 0;
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else {
+            runner.addJob(argv[i]);
+        }
+    }
+    
+    // The default extension Rom only fits the default Kickstart Rom
+    if (customRom && !customExt) runner.extPath = "";
+    
+    // Add the regression tests
+    for (auto &manifest : manifests) {
+        
+        try {
+            runner.addManifest(manifest);
+        } catch (util::Exception &e) {
+            std::cout << "Invalid manifest " << manifest << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    
+    // Boot without a disk if no disk was specified
+    if (runner.jobs.empty()) {
+        for (isize i = 0; i < instances; i++) runner.addJob("");
+    }
+    
+    auto seconds = runner.run();
+    runner.report(std::cout, seconds);
+
+    for (auto &job : runner.jobs) {
+        if (!job.success || (!job.reference.empty() && !job.passed)) return 1;
+    }
+    return 0;
+}
@@ -20,7 +20,7 @@
 
 // Snapshot version number
 #define SNP_MAJOR 1
-#define SNP_MINOR 0
+#define SNP_MINOR 4
 #define SNP_SUBMINOR 0
 
 // Uncomment this setting in a release build
@@ -79,6 +79,9 @@ static const MouseEmulation mouseEmulation = MouseEmulation::SFML;
 // Uncomment to fallback to a simpler Agnus execution function
 // #define AGNUS_EXEC_DEBUG
 
+// Uncomment to compile in the host time profiler (see Profiler.h)
+// #define PROFILING
+
 // Uncomment to lauch the emulator with a disk in df0
 // #define DF0_DISK "/Users/hoff/Desktop/Testing/Planet_Rocklobster_Oxyron.adf"
 // #define DF0_DISK "/Users/hoff/Desktop/Testing/Ruffntumble.adf"
@@ -165,6 +168,7 @@ static const int DSKREG_DEBUG    = 0; // Disk controller registers
 static const int DSK_DEBUG       = 0; // Disk controller execution
 static const int MFM_DEBUG       = 0; // Disk encoder / decoder
 static const int FS_DEBUG        = 0; // File System Classes (OFS / FFS)
+static const int HDR_DEBUG       = 0; // Hard drive controller
 
 // Audio
 static const int AUDREG_DEBUG    = 0; // Audio registers